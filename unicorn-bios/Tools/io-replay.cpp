@@ -0,0 +1,210 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include "UB/IOTrace.hpp"
+#include "UB/FAT/Image.hpp"
+#include "UB/FAT/ChunkStore.hpp"
+
+static void     showHelp( void );
+static uint64_t percentile( const std::vector< uint64_t > & values, double p );
+static void     showLatencies( const std::string & title, std::vector< uint64_t > values );
+
+int main( int argc, const char * argv[] )
+{
+    try
+    {
+        bool        paced( false );
+        size_t      repeat( 1 );
+        std::string image;
+        std::string trace;
+        
+        for( int i = 1; i < argc; i++ )
+        {
+            std::string arg( argv[ i ] );
+            
+            if( arg == "--help" || arg == "-h" )
+            {
+                showHelp();
+                
+                return EXIT_SUCCESS;
+            }
+            else if( arg == "--paced" )
+            {
+                paced = true;
+            }
+            else if( arg == "--repeat" )
+            {
+                if( ++i < argc )
+                {
+                    repeat = std::max( static_cast< size_t >( std::atoll( argv[ i ] ) ), static_cast< size_t >( 1 ) );
+                }
+            }
+            else if( image.length() == 0 )
+            {
+                image = arg;
+            }
+            else if( trace.length() == 0 )
+            {
+                trace = arg;
+            }
+        }
+        
+        if( image.length() == 0 || trace.length() == 0 )
+        {
+            showHelp();
+            
+            return EXIT_FAILURE;
+        }
+        
+        {
+            UB::FAT::Image                      fat( image );
+            std::vector< UB::BIOS::DiskAccess > records( UB::IOTrace::read( trace ) );
+            std::vector< uint64_t >             recorded;
+            std::vector< uint64_t >             replayed;
+            uint64_t                            bytes( 0 );
+            auto                                start( std::chrono::steady_clock::now() );
+            
+            for( const auto & access: records )
+            {
+                if( access.success() )
+                {
+                    recorded.push_back( access.latency() );
+                }
+            }
+            
+            for( size_t n = 0; n < repeat; n++ )
+            {
+                auto pass( std::chrono::steady_clock::now() );
+                
+                for( const auto & access: records )
+                {
+                    if( access.success() == false )
+                    {
+                        continue;
+                    }
+                    
+                    if( paced )
+                    {
+                        std::this_thread::sleep_until( pass + std::chrono::nanoseconds( access.time() ) );
+                    }
+                    
+                    {
+                        auto t( std::chrono::steady_clock::now() );
+                        
+                        bytes += fat.read( access.offset(), access.size() ).size();
+                        
+                        replayed.push_back( static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - t ).count() ) );
+                    }
+                }
+            }
+            
+            {
+                double seconds( std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() );
+                
+                std::cout << "Image:       " << fat.path() << " (" << fat.format() << ")" << std::endl
+                          << "Trace:       " << trace << " (" << records.size() << " records)" << std::endl
+                          << "Mode:        " << ( ( paced ) ? "paced" : "full speed" ) << ", " << repeat << " pass" << ( ( repeat > 1 ) ? "es" : "" ) << std::endl
+                          << "Reads:       " << replayed.size() << std::endl
+                          << "Bytes:       " << bytes << std::endl
+                          << "Elapsed:     " << std::fixed << std::setprecision( 3 ) << seconds << " s" << std::endl
+                          << "Throughput:  " << std::fixed << std::setprecision( 2 ) << ( ( seconds > 0 ) ? static_cast< double >( bytes ) / ( 1024 * 1024 ) / seconds : 0 ) << " MB/s" << std::endl
+                          << "IOPS:        " << std::fixed << std::setprecision( 0 ) << ( ( seconds > 0 ) ? static_cast< double >( replayed.size() ) / seconds : 0 ) << std::endl;
+                
+                if( fat.format() == "chunks" )
+                {
+                    std::cout << "Chunk cache: " << UB::FAT::ChunkStore::Cache::shared().hits() << " hits, " << UB::FAT::ChunkStore::Cache::shared().misses() << " misses" << std::endl;
+                }
+                
+                showLatencies( "Replayed latency (us):", replayed );
+                showLatencies( "Recorded latency (us):", recorded );
+            }
+        }
+        
+        return EXIT_SUCCESS;
+    }
+    catch( const std::exception & e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        
+        return EXIT_FAILURE;
+    }
+    catch( ... )
+    {
+        std::cerr << "Unknown error" << std::endl;
+        
+        return EXIT_FAILURE;
+    }
+}
+
+static void showHelp( void )
+{
+    std::cout << "Usage: io-replay [OPTIONS] BOOT_IMG TRACE"
+              << std::endl
+              << std::endl
+              << "Replays an INT 13h trace recorded with unicorn-bios --io-trace"
+              << std::endl
+              << "against BOOT_IMG (raw disk image or chunk manifest)."
+              << std::endl
+              << std::endl
+              << "Options:"
+              << std::endl
+              << std::endl
+              << "    --help   / -h:  Displays help."
+              << std::endl
+              << "    --paced:        Issues reads at the recorded pace instead of full speed."
+              << std::endl
+              << "    --repeat N:     Replays the trace N times."
+              << std::endl;
+}
+
+static uint64_t percentile( const std::vector< uint64_t > & values, double p )
+{
+    size_t index;
+    
+    if( values.size() == 0 )
+    {
+        return 0;
+    }
+    
+    index = static_cast< size_t >( p * static_cast< double >( values.size() - 1 ) + 0.5 );
+    
+    return values[ std::min( index, values.size() - 1 ) ];
+}
+
+static void showLatencies( const std::string & title, std::vector< uint64_t > values )
+{
+    std::sort( values.begin(), values.end() );
+    
+    std::cout << title << std::endl
+              << std::fixed << std::setprecision( 1 )
+              << "    p50:     " << static_cast< double >( percentile( values, 0.50 ) )  / 1000 << std::endl
+              << "    p90:     " << static_cast< double >( percentile( values, 0.90 ) )  / 1000 << std::endl
+              << "    p99:     " << static_cast< double >( percentile( values, 0.99 ) )  / 1000 << std::endl
+              << "    p99.9:   " << static_cast< double >( percentile( values, 0.999 ) ) / 1000 << std::endl
+              << "    max:     " << static_cast< double >( percentile( values, 1.0 ) )   / 1000 << std::endl;
+}
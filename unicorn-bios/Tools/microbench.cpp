@@ -0,0 +1,578 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include "UB/Engine.hpp"
+#include "UB/Registers.hpp"
+#include "UB/BinaryDataStream.hpp"
+#include "UB/BinaryFileStream.hpp"
+#include "UB/StringStream.hpp"
+#include "UB/String.hpp"
+#include "UB/Capstone.hpp"
+
+typedef std::pair< std::string, std::function< void( size_t ) > > Benchmark;
+
+static volatile uint64_t sink( 0 );
+
+static void                     showHelp( void );
+static std::vector< Benchmark > benchmarks( const std::string & tmp );
+static std::vector< uint8_t >   code( size_t size );
+
+int main( int argc, const char * argv[] )
+{
+    try
+    {
+        std::string filter;
+        std::string output;
+        uint64_t    minTime( 200 );
+        bool        list( false );
+        char        tmp[] = "/tmp/microbench.XXXXXX";
+        int         fd;
+        
+        for( int i = 1; i < argc; i++ )
+        {
+            std::string arg( argv[ i ] );
+            
+            if( arg == "--help" || arg == "-h" )
+            {
+                showHelp();
+                
+                return EXIT_SUCCESS;
+            }
+            else if( arg == "--list" )
+            {
+                list = true;
+            }
+            else if( arg == "--filter" && i + 1 < argc )
+            {
+                filter = argv[ ++i ];
+            }
+            else if( arg == "--min-time" && i + 1 < argc )
+            {
+                minTime = std::max( static_cast< uint64_t >( std::atoll( argv[ ++i ] ) ), static_cast< uint64_t >( 1 ) );
+            }
+            else if( arg == "--output" && i + 1 < argc )
+            {
+                output = argv[ ++i ];
+            }
+            else
+            {
+                showHelp();
+                
+                return EXIT_FAILURE;
+            }
+        }
+        
+        if( ( fd = mkstemp( tmp ) ) < 0 )
+        {
+            throw std::runtime_error( "Cannot create temporary file" );
+        }
+        
+        {
+            std::vector< uint8_t > data( code( 1024 * 1024 ) );
+            
+            if( write( fd, data.data(), data.size() ) != static_cast< ssize_t >( data.size() ) )
+            {
+                throw std::runtime_error( "Cannot write temporary file" );
+            }
+            
+            close( fd );
+        }
+        
+        {
+            std::stringstream ss;
+            bool              first( true );
+            
+            ss << "{" << std::endl
+               << "    \"schema\": \"unicorn-bios-microbench\"," << std::endl
+               << "    \"version\": 1," << std::endl
+               << "    \"benchmarks\":" << std::endl
+               << "    [" << std::endl;
+            
+            for( const auto & benchmark: benchmarks( tmp ) )
+            {
+                size_t   iterations( 1 );
+                uint64_t time( 0 );
+                
+                if( filter.length() > 0 && benchmark.first.find( filter ) == std::string::npos )
+                {
+                    continue;
+                }
+                
+                if( list )
+                {
+                    std::cout << benchmark.first << std::endl;
+                    
+                    continue;
+                }
+                
+                while( true )
+                {
+                    auto start( std::chrono::steady_clock::now() );
+                    
+                    benchmark.second( iterations );
+                    
+                    time = static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start ).count() );
+                    
+                    if( time >= minTime * 1000000 )
+                    {
+                        break;
+                    }
+                    
+                    iterations = std::max
+                    (
+                        iterations * 2,
+                        static_cast< size_t >( static_cast< double >( iterations ) * ( static_cast< double >( minTime * 1000000 ) / static_cast< double >( std::max< uint64_t >( time, 1 ) ) ) * 1.2 )
+                    );
+                }
+                
+                ss << ( ( first ) ? "" : ",\n" )
+                   << "        { "
+                   << "\"name\": "        << UB::String::toJSON( benchmark.first ) << ", "
+                   << "\"iterations\": "  << iterations << ", "
+                   << "\"total_ns\": "    << time << ", "
+                   << "\"ns_per_op\": "   << std::fixed << std::setprecision( 3 ) << static_cast< double >( time ) / static_cast< double >( iterations )
+                   << " }";
+                
+                std::cerr << std::left << std::setw( 36 ) << benchmark.first << std::right << std::setw( 14 ) << std::fixed << std::setprecision( 3 ) << static_cast< double >( time ) / static_cast< double >( iterations ) << " ns/op" << std::endl;
+                
+                first = false;
+            }
+            
+            ss << std::endl << "    ]" << std::endl << "}" << std::endl;
+            
+            unlink( tmp );
+            
+            if( list )
+            {
+                return EXIT_SUCCESS;
+            }
+            
+            if( output.length() > 0 )
+            {
+                std::ofstream stream( output, std::ios::out | std::ios::trunc );
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write results: " + output );
+                }
+                
+                stream << ss.str();
+            }
+            else
+            {
+                std::cout << ss.str();
+            }
+        }
+        
+        return EXIT_SUCCESS;
+    }
+    catch( const std::exception & e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        
+        return EXIT_FAILURE;
+    }
+    catch( ... )
+    {
+        std::cerr << "Unknown error" << std::endl;
+        
+        return EXIT_FAILURE;
+    }
+}
+
+static void showHelp( void )
+{
+    std::cout << "Usage: microbench [OPTIONS]"
+              << std::endl
+              << std::endl
+              << "Times the emulator's core primitives and writes the results as JSON"
+              << std::endl
+              << "(schema \"unicorn-bios-microbench\", version 1)."
+              << std::endl
+              << std::endl
+              << "Options:"
+              << std::endl
+              << std::endl
+              << "    --help   / -h:    Displays help."
+              << std::endl
+              << "    --list:           Lists the benchmark names."
+              << std::endl
+              << "    --filter TEXT:    Only runs benchmarks whose name contains TEXT."
+              << std::endl
+              << "    --min-time MS:    Minimum run time per benchmark (defaults to 200)."
+              << std::endl
+              << "    --output FILE:    Writes the JSON results to FILE instead of stdout."
+              << std::endl;
+}
+
+static std::vector< Benchmark > benchmarks( const std::string & tmp )
+{
+    std::vector< Benchmark >              v;
+    std::shared_ptr< UB::Engine >         engine( std::make_shared< UB::Engine >( 2 * 1024 * 1024 ) );
+    std::shared_ptr< UB::BinaryFileStream > file( std::make_shared< UB::BinaryFileStream >( tmp ) );
+    std::vector< uint8_t >                data( code( 1024 * 1024 ) );
+    std::vector< uint8_t >                mbr( code( 512 ) );
+    
+    v.push_back
+    (
+        {
+            "engine.register.single",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += engine->eax();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "engine.register.individual-set",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += engine->eax() + engine->ebx() + engine->ecx() + engine->edx()
+                          + engine->esi() + engine->edi() + engine->ebp() + engine->esp()
+                          + engine->eip() + engine->eflags()
+                          + engine->cs()  + engine->ds()  + engine->es()  + engine->fs() + engine->gs() + engine->ss();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "registers.snapshot",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    UB::Registers registers( *( engine ) );
+                    
+                    sink += registers.eax();
+                }
+            }
+        }
+    );
+    
+    for( size_t size: { 1, 16, 512, 4096, 65536 } )
+    {
+        v.push_back
+        (
+            {
+                "engine.read." + std::to_string( size ),
+                [ = ]( size_t n )
+                {
+                    for( size_t i = 0; i < n; i++ )
+                    {
+                        sink += engine->read( 0x10000, size ).size();
+                    }
+                }
+            }
+        );
+        
+        v.push_back
+        (
+            {
+                "engine.write." + std::to_string( size ),
+                [ = ]( size_t n )
+                {
+                    std::vector< uint8_t > bytes( size, 0x90 );
+                    
+                    for( size_t i = 0; i < n; i++ )
+                    {
+                        engine->write( 0x10000, bytes );
+                    }
+                }
+            }
+        );
+    }
+    
+    for( size_t handlers: { 0, 1, 4, 16 } )
+    {
+        std::shared_ptr< UB::Engine > e( std::make_shared< UB::Engine >( 1024 * 1024 ) );
+        
+        e->write( 0x7C00, { 0xEB, 0xFE } );
+        e->cs( 0 );
+        e->ip( 0x7C00 );
+        
+        for( size_t i = 0; i < handlers; i++ )
+        {
+            e->beforeInstruction
+            (
+                []( uint64_t address, const std::vector< uint8_t > & instruction )
+                {
+                    sink += address + instruction.size();
+                }
+            );
+        }
+        
+        v.push_back
+        (
+            {
+                "engine.hooks.instruction." + std::to_string( handlers ),
+                [ = ]( size_t n )
+                {
+                    e->execute( n );
+                }
+            }
+        );
+    }
+    
+    v.push_back
+    (
+        {
+            "binarystream.data.uint32",
+            [ = ]( size_t n )
+            {
+                UB::BinaryDataStream stream( data );
+                
+                for( size_t i = 0; i < n; i++ )
+                {
+                    if( stream.availableBytes() < 4 )
+                    {
+                        stream.seek( 0, UB::BinaryStream::SeekDirection::Begin );
+                    }
+                    
+                    sink += stream.readLittleEndianUInt32();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "binarystream.data.uint64",
+            [ = ]( size_t n )
+            {
+                UB::BinaryDataStream stream( data );
+                
+                for( size_t i = 0; i < n; i++ )
+                {
+                    if( stream.availableBytes() < 8 )
+                    {
+                        stream.seek( 0, UB::BinaryStream::SeekDirection::Begin );
+                    }
+                    
+                    sink += stream.readLittleEndianUInt64();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "binarystream.file.uint32",
+            [ = ]( size_t n )
+            {
+                file->seek( 0, UB::BinaryStream::SeekDirection::Begin );
+                
+                for( size_t i = 0; i < n; i++ )
+                {
+                    if( file->availableBytes() < 4 )
+                    {
+                        file->seek( 0, UB::BinaryStream::SeekDirection::Begin );
+                    }
+                    
+                    sink += file->readLittleEndianUInt32();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "binarystream.file.read.512",
+            [ = ]( size_t n )
+            {
+                file->seek( 0, UB::BinaryStream::SeekDirection::Begin );
+                
+                for( size_t i = 0; i < n; i++ )
+                {
+                    if( file->availableBytes() < 512 )
+                    {
+                        file->seek( 0, UB::BinaryStream::SeekDirection::Begin );
+                    }
+                    
+                    sink += file->read( 512 ).size();
+                }
+            }
+        }
+    );
+    
+    for( size_t redirects: { 0, 1, 4 } )
+    {
+        v.push_back
+        (
+            {
+                "stringstream.append.redirects." + std::to_string( redirects ),
+                [ = ]( size_t n )
+                {
+                    std::ostream     null( nullptr );
+                    UB::StringStream ss;
+                    
+                    for( size_t i = 0; i < n; i++ )
+                    {
+                        if( i % 65536 == 0 )
+                        {
+                            ss = {};
+                            
+                            for( size_t j = 0; j < redirects; j++ )
+                            {
+                                ss.redirect( null );
+                            }
+                        }
+                        
+                        ss << "Debug line " << i << std::endl;
+                    }
+                    
+                    sink += ss.string().size();
+                }
+            }
+        );
+    }
+    
+    v.push_back
+    (
+        {
+            "string.tohex.uint8",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += UB::String::toHex( static_cast< uint8_t >( i ) ).size();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "string.tohex.uint32",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += UB::String::toHex( static_cast< uint32_t >( i ) ).size();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "string.tohex.uint64",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += UB::String::toHex( static_cast< uint64_t >( i ) ).size();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "capstone.disassemble.512",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += UB::Capstone::disassemble( mbr, 0x7C00 ).size();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "capstone.instructions.512",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += UB::Capstone::instructions( mbr, 0x7C00 ).size();
+                }
+            }
+        }
+    );
+    
+    v.push_back
+    (
+        {
+            "capstone.groups.512",
+            [ = ]( size_t n )
+            {
+                for( size_t i = 0; i < n; i++ )
+                {
+                    sink += UB::Capstone::groups( mbr, 0x7C00, 16 ).size();
+                }
+            }
+        }
+    );
+    
+    return v;
+}
+
+static std::vector< uint8_t > code( size_t size )
+{
+    std::vector< uint8_t > pattern
+    {
+        0xB8, 0x34, 0x12,       /* mov ax, 0x1234 */
+        0x01, 0xD8,             /* add ax, bx     */
+        0x8A, 0x07,             /* mov al, [bx]   */
+        0xCD, 0x10,             /* int 0x10       */
+        0x43,                   /* inc bx         */
+        0xE2, 0xF4              /* loop           */
+    };
+    std::vector< uint8_t > v;
+    
+    while( v.size() < size )
+    {
+        v.push_back( pattern[ v.size() % pattern.size() ] );
+    }
+    
+    return v;
+}
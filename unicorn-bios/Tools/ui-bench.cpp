@@ -0,0 +1,319 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "UB/Engine.hpp"
+#include "UB/UI.hpp"
+#include "UB/Screen.hpp"
+#include "UB/String.hpp"
+
+static void     showHelp( void );
+static uint64_t percentile( const std::vector< uint64_t > & values, double p );
+
+int main( int argc, const char * argv[] )
+{
+    try
+    {
+        unsigned short width( 160 );
+        unsigned short height( 50 );
+        size_t         frames( 500 );
+        size_t         logLines( 10000 );
+        
+        for( int i = 1; i < argc; i++ )
+        {
+            std::string arg( argv[ i ] );
+            
+            if( arg == "--help" || arg == "-h" )
+            {
+                showHelp();
+                
+                return EXIT_SUCCESS;
+            }
+            else if( arg == "--width" && i + 1 < argc )
+            {
+                width = static_cast< unsigned short >( std::atoi( argv[ ++i ] ) );
+            }
+            else if( arg == "--height" && i + 1 < argc )
+            {
+                height = static_cast< unsigned short >( std::atoi( argv[ ++i ] ) );
+            }
+            else if( arg == "--frames" && i + 1 < argc )
+            {
+                frames = std::max( static_cast< size_t >( std::atoll( argv[ ++i ] ) ), static_cast< size_t >( 1 ) );
+            }
+            else if( arg == "--log-lines" && i + 1 < argc )
+            {
+                logLines = static_cast< size_t >( std::atoll( argv[ ++i ] ) );
+            }
+            else
+            {
+                showHelp();
+                
+                return EXIT_FAILURE;
+            }
+        }
+        
+        {
+            int                                              master( posix_openpt( O_RDWR | O_NOCTTY ) );
+            int                                              slave;
+            struct winsize                                   size;
+            std::atomic< bool >                              draining( true );
+            std::atomic< uint64_t >                          bytes( 0 );
+            std::map< std::string, std::vector< uint64_t > > panels;
+            std::vector< uint64_t >                          intervals;
+            std::chrono::steady_clock::time_point            last;
+            size_t                                           frame( 0 );
+            std::mt19937                                     generator( 42 );
+            
+            if( master < 0 || grantpt( master ) != 0 || unlockpt( master ) != 0 )
+            {
+                throw std::runtime_error( "Cannot create pseudo-terminal" );
+            }
+            
+            if( ( slave = open( ptsname( master ), O_RDWR | O_NOCTTY ) ) < 0 )
+            {
+                throw std::runtime_error( "Cannot open pseudo-terminal" );
+            }
+            
+            memset( &size, 0, sizeof( size ) );
+            
+            size.ws_col = width;
+            size.ws_row = height;
+            
+            ioctl( slave, TIOCSWINSZ, &size );
+            setenv( "TERM", "xterm-256color", 0 );
+            
+            std::thread drain
+            (
+                [ & ]
+                {
+                    char buffer[ 65536 ];
+                    
+                    while( draining )
+                    {
+                        struct pollfd p;
+                        ssize_t       n;
+                        
+                        memset( &p, 0, sizeof( p ) );
+                        
+                        p.fd     = master;
+                        p.events = POLLIN;
+                        
+                        if( poll( &p, 1, 50 ) > 0 && ( n = read( master, buffer, sizeof( buffer ) ) ) > 0 )
+                        {
+                            bytes += static_cast< uint64_t >( n );
+                        }
+                    }
+                }
+            );
+            
+            UB::Screen::terminal( fdopen( slave, "w" ), fdopen( dup( slave ), "r" ) );
+            
+            {
+                UB::Engine engine( 2 * 1024 * 1024 );
+                UB::UI     ui( engine );
+                uint64_t   startBytes;
+                
+                ui.mode( UB::UI::Mode::Interactive );
+                ui.onPanelDisplayed
+                (
+                    [ & ]( const std::string & name, uint64_t time )
+                    {
+                        panels[ name ].push_back( time );
+                    }
+                );
+                
+                startBytes = bytes;
+                
+                UB::Screen::shared().onUpdate
+                (
+                    [ & ]( void )
+                    {
+                        auto now( std::chrono::steady_clock::now() );
+                        
+                        if( frame == 0 )
+                        {
+                            for( size_t i = 0; i < logLines; i++ )
+                            {
+                                ui.debug() << "Debug line " << std::to_string( i ) << ": " << UB::String::toHex( static_cast< uint32_t >( generator() ) ) << std::endl;
+                            }
+                        }
+                        else
+                        {
+                            intervals.push_back( static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( now - last ).count() ) );
+                        }
+                        
+                        last = now;
+                        
+                        if( frame++ == frames )
+                        {
+                            ui.stop();
+                            
+                            return;
+                        }
+                        
+                        {
+                            std::vector< uint8_t > memory( 512 );
+                            
+                            for( auto & b: memory )
+                            {
+                                b = static_cast< uint8_t >( generator() );
+                            }
+                            
+                            engine.write( 0x7C00, memory );
+                        }
+                        
+                        engine.eax( static_cast< uint32_t >( generator() ) );
+                        engine.ebx( static_cast< uint32_t >( generator() ) );
+                        engine.ecx( static_cast< uint32_t >( generator() ) );
+                        engine.edx( static_cast< uint32_t >( generator() ) );
+                        engine.esi( static_cast< uint32_t >( generator() ) );
+                        engine.edi( static_cast< uint32_t >( generator() ) );
+                        
+                        ui.debug()  << "Frame " << std::to_string( frame ) << std::endl;
+                        ui.output() << UB::String::toHex( static_cast< uint16_t >( generator() ) ) << " ";
+                    }
+                );
+                
+                ui.run();
+                
+                std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+                
+                draining = false;
+                
+                drain.join();
+                
+                {
+                    uint64_t total( 0 );
+                    uint64_t written( bytes - startBytes );
+                    
+                    for( const auto & p: panels )
+                    {
+                        for( uint64_t t: p.second )
+                        {
+                            total += t;
+                        }
+                    }
+                    
+                    std::sort( intervals.begin(), intervals.end() );
+                    
+                    std::cout << "Terminal:    " << width << "x" << height << std::endl
+                              << "Frames:      " << intervals.size() << std::endl
+                              << "Log lines:   " << logLines << std::endl
+                              << "Frame time:  p50 " << percentile( intervals, 0.5 ) / 1000 << " us, p99 " << percentile( intervals, 0.99 ) / 1000 << " us, max " << ( ( intervals.size() > 0 ) ? intervals.back() / 1000 : 0 ) << " us" << std::endl
+                              << "Bytes:       " << written << " (" << ( ( intervals.size() > 0 ) ? written / intervals.size() : 0 ) << " per frame)" << std::endl
+                              << std::endl
+                              << "Panel (us)        avg       p50       p99       max     share" << std::endl;
+                    
+                    for( auto & p: panels )
+                    {
+                        uint64_t sum( 0 );
+                        
+                        for( uint64_t t: p.second )
+                        {
+                            sum += t;
+                        }
+                        
+                        std::sort( p.second.begin(), p.second.end() );
+                        
+                        std::cout << std::left  << std::setw( 14 ) << p.first
+                                  << std::right << std::setw( 10 ) << sum / p.second.size() / 1000
+                                  << std::setw( 10 ) << percentile( p.second, 0.5 ) / 1000
+                                  << std::setw( 10 ) << percentile( p.second, 0.99 ) / 1000
+                                  << std::setw( 10 ) << p.second.back() / 1000
+                                  << std::setw( 9 )  << std::fixed << std::setprecision( 2 ) << ( ( total > 0 ) ? ( static_cast< double >( sum ) * 100.0 ) / static_cast< double >( total ) : 0 ) << "%"
+                                  << std::endl;
+                    }
+                }
+            }
+        }
+        
+        return EXIT_SUCCESS;
+    }
+    catch( const std::exception & e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        
+        return EXIT_FAILURE;
+    }
+    catch( ... )
+    {
+        std::cerr << "Unknown error" << std::endl;
+        
+        return EXIT_FAILURE;
+    }
+}
+
+static void showHelp( void )
+{
+    std::cout << "Usage: ui-bench [OPTIONS]"
+              << std::endl
+              << std::endl
+              << "Renders the interactive UI on a pseudo-terminal with a scripted machine"
+              << std::endl
+              << "state and reports frame time, per-panel display time and terminal output."
+              << std::endl
+              << std::endl
+              << "Options:"
+              << std::endl
+              << std::endl
+              << "    --help   / -h:    Displays help."
+              << std::endl
+              << "    --width N:        Terminal width (defaults to 160)."
+              << std::endl
+              << "    --height N:       Terminal height (defaults to 50)."
+              << std::endl
+              << "    --frames N:       Number of frames to render (defaults to 500)."
+              << std::endl
+              << "    --log-lines N:    Lines written to the debug log before the first"
+              << std::endl
+              << "                      frame (defaults to 10000)."
+              << std::endl;
+}
+
+static uint64_t percentile( const std::vector< uint64_t > & values, double p )
+{
+    size_t index;
+    
+    if( values.size() == 0 )
+    {
+        return 0;
+    }
+    
+    index = static_cast< size_t >( p * static_cast< double >( values.size() - 1 ) + 0.5 );
+    
+    return values[ std::min( index, values.size() - 1 ) ];
+}
@@ -0,0 +1,191 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/AhoCorasick.hpp"
+#include "UB/Casts.hpp"
+#include <queue>
+#include <limits>
+
+namespace UB
+{
+    class AhoCorasick::IMPL
+    {
+        public:
+            
+            IMPL( const std::vector< std::string > & patterns );
+            IMPL( const IMPL & o );
+            ~IMPL( void );
+            
+            void _build( void );
+            
+            std::vector< std::string > _patterns;
+            std::vector< uint32_t >    _transitions;
+            std::vector< size_t >      _matches;
+    };
+    
+    AhoCorasick::AhoCorasick( const std::vector< std::string > & patterns ):
+        impl( std::make_unique< IMPL >( patterns ) )
+    {}
+    
+    AhoCorasick::AhoCorasick( const AhoCorasick & o ):
+        impl( std::make_unique< IMPL >( *( o.impl ) ) )
+    {}
+    
+    AhoCorasick::AhoCorasick( AhoCorasick && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    AhoCorasick::~AhoCorasick( void )
+    {}
+    
+    AhoCorasick & AhoCorasick::operator =( AhoCorasick o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    std::vector< std::string > AhoCorasick::patterns( void ) const
+    {
+        return this->impl->_patterns;
+    }
+    
+    size_t AhoCorasick::numberOfStates( void ) const
+    {
+        return this->impl->_matches.size();
+    }
+    
+    uint32_t AhoCorasick::next( uint32_t state, uint8_t c ) const
+    {
+        return this->impl->_transitions[ ( static_cast< size_t >( state ) << 8 ) | c ];
+    }
+    
+    bool AhoCorasick::isMatch( uint32_t state ) const
+    {
+        return this->impl->_matches[ state ] != std::numeric_limits< size_t >::max();
+    }
+    
+    size_t AhoCorasick::match( uint32_t state ) const
+    {
+        return this->impl->_matches[ state ];
+    }
+    
+    void swap( AhoCorasick & o1, AhoCorasick & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    AhoCorasick::IMPL::IMPL( const std::vector< std::string > & patterns ):
+        _patterns( patterns )
+    {
+        this->_build();
+    }
+    
+    AhoCorasick::IMPL::IMPL( const IMPL & o ):
+        _patterns(    o._patterns ),
+        _transitions( o._transitions ),
+        _matches(     o._matches )
+    {}
+    
+    AhoCorasick::IMPL::~IMPL( void )
+    {}
+    
+    void AhoCorasick::IMPL::_build( void )
+    {
+        const uint32_t          none( std::numeric_limits< uint32_t >::max() );
+        std::vector< uint32_t > fail( 1, 0 );
+        std::queue< uint32_t >  queue;
+        
+        this->_transitions.assign( 256, none );
+        this->_matches.assign( 1, std::numeric_limits< size_t >::max() );
+        
+        for( size_t i = 0; i < this->_patterns.size(); i++ )
+        {
+            uint32_t state( 0 );
+            
+            if( this->_patterns[ i ].length() == 0 )
+            {
+                throw std::runtime_error( "Empty patterns are not allowed" );
+            }
+            
+            for( char c: this->_patterns[ i ] )
+            {
+                size_t index( ( static_cast< size_t >( state ) << 8 ) | static_cast< uint8_t >( c ) );
+                
+                if( this->_transitions[ index ] == none )
+                {
+                    this->_transitions[ index ] = numeric_cast< uint32_t >( this->_matches.size() );
+                    
+                    this->_transitions.resize( this->_transitions.size() + 256, none );
+                    this->_matches.push_back( std::numeric_limits< size_t >::max() );
+                    fail.push_back( 0 );
+                }
+                
+                state = this->_transitions[ index ];
+            }
+            
+            this->_matches[ state ] = std::min( this->_matches[ state ], i );
+        }
+        
+        for( size_t c = 0; c < 256; c++ )
+        {
+            if( this->_transitions[ c ] == none )
+            {
+                this->_transitions[ c ] = 0;
+            }
+            else
+            {
+                queue.push( this->_transitions[ c ] );
+            }
+        }
+        
+        while( queue.empty() == false )
+        {
+            uint32_t state( queue.front() );
+            
+            queue.pop();
+            
+            this->_matches[ state ] = std::min( this->_matches[ state ], this->_matches[ fail[ state ] ] );
+            
+            for( size_t c = 0; c < 256; c++ )
+            {
+                size_t   index( ( static_cast< size_t >( state ) << 8 ) | c );
+                uint32_t target( this->_transitions[ index ] );
+                
+                if( target == none )
+                {
+                    this->_transitions[ index ] = this->_transitions[ ( static_cast< size_t >( fail[ state ] ) << 8 ) | c ];
+                }
+                else
+                {
+                    fail[ target ] = this->_transitions[ ( static_cast< size_t >( fail[ state ] ) << 8 ) | c ];
+                    
+                    queue.push( target );
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_AHO_CORASICK_HPP
+#define UB_AHO_CORASICK_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UB
+{
+    class AhoCorasick
+    {
+        public:
+            
+            static const uint32_t InitialState = 0;
+            
+            AhoCorasick( const std::vector< std::string > & patterns );
+            AhoCorasick( const AhoCorasick & o );
+            AhoCorasick( AhoCorasick && o ) noexcept;
+            ~AhoCorasick( void );
+            
+            AhoCorasick & operator =( AhoCorasick o );
+            
+            std::vector< std::string > patterns( void )         const;
+            size_t                     numberOfStates( void )   const;
+            uint32_t                   next( uint32_t state, uint8_t c ) const;
+            bool                       isMatch( uint32_t state ) const;
+            size_t                     match( uint32_t state )   const;
+            
+            friend void swap( AhoCorasick & o1, AhoCorasick & o2 );
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_AHO_CORASICK_HPP */
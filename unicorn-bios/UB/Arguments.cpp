@@ -34,17 +34,41 @@ namespace UB
             IMPL( int argc, const char * argv[] );
             IMPL( const IMPL & o );
             
-            bool                    _showHelp;
-            bool                    _breakOnInterrupt;
-            bool                    _breakOnInterruptReturn;
-            bool                    _trap;
-            bool                    _debugVideo;
-            bool                    _singleStep;
-            bool                    _noUI;
-            bool                    _noColors;
-            size_t                  _memory;
-            std::string             _bootImage;
-            std::vector< uint64_t > _breakpoints;
+            bool                       _showHelp;
+            bool                       _breakOnInterrupt;
+            bool                       _breakOnInterruptReturn;
+            bool                       _trap;
+            bool                       _debugVideo;
+            bool                       _singleStep;
+            bool                       _noUI;
+            bool                       _noColors;
+            size_t                     _memory;
+            std::string                _bootImage;
+            std::vector< uint64_t >    _breakpoints;
+            std::string                _chunkStore;
+            std::string                _importManifest;
+            std::string                _prefetchDirectory;
+            std::string                _ioTrace;
+            std::vector< std::string > _expect;
+            std::vector< std::string > _failOn;
+            std::string                _timeline;
+            std::string                _instructionMix;
+            std::string                _memoryMap;
+            std::string                _hostProfile;
+            std::string                _timing;
+            std::string                _timingModel;
+            std::string                _cacheSim;
+            std::string                _cacheGeometry;
+            std::vector< std::string > _cacheRanges;
+            std::string                _flightRecorder;
+            std::string                _framebufferShm;
+            std::string                _diskReport;
+            std::string                _history;
+            bool                       _historyCheck;
+            size_t                     _historyWindow;
+            std::string                _milestoneOutput;
+            std::string                _milestones;
+            std::string                _script;
     };
     
     Arguments::Arguments( int argc, const char * argv[] ):
@@ -124,6 +148,126 @@ namespace UB
         return this->impl->_breakpoints;
     }
     
+    std::string Arguments::chunkStore( void ) const
+    {
+        return this->impl->_chunkStore;
+    }
+    
+    std::string Arguments::importManifest( void ) const
+    {
+        return this->impl->_importManifest;
+    }
+    
+    std::string Arguments::prefetchDirectory( void ) const
+    {
+        return this->impl->_prefetchDirectory;
+    }
+    
+    std::string Arguments::ioTrace( void ) const
+    {
+        return this->impl->_ioTrace;
+    }
+    
+    std::vector< std::string > Arguments::expect( void ) const
+    {
+        return this->impl->_expect;
+    }
+    
+    std::vector< std::string > Arguments::failOn( void ) const
+    {
+        return this->impl->_failOn;
+    }
+    
+    std::string Arguments::timeline( void ) const
+    {
+        return this->impl->_timeline;
+    }
+    
+    std::string Arguments::instructionMix( void ) const
+    {
+        return this->impl->_instructionMix;
+    }
+    
+    std::string Arguments::memoryMap( void ) const
+    {
+        return this->impl->_memoryMap;
+    }
+    
+    std::string Arguments::hostProfile( void ) const
+    {
+        return this->impl->_hostProfile;
+    }
+    
+    std::string Arguments::timing( void ) const
+    {
+        return this->impl->_timing;
+    }
+    
+    std::string Arguments::timingModel( void ) const
+    {
+        return this->impl->_timingModel;
+    }
+    
+    std::string Arguments::cacheSim( void ) const
+    {
+        return this->impl->_cacheSim;
+    }
+    
+    std::string Arguments::cacheGeometry( void ) const
+    {
+        return this->impl->_cacheGeometry;
+    }
+    
+    std::vector< std::string > Arguments::cacheRanges( void ) const
+    {
+        return this->impl->_cacheRanges;
+    }
+    
+    std::string Arguments::flightRecorder( void ) const
+    {
+        return this->impl->_flightRecorder;
+    }
+    
+    std::string Arguments::framebufferShm( void ) const
+    {
+        return this->impl->_framebufferShm;
+    }
+    
+    std::string Arguments::diskReport( void ) const
+    {
+        return this->impl->_diskReport;
+    }
+    
+    std::string Arguments::history( void ) const
+    {
+        return this->impl->_history;
+    }
+    
+    bool Arguments::historyCheck( void ) const
+    {
+        return this->impl->_historyCheck;
+    }
+    
+    size_t Arguments::historyWindow( void ) const
+    {
+        return this->impl->_historyWindow;
+    }
+    
+    std::string Arguments::milestoneOutput( void ) const
+    {
+        return this->impl->_milestoneOutput;
+    }
+    
+    std::string Arguments::milestones( void ) const
+    {
+        return this->impl->_milestones;
+    }
+    
+    std::string Arguments::script( void ) const
+    {
+        return this->impl->_script;
+    }
+    
     void swap( Arguments & o1, Arguments & o2 )
     {
         using std::swap;
@@ -140,7 +284,9 @@ namespace UB
         _singleStep(             false ),
         _noUI(                   false ),
         _noColors(               false ),
-        _memory(                 0 )
+        _memory(                 0 ),
+        _historyCheck(           false ),
+        _historyWindow(          0 )
     {
         if( argc < 1 )
         {
@@ -207,6 +353,176 @@ namespace UB
                     {}
                 }
             }
+            else if( arg == "--chunk-store" )
+            {
+                if( ++i < argc )
+                {
+                    this->_chunkStore = argv[ i ];
+                }
+            }
+            else if( arg == "--import" )
+            {
+                if( ++i < argc )
+                {
+                    this->_importManifest = argv[ i ];
+                }
+            }
+            else if( arg == "--prefetch" )
+            {
+                if( ++i < argc )
+                {
+                    this->_prefetchDirectory = argv[ i ];
+                }
+            }
+            else if( arg == "--io-trace" )
+            {
+                if( ++i < argc )
+                {
+                    this->_ioTrace = argv[ i ];
+                }
+            }
+            else if( arg == "--expect" )
+            {
+                if( ++i < argc )
+                {
+                    this->_expect.push_back( argv[ i ] );
+                }
+            }
+            else if( arg == "--fail-on" )
+            {
+                if( ++i < argc )
+                {
+                    this->_failOn.push_back( argv[ i ] );
+                }
+            }
+            else if( arg == "--timeline" )
+            {
+                if( ++i < argc )
+                {
+                    this->_timeline = argv[ i ];
+                }
+            }
+            else if( arg == "--instruction-mix" )
+            {
+                if( ++i < argc )
+                {
+                    this->_instructionMix = argv[ i ];
+                }
+            }
+            else if( arg == "--memory-map" )
+            {
+                if( ++i < argc )
+                {
+                    this->_memoryMap = argv[ i ];
+                }
+            }
+            else if( arg == "--host-profile" )
+            {
+                if( ++i < argc )
+                {
+                    this->_hostProfile = argv[ i ];
+                }
+            }
+            else if( arg == "--timing" )
+            {
+                if( ++i < argc )
+                {
+                    this->_timing = argv[ i ];
+                }
+            }
+            else if( arg == "--timing-model" )
+            {
+                if( ++i < argc )
+                {
+                    this->_timingModel = argv[ i ];
+                }
+            }
+            else if( arg == "--cache-sim" )
+            {
+                if( ++i < argc )
+                {
+                    this->_cacheSim = argv[ i ];
+                }
+            }
+            else if( arg == "--cache-geometry" )
+            {
+                if( ++i < argc )
+                {
+                    this->_cacheGeometry = argv[ i ];
+                }
+            }
+            else if( arg == "--cache-range" )
+            {
+                if( ++i < argc )
+                {
+                    this->_cacheRanges.push_back( argv[ i ] );
+                }
+            }
+            else if( arg == "--flight-recorder" )
+            {
+                if( ++i < argc )
+                {
+                    this->_flightRecorder = argv[ i ];
+                }
+            }
+            else if( arg == "--framebuffer-shm" )
+            {
+                if( ++i < argc )
+                {
+                    this->_framebufferShm = argv[ i ];
+                }
+            }
+            else if( arg == "--disk-report" )
+            {
+                if( ++i < argc )
+                {
+                    this->_diskReport = argv[ i ];
+                }
+            }
+            else if( arg == "--history" )
+            {
+                if( ++i < argc )
+                {
+                    this->_history = argv[ i ];
+                }
+            }
+            else if( arg == "--history-check" )
+            {
+                this->_historyCheck = true;
+            }
+            else if( arg == "--history-window" )
+            {
+                if( ++i < argc )
+                {
+                    try
+                    {
+                        this->_historyWindow = static_cast< size_t >( std::atoll( argv[ i ] ) );
+                    }
+                    catch( ... )
+                    {}
+                }
+            }
+            else if( arg == "--milestone-output" )
+            {
+                if( ++i < argc )
+                {
+                    this->_milestoneOutput = argv[ i ];
+                }
+            }
+            else if( arg == "--milestones" )
+            {
+                if( ++i < argc )
+                {
+                    this->_milestones = argv[ i ];
+                }
+            }
+            else if( arg == "--script" )
+            {
+                if( ++i < argc )
+                {
+                    this->_script = argv[ i ];
+                }
+            }
             else if( this->_bootImage.length() == 0 )
             {
                 this->_bootImage = arg;
@@ -225,6 +541,30 @@ namespace UB
         _noColors(                o._noColors ),
         _memory(                  o._memory ),
         _bootImage(               o._bootImage ),
-        _breakpoints(             o._breakpoints )
+        _breakpoints(             o._breakpoints ),
+        _chunkStore(              o._chunkStore ),
+        _importManifest(          o._importManifest ),
+        _prefetchDirectory(       o._prefetchDirectory ),
+        _ioTrace(                 o._ioTrace ),
+        _expect(                  o._expect ),
+        _failOn(                  o._failOn ),
+        _timeline(                o._timeline ),
+        _instructionMix(          o._instructionMix ),
+        _memoryMap(               o._memoryMap ),
+        _hostProfile(             o._hostProfile ),
+        _timing(                  o._timing ),
+        _timingModel(             o._timingModel ),
+        _cacheSim(                o._cacheSim ),
+        _cacheGeometry(           o._cacheGeometry ),
+        _cacheRanges(             o._cacheRanges ),
+        _flightRecorder(          o._flightRecorder ),
+        _framebufferShm(          o._framebufferShm ),
+        _diskReport(              o._diskReport ),
+        _history(                 o._history ),
+        _historyCheck(            o._historyCheck ),
+        _historyWindow(           o._historyWindow ),
+        _milestoneOutput(         o._milestoneOutput ),
+        _milestones(              o._milestones ),
+        _script(                  o._script )
     {}
 }
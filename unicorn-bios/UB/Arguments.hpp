@@ -43,17 +43,41 @@ namespace UB
             
             Arguments & operator =( Arguments o );
             
-            bool                    showHelp( void )               const;
-            bool                    breakOnInterrupt( void )       const;
-            bool                    breakOnInterruptReturn( void ) const;
-            bool                    trap( void )                   const;
-            bool                    debugVideo( void )             const;
-            bool                    singleStep( void )             const;
-            bool                    noUI( void )                   const;
-            bool                    noColors( void )               const;
-            size_t                  memory( void )                 const;
-            std::string             bootImage( void )              const;
-            std::vector< uint64_t > breakpoints( void )            const;
+            bool                       showHelp( void )               const;
+            bool                       breakOnInterrupt( void )       const;
+            bool                       breakOnInterruptReturn( void ) const;
+            bool                       trap( void )                   const;
+            bool                       debugVideo( void )             const;
+            bool                       singleStep( void )             const;
+            bool                       noUI( void )                   const;
+            bool                       noColors( void )               const;
+            size_t                     memory( void )                 const;
+            std::string                bootImage( void )              const;
+            std::vector< uint64_t >    breakpoints( void )            const;
+            std::string                chunkStore( void )             const;
+            std::string                importManifest( void )         const;
+            std::string                prefetchDirectory( void )      const;
+            std::string                ioTrace( void )                const;
+            std::vector< std::string > expect( void )                 const;
+            std::vector< std::string > failOn( void )                 const;
+            std::string                timeline( void )               const;
+            std::string                instructionMix( void )         const;
+            std::string                memoryMap( void )              const;
+            std::string                hostProfile( void )            const;
+            std::string                timing( void )                 const;
+            std::string                timingModel( void )            const;
+            std::string                cacheSim( void )               const;
+            std::string                cacheGeometry( void )          const;
+            std::vector< std::string > cacheRanges( void )            const;
+            std::string                flightRecorder( void )         const;
+            std::string                framebufferShm( void )         const;
+            std::string                diskReport( void )             const;
+            std::string                history( void )                const;
+            bool                       historyCheck( void )           const;
+            size_t                     historyWindow( void )          const;
+            std::string                milestoneOutput( void )        const;
+            std::string                milestones( void )             const;
+            std::string                script( void )                 const;
             
             friend void swap( Arguments & o1, Arguments & o2 );
             
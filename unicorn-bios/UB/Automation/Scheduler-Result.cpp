@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/Automation/Scheduler.hpp"
+
+namespace UB
+{
+    namespace Automation
+    {
+        class Scheduler::Result::IMPL
+        {
+            public:
+                
+                IMPL( Status status, size_t step, const std::string & description, uint64_t instructions );
+                IMPL( const IMPL & o );
+                ~IMPL( void );
+                
+                Status      _status;
+                size_t      _step;
+                std::string _description;
+                uint64_t    _instructions;
+        };
+        
+        Scheduler::Result::Result( Status status, size_t step, const std::string & description, uint64_t instructions ):
+            impl( std::make_unique< IMPL >( status, step, description, instructions ) )
+        {}
+        
+        Scheduler::Result::Result( const Result & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        Scheduler::Result::Result( Result && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        Scheduler::Result::~Result( void )
+        {}
+        
+        Scheduler::Result & Scheduler::Result::operator =( Result o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        Scheduler::Result::Status Scheduler::Result::status( void ) const
+        {
+            return this->impl->_status;
+        }
+        
+        size_t Scheduler::Result::step( void ) const
+        {
+            return this->impl->_step;
+        }
+        
+        std::string Scheduler::Result::description( void ) const
+        {
+            return this->impl->_description;
+        }
+        
+        uint64_t Scheduler::Result::instructions( void ) const
+        {
+            return this->impl->_instructions;
+        }
+        
+        Scheduler::Result::operator bool( void ) const
+        {
+            return this->impl->_status == Status::Completed;
+        }
+        
+        void swap( Scheduler::Result & o1, Scheduler::Result & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        Scheduler::Result::IMPL::IMPL( Status status, size_t step, const std::string & description, uint64_t instructions ):
+            _status(       status ),
+            _step(         step ),
+            _description(  description ),
+            _instructions( instructions )
+        {}
+        
+        Scheduler::Result::IMPL::IMPL( const IMPL & o ):
+            _status(       o._status ),
+            _step(         o._step ),
+            _description(  o._description ),
+            _instructions( o._instructions )
+        {}
+        
+        Scheduler::Result::IMPL::~IMPL( void )
+        {}
+    }
+}
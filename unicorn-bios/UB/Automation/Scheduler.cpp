@@ -0,0 +1,330 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/Automation/Scheduler.hpp"
+#include "UB/Machine.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <optional>
+#include <limits>
+
+namespace UB
+{
+    namespace Automation
+    {
+        class Task
+        {
+            public:
+                
+                Task( const std::shared_ptr< Machine > & machine, const Script & script ):
+                    _machine( machine ),
+                    _script( script ),
+                    _step( 0 ),
+                    _started( false ),
+                    _satisfied( false ),
+                    _initial( machine->instructions() )
+                {}
+                
+                Script::Step * current( void )
+                {
+                    if( this->_step >= this->_script.numberOfSteps() || this->_started == false )
+                    {
+                        return nullptr;
+                    }
+                    
+                    return &( this->_script.step( this->_step ) );
+                }
+                
+                void satisfy( void )
+                {
+                    this->_satisfied = true;
+                    
+                    this->_machine->stop();
+                }
+                
+                std::shared_ptr< Machine >              _machine;
+                Script                                  _script;
+                size_t                                  _step;
+                bool                                    _started;
+                bool                                    _satisfied;
+                uint64_t                                _initial;
+                std::promise< Scheduler::Result >       _promise;
+        };
+        
+        class Scheduler::IMPL
+        {
+            public:
+                
+                IMPL( size_t threads, size_t quantum );
+                ~IMPL( void );
+                
+                void _work( void );
+                bool _run( const std::shared_ptr< Task > & task );
+                void _finish( const std::shared_ptr< Task > & task, Result::Status status );
+                
+                size_t                                  _quantum;
+                std::vector< std::thread >              _threads;
+                std::deque< std::shared_ptr< Task > >   _ready;
+                size_t                                  _pending;
+                bool                                    _exit;
+                mutable std::mutex                      _mtx;
+                mutable std::condition_variable         _cv;
+                mutable std::condition_variable         _finished;
+        };
+        
+        Scheduler::Scheduler( size_t threads, size_t quantum ):
+            impl( std::make_unique< IMPL >( threads, quantum ) )
+        {}
+        
+        Scheduler::~Scheduler( void )
+        {}
+        
+        std::future< Scheduler::Result > Scheduler::schedule( const std::shared_ptr< Machine > & machine, const Script & script )
+        {
+            std::shared_ptr< Task > task( std::make_shared< Task >( machine, script ) );
+            std::weak_ptr< Task >   weak( task );
+            std::future< Result >   future( task->_promise.get_future() );
+            
+            machine->onOutput
+            (
+                [ = ]( Machine::Output output, uint8_t c )
+                {
+                    std::shared_ptr< Task > t( weak.lock() );
+                    Script::Step          * step( ( t == nullptr ) ? nullptr : t->current() );
+                    
+                    ( void )output;
+                    
+                    if( step != nullptr && t->_satisfied == false && step->output( c ) )
+                    {
+                        t->satisfy();
+                    }
+                }
+            );
+            
+            machine->onInterrupt
+            (
+                [ = ]( uint32_t number )
+                {
+                    std::shared_ptr< Task > t( weak.lock() );
+                    Script::Step          * step( ( t == nullptr ) ? nullptr : t->current() );
+                    
+                    if( step != nullptr && t->_satisfied == false && step->interrupt( number ) )
+                    {
+                        t->satisfy();
+                    }
+                }
+            );
+            
+            {
+                std::lock_guard< std::mutex > l( this->impl->_mtx );
+                
+                this->impl->_ready.push_back( task );
+                this->impl->_pending++;
+            }
+            
+            this->impl->_cv.notify_one();
+            
+            return future;
+        }
+        
+        size_t Scheduler::threads( void ) const
+        {
+            return this->impl->_threads.size();
+        }
+        
+        size_t Scheduler::quantum( void ) const
+        {
+            return this->impl->_quantum;
+        }
+        
+        size_t Scheduler::pending( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_pending;
+        }
+        
+        void Scheduler::waitUntilFinished( void ) const
+        {
+            std::unique_lock< std::mutex > l( this->impl->_mtx );
+            
+            this->impl->_finished.wait( l, [ & ] { return this->impl->_pending == 0; } );
+        }
+        
+        Scheduler::IMPL::IMPL( size_t threads, size_t quantum ):
+            _quantum( std::max< size_t >( quantum, 1 ) ),
+            _pending( 0 ),
+            _exit(    false )
+        {
+            if( threads == 0 )
+            {
+                threads = std::max< size_t >( std::thread::hardware_concurrency(), 1 );
+            }
+            
+            for( size_t i = 0; i < threads; i++ )
+            {
+                this->_threads.push_back( std::thread( [ = ] { this->_work(); } ) );
+            }
+        }
+        
+        Scheduler::IMPL::~IMPL( void )
+        {
+            {
+                std::lock_guard< std::mutex > l( this->_mtx );
+                
+                this->_exit = true;
+            }
+            
+            this->_cv.notify_all();
+            
+            for( auto & thread: this->_threads )
+            {
+                thread.join();
+            }
+            
+            for( const auto & task: this->_ready )
+            {
+                this->_finish( task, Result::Status::Failed );
+            }
+        }
+        
+        void Scheduler::IMPL::_work( void )
+        {
+            while( true )
+            {
+                std::shared_ptr< Task > task;
+                
+                {
+                    std::unique_lock< std::mutex > l( this->_mtx );
+                    
+                    this->_cv.wait( l, [ & ] { return this->_exit || this->_ready.size() > 0; } );
+                    
+                    if( this->_exit )
+                    {
+                        return;
+                    }
+                    
+                    task = this->_ready.front();
+                    
+                    this->_ready.pop_front();
+                }
+                
+                if( this->_run( task ) )
+                {
+                    {
+                        std::lock_guard< std::mutex > l( this->_mtx );
+                        
+                        this->_ready.push_back( task );
+                    }
+                    
+                    this->_cv.notify_one();
+                }
+            }
+        }
+        
+        bool Scheduler::IMPL::_run( const std::shared_ptr< Task > & task )
+        {
+            Machine                 & machine( *( task->_machine ) );
+            std::optional< uint64_t > until;
+            
+            while( task->_step < task->_script.numberOfSteps() )
+            {
+                if( task->_started == false )
+                {
+                    task->_satisfied = false;
+                    task->_started   = true;
+                    
+                    if( task->_script.step( task->_step ).start( machine ) )
+                    {
+                        task->_satisfied = true;
+                    }
+                }
+                
+                until = task->_script.step( task->_step ).until();
+                
+                /* Execution stopped right before the address (or the step started there) */
+                if( task->_satisfied == false && until.has_value() && machine.pc() == until.value() )
+                {
+                    task->_satisfied = true;
+                }
+                
+                if( task->_satisfied == false )
+                {
+                    break;
+                }
+                
+                task->_step++;
+                
+                task->_started = false;
+            }
+            
+            if( task->_step == task->_script.numberOfSteps() )
+            {
+                this->_finish( task, Result::Status::Completed );
+                
+                return false;
+            }
+            
+            if( machine.instructions() - task->_initial >= task->_script.limit() )
+            {
+                this->_finish( task, Result::Status::LimitReached );
+                
+                return false;
+            }
+            
+            if( machine.execute( this->_quantum, until.value_or( std::numeric_limits< uint64_t >::max() ) ) == false && task->_satisfied == false )
+            {
+                this->_finish( task, Result::Status::Failed );
+                
+                return false;
+            }
+            
+            return true;
+        }
+        
+        void Scheduler::IMPL::_finish( const std::shared_ptr< Task > & task, Result::Status status )
+        {
+            std::string description;
+            
+            if( task->_step < task->_script.numberOfSteps() )
+            {
+                description = task->_script.step( task->_step ).description();
+            }
+            
+            task->_promise.set_value( Result( status, task->_step, description, task->_machine->instructions() - task->_initial ) );
+            
+            {
+                std::lock_guard< std::mutex > l( this->_mtx );
+                
+                this->_pending--;
+            }
+            
+            this->_finished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_AUTOMATION_SCHEDULER_HPP
+#define UB_AUTOMATION_SCHEDULER_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <future>
+#include "UB/Automation/Script.hpp"
+
+namespace UB
+{
+    class Machine;
+    
+    namespace Automation
+    {
+        class Scheduler
+        {
+            public:
+                
+                class Result
+                {
+                    public:
+                        
+                        enum class Status
+                        {
+                            Completed,
+                            Failed,
+                            LimitReached
+                        };
+                        
+                        Result( Status status, size_t step, const std::string & description, uint64_t instructions );
+                        Result( const Result & o );
+                        Result( Result && o ) noexcept;
+                        ~Result( void );
+                        
+                        Result & operator =( Result o );
+                        
+                        Status      status( void )       const;
+                        size_t      step( void )         const;
+                        std::string description( void )  const;
+                        uint64_t    instructions( void ) const;
+                        
+                        operator bool( void ) const;
+                        
+                        friend void swap( Result & o1, Result & o2 );
+                        
+                    private:
+                        
+                        class IMPL;
+                        std::unique_ptr< IMPL > impl;
+                };
+                
+                Scheduler( size_t threads = 0, size_t quantum = 100000 );
+                ~Scheduler( void );
+                
+                Scheduler( const Scheduler & o )              = delete;
+                Scheduler( Scheduler && o )                   = delete;
+                Scheduler & operator =( const Scheduler & o ) = delete;
+                Scheduler & operator =( Scheduler && o )      = delete;
+                
+                std::future< Result > schedule( const std::shared_ptr< Machine > & machine, const Script & script );
+                
+                size_t threads( void ) const;
+                size_t quantum( void ) const;
+                size_t pending( void ) const;
+                
+                void waitUntilFinished( void ) const;
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_AUTOMATION_SCHEDULER_HPP */
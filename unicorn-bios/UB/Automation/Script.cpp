@@ -0,0 +1,537 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/Automation/Script.hpp"
+#include "UB/AhoCorasick.hpp"
+#include "UB/Machine.hpp"
+#include "UB/String.hpp"
+#include "UB/Casts.hpp"
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+
+namespace UB
+{
+    namespace Automation
+    {
+        class RunUntil: public Script::Step
+        {
+            public:
+                
+                RunUntil( uint64_t address ):
+                    _address( address )
+                {}
+                
+                std::unique_ptr< Script::Step > copy( void ) const override
+                {
+                    return std::make_unique< RunUntil >( this->_address );
+                }
+                
+                std::string description( void ) const override
+                {
+                    return "Run until " + String::toHex( this->_address );
+                }
+                
+                bool start( Machine & machine ) override
+                {
+                    ( void )machine;
+                    
+                    return false;
+                }
+                
+                std::optional< uint64_t > until( void ) const override
+                {
+                    return this->_address;
+                }
+                
+            private:
+                
+                uint64_t _address;
+        };
+        
+        class OutputContains: public Script::Step
+        {
+            public:
+                
+                OutputContains( const std::string & text ):
+                    _matcher( { text } ),
+                    _state( AhoCorasick::InitialState )
+                {}
+                
+                std::unique_ptr< Script::Step > copy( void ) const override
+                {
+                    return std::make_unique< OutputContains >( this->_matcher.patterns().front() );
+                }
+                
+                std::string description( void ) const override
+                {
+                    return "Output contains \"" + this->_matcher.patterns().front() + "\"";
+                }
+                
+                bool start( Machine & machine ) override
+                {
+                    ( void )machine;
+                    
+                    this->_state = AhoCorasick::InitialState;
+                    
+                    return false;
+                }
+                
+                bool output( uint8_t c ) override
+                {
+                    this->_state = this->_matcher.next( this->_state, c );
+                    
+                    return this->_matcher.isMatch( this->_state );
+                }
+                
+            private:
+                
+                AhoCorasick _matcher;
+                uint32_t    _state;
+        };
+        
+        class Interrupt: public Script::Step
+        {
+            public:
+                
+                Interrupt( uint32_t number ):
+                    _number( number )
+                {}
+                
+                std::unique_ptr< Script::Step > copy( void ) const override
+                {
+                    return std::make_unique< Interrupt >( this->_number );
+                }
+                
+                std::string description( void ) const override
+                {
+                    return "Interrupt " + String::toHex( this->_number );
+                }
+                
+                bool start( Machine & machine ) override
+                {
+                    ( void )machine;
+                    
+                    return false;
+                }
+                
+                bool interrupt( uint32_t number ) override
+                {
+                    return number == this->_number;
+                }
+                
+            private:
+                
+                uint32_t _number;
+        };
+        
+        class Action: public Script::Step
+        {
+            public:
+                
+                Action( const std::string & description, const std::function< void( Machine & ) > & f ):
+                    _description( description ),
+                    _f( f )
+                {}
+                
+                std::unique_ptr< Script::Step > copy( void ) const override
+                {
+                    return std::make_unique< Action >( this->_description, this->_f );
+                }
+                
+                std::string description( void ) const override
+                {
+                    return this->_description;
+                }
+                
+                bool start( Machine & machine ) override
+                {
+                    this->_f( machine );
+                    
+                    return true;
+                }
+                
+            private:
+                
+                std::string                       _description;
+                std::function< void( Machine & ) > _f;
+        };
+        
+        class Script::IMPL
+        {
+            public:
+                
+                IMPL( void );
+                IMPL( const IMPL & o );
+                ~IMPL( void );
+                
+                static uint64_t    _integer( const std::string & s, const std::string & location );
+                static std::string _text( const std::string & s, const std::string & location );
+                
+                std::vector< std::unique_ptr< Step > > _steps;
+                uint64_t                               _limit;
+        };
+        
+        bool Script::Step::output( uint8_t c )
+        {
+            ( void )c;
+            
+            return false;
+        }
+        
+        bool Script::Step::interrupt( uint32_t number )
+        {
+            ( void )number;
+            
+            return false;
+        }
+        
+        std::optional< uint64_t > Script::Step::until( void ) const
+        {
+            return {};
+        }
+        
+        /*
+         * One step per line, '#' starts a comment:
+         * 
+         *     limit INSTRUCTIONS
+         *     run-until ADDRESS
+         *     output TEXT
+         *     interrupt NUMBER
+         *     keys TEXT
+         *     dump ADDRESS SIZE
+         * 
+         * Numbers are decimal or 0x-prefixed hexadecimal, addresses are
+         * linear. TEXT is the rest of the line, with \n, \r, \t, \\ and
+         * \xHH escapes.
+         */
+        Script Script::fromFile( const std::string & path )
+        {
+            std::ifstream stream( path );
+            std::string   line;
+            size_t        n( 0 );
+            Script        script;
+            
+            if( stream.good() == false )
+            {
+                throw std::runtime_error( "Cannot read script: " + path );
+            }
+            
+            while( std::getline( stream, line ) )
+            {
+                std::string       location( path + ":" + std::to_string( ++n ) );
+                std::stringstream ss( line );
+                std::string       command;
+                std::string       rest;
+                
+                if( ( ss >> command ).fail() || command[ 0 ] == '#' )
+                {
+                    continue;
+                }
+                
+                std::getline( ss >> std::ws, rest );
+                
+                if( command == "limit" )
+                {
+                    script.limit( IMPL::_integer( rest, location ) );
+                }
+                else if( command == "run-until" )
+                {
+                    script.runUntil( IMPL::_integer( rest, location ) );
+                }
+                else if( command == "output" )
+                {
+                    script.outputContains( IMPL::_text( rest, location ) );
+                }
+                else if( command == "interrupt" )
+                {
+                    script.interrupt( static_cast< uint32_t >( IMPL::_integer( rest, location ) ) );
+                }
+                else if( command == "keys" )
+                {
+                    script.sendKeys( IMPL::_text( rest, location ) );
+                }
+                else if( command == "dump" )
+                {
+                    std::stringstream args( rest );
+                    std::string       s1;
+                    std::string       s2;
+                    uint64_t          address;
+                    size_t            size;
+                    
+                    args >> s1 >> s2;
+                    
+                    address = IMPL::_integer( s1, location );
+                    size    = numeric_cast< size_t >( IMPL::_integer( s2, location ) );
+                    
+                    script.add
+                    (
+                        std::make_unique< Action >
+                        (
+                            "Dump memory at " + String::toHex( address ),
+                            [ = ]( Machine & machine )
+                            {
+                                std::vector< uint8_t > data( machine.read( address, size ) );
+                                std::stringstream      dump;
+                                
+                                for( size_t i = 0; i < data.size(); i++ )
+                                {
+                                    if( i % 16 == 0 )
+                                    {
+                                        dump << ( ( i > 0 ) ? "\n" : "" ) << String::toHex( address + i ) << ":";
+                                    }
+                                    
+                                    dump << " " << std::hex << std::uppercase << std::setfill( '0' ) << std::setw( 2 ) << static_cast< unsigned int >( data[ i ] );
+                                }
+                                
+                                machine.ui().debug() << dump.str() << std::endl;
+                            }
+                        )
+                    );
+                }
+                else
+                {
+                    throw std::runtime_error( "Unknown script command at " + location + ": " + command );
+                }
+            }
+            
+            return script;
+        }
+        
+        Script::Script( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        Script::Script( const Script & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        Script::Script( Script && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        Script::~Script( void )
+        {}
+        
+        Script & Script::operator =( Script o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        Script & Script::runUntil( uint64_t address )
+        {
+            return this->add( std::make_unique< RunUntil >( address ) );
+        }
+        
+        Script & Script::outputContains( const std::string & text )
+        {
+            return this->add( std::make_unique< OutputContains >( text ) );
+        }
+        
+        Script & Script::interrupt( uint32_t number )
+        {
+            return this->add( std::make_unique< Interrupt >( number ) );
+        }
+        
+        Script & Script::sendKeys( const std::string & keys )
+        {
+            return this->add
+            (
+                std::make_unique< Action >
+                (
+                    "Send keys",
+                    [ = ]( Machine & machine )
+                    {
+                        machine.sendKeys( keys );
+                    }
+                )
+            );
+        }
+        
+        Script & Script::readMemory( uint64_t address, size_t size, const std::function< void( const std::vector< uint8_t > & ) > & f )
+        {
+            return this->add
+            (
+                std::make_unique< Action >
+                (
+                    "Read memory at " + String::toHex( address ),
+                    [ = ]( Machine & machine )
+                    {
+                        f( machine.read( address, size ) );
+                    }
+                )
+            );
+        }
+        
+        Script & Script::then( const std::function< void( Machine & ) > & f )
+        {
+            return this->add( std::make_unique< Action >( "Action", f ) );
+        }
+        
+        Script & Script::add( std::unique_ptr< Step > step )
+        {
+            if( step == nullptr )
+            {
+                throw std::runtime_error( "Invalid script step" );
+            }
+            
+            this->impl->_steps.push_back( std::move( step ) );
+            
+            return *( this );
+        }
+        
+        Script & Script::limit( uint64_t instructions )
+        {
+            this->impl->_limit = instructions;
+            
+            return *( this );
+        }
+        
+        uint64_t Script::limit( void ) const
+        {
+            return this->impl->_limit;
+        }
+        
+        size_t Script::numberOfSteps( void ) const
+        {
+            return this->impl->_steps.size();
+        }
+        
+        Script::Step & Script::step( size_t index ) const
+        {
+            if( index >= this->impl->_steps.size() )
+            {
+                throw std::runtime_error( "Invalid script step index: " + std::to_string( index ) );
+            }
+            
+            return *( this->impl->_steps[ index ] );
+        }
+        
+        void swap( Script & o1, Script & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        Script::IMPL::IMPL( void ):
+            _limit( std::numeric_limits< uint64_t >::max() )
+        {}
+        
+        Script::IMPL::IMPL( const IMPL & o ):
+            _limit( o._limit )
+        {
+            for( const auto & step: o._steps )
+            {
+                this->_steps.push_back( step->copy() );
+            }
+        }
+        
+        Script::IMPL::~IMPL( void )
+        {}
+        
+        uint64_t Script::IMPL::_integer( const std::string & s, const std::string & location )
+        {
+            bool     hex( s.length() > 2 && s[ 0 ] == '0' && ( s[ 1 ] == 'x' || s[ 1 ] == 'X' ) );
+            size_t   end( 0 );
+            uint64_t value( 0 );
+            
+            if( s.length() > 0 && std::isdigit( static_cast< unsigned char >( s[ 0 ] ) ) )
+            {
+                try
+                {
+                    value = std::stoull( s, &end, ( hex ) ? 16 : 10 );
+                }
+                catch( const std::exception & e )
+                {
+                    ( void )e;
+                    
+                    end = 0;
+                }
+            }
+            
+            if( end == 0 || end != s.length() )
+            {
+                throw std::runtime_error( "Invalid number at " + location + ": " + s );
+            }
+            
+            return value;
+        }
+        
+        std::string Script::IMPL::_text( const std::string & s, const std::string & location )
+        {
+            std::string text;
+            
+            for( size_t i = 0; i < s.length(); i++ )
+            {
+                if( s[ i ] != '\\' )
+                {
+                    text += s[ i ];
+                    
+                    continue;
+                }
+                
+                if( ++i == s.length() )
+                {
+                    throw std::runtime_error( "Invalid escape at " + location );
+                }
+                
+                switch( s[ i ] )
+                {
+                    case 'n':  text += '\n'; break;
+                    case 'r':  text += '\r'; break;
+                    case 't':  text += '\t'; break;
+                    case '\\': text += '\\'; break;
+                    
+                    case 'x':
+                        
+                        if( i + 2 >= s.length() )
+                        {
+                            throw std::runtime_error( "Invalid escape at " + location );
+                        }
+                        
+                        text += static_cast< char >( _integer( "0x" + s.substr( i + 1, 2 ), location ) );
+                        i    += 2;
+                        
+                        break;
+                    
+                    default:
+                        
+                        throw std::runtime_error( "Invalid escape at " + location );
+                }
+            }
+            
+            if( text.length() == 0 )
+            {
+                throw std::runtime_error( "Missing text at " + location );
+            }
+            
+            return text;
+        }
+    }
+}
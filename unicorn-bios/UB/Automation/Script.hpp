@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_AUTOMATION_SCRIPT_HPP
+#define UB_AUTOMATION_SCRIPT_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <optional>
+
+namespace UB
+{
+    class Machine;
+    
+    namespace Automation
+    {
+        class Script
+        {
+            public:
+                
+                class Step
+                {
+                    public:
+                        
+                        virtual ~Step( void ) = default;
+                        
+                        virtual std::unique_ptr< Step > copy( void )        const = 0;
+                        virtual std::string             description( void ) const = 0;
+                        virtual bool                    start( Machine & machine ) = 0;
+                        
+                        virtual bool output( uint8_t c );
+                        virtual bool interrupt( uint32_t number );
+                        
+                        /* Linear address execution must stop before, if the step waits for one */
+                        virtual std::optional< uint64_t > until( void ) const;
+                };
+                
+                static Script fromFile( const std::string & path );
+                
+                Script( void );
+                Script( const Script & o );
+                Script( Script && o ) noexcept;
+                ~Script( void );
+                
+                Script & operator =( Script o );
+                
+                Script & runUntil( uint64_t address );
+                Script & outputContains( const std::string & text );
+                Script & interrupt( uint32_t number );
+                Script & sendKeys( const std::string & keys );
+                Script & readMemory( uint64_t address, size_t size, const std::function< void( const std::vector< uint8_t > & ) > & f );
+                Script & then( const std::function< void( Machine & ) > & f );
+                Script & add( std::unique_ptr< Step > step );
+                Script & limit( uint64_t instructions );
+                
+                uint64_t limit( void )           const;
+                size_t   numberOfSteps( void )   const;
+                Step   & step( size_t index )    const;
+                
+                friend void swap( Script & o1, Script & o2 );
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_AUTOMATION_SCRIPT_HPP */
@@ -23,13 +23,16 @@
  ******************************************************************************/
 
 #include "UB/BIOS/Disk.hpp"
+#include "UB/BIOS/DiskAccess.hpp"
 #include "UB/Machine.hpp"
 #include "UB/Engine.hpp"
 #include "UB/String.hpp"
 #include "UB/Casts.hpp"
+#include "UB/Timeline.hpp"
 #include "UB/FAT/Functions.hpp"
 #include "UB/FAT/DAP.hpp"
 #include "UB/BinaryDataStream.hpp"
+#include <chrono>
 
 namespace UB
 {
@@ -37,6 +40,9 @@ namespace UB
     {
         namespace Disk
         {
+            static uint64_t now( void );
+            static void     finish( const Machine & machine, DiskAccess & access, bool success );
+            
             bool reset( const Machine & machine, Engine & engine )
             {
                 machine.ui().debug() << "Resetting drive " << String::toHex( engine.dl() ) << std::endl;
@@ -56,6 +62,17 @@ namespace UB
                 uint8_t    head(        engine.dh() );
                 uint64_t   destination( Engine::getAddress( engine.es(), engine.bx() ) );
                 FAT::Image image(       machine.bootImage() );
+                DiskAccess access;
+                
+                access.type( DiskAccess::Type::CHS );
+                access.drive( driveNumber );
+                access.cylinder( cylinder );
+                access.head( head );
+                access.sector( sector );
+                access.sectors( sectors );
+                access.destination( destination );
+                access.time( now() );
+                access.instructions( engine.instructions() );
                 
                 if( driveNumber != 0x00 )
                 {
@@ -87,6 +104,9 @@ namespace UB
                         goto error;
                     }
                     
+                    access.lba( FAT::chsToLBA( image.mbr(), cylinder, sector, head ) );
+                    access.bytesPerSector( image.mbr().bytesPerSector() );
+                    
                     engine.write( destination, bytes );
                     
                     machine.ui().debug() << "[ SUCCESS ]> Wrote "
@@ -101,6 +121,8 @@ namespace UB
                     engine.ah( 0 );
                     engine.al( sectors );
                     
+                    finish( machine, access, true );
+                    
                     return true;
                 }
                 
@@ -110,6 +132,8 @@ namespace UB
                     engine.ah( 1 );
                     engine.al( 0 );
                     
+                    finish( machine, access, false );
+                    
                     return true;
             }
             
@@ -117,9 +141,10 @@ namespace UB
             {
                 machine.ui().debug() << "Checking if INT13h extensions are supported" << std::endl;
                 
+                /* EDD 3.0, for 64-bit flat DAP buffers */
                 engine.bx( 0xAA55 );
                 engine.cf( false );
-                engine.ah( 0 );
+                engine.ah( 0x30 );
                 engine.cx( 7 );
                 
                 return true;
@@ -131,13 +156,25 @@ namespace UB
                 uint64_t         dapAddress      = Engine::getAddress( engine.ds(), engine.si() );
                 FAT::Image       image           = machine.bootImage();
                 FAT::MBR         mbr             = image.mbr();
-                BinaryDataStream dapData         = engine.read( dapAddress, FAT::DAP::DataSize() );
+                uint8_t          dapSize         = engine.read( dapAddress, 1 )[ 0 ];
+                BinaryDataStream dapData         = engine.read( dapAddress, std::min( std::max< size_t >( dapSize, FAT::DAP::DataSize() ), FAT::DAP::MaxDataSize() ) );
                 FAT::DAP         dap             = dapData;
-                uint64_t         destination     = Engine::getAddress( dap.destinationSegment(), dap.destinationOffset() );
-                uint64_t         numberOfSectors = numeric_cast< uint64_t >( dap.numberOfSectors() );
+                uint64_t         destination     = dap.destination();
+                uint64_t         lba             = dap.logicalBlockAddress();
+                uint64_t         numberOfSectors = dap.sectors();
                 uint64_t         bytesPerSector  = ( mbr.isValid() ) ? mbr.bytesPerSector() : 512;
-                uint64_t         offset          = dap.logicalBlockAddress() * bytesPerSector;
-                uint64_t         size            = numberOfSectors * bytesPerSector;
+                uint64_t         offset          = 0;
+                uint64_t         size            = 0;
+                DiskAccess       access;
+                
+                access.type( DiskAccess::Type::DAP );
+                access.drive( driveNumber );
+                access.lba( lba );
+                access.sectors( numberOfSectors );
+                access.bytesPerSector( bytesPerSector );
+                access.destination( destination );
+                access.time( now() );
+                access.instructions( engine.instructions() );
                 
                 if( driveNumber != 0x00 )
                 {
@@ -146,6 +183,21 @@ namespace UB
                     goto error;
                 }
                 
+                /*
+                 * The guest controls the LBA and the sector count: both are
+                 * checked against the image before multiplying, so the offset
+                 * and size can't wrap around.
+                 */
+                if( numberOfSectors == 0 || bytesPerSector == 0 || lba > image.size() / bytesPerSector || numberOfSectors > ( image.size() - lba * bytesPerSector ) / bytesPerSector )
+                {
+                    machine.ui().debug() << "[ ERROR ]> Invalid read - Not enough data available" << std::endl;
+                    
+                    goto error;
+                }
+                
+                offset = lba * bytesPerSector;
+                size   = numberOfSectors * bytesPerSector;
+                
                 machine.ui().debug() << "Reading DAP at " << String::toHex( dapAddress ) << " from drive " << String::toHex( driveNumber )
                                      << std::endl
                                      << "    - DAP Address: " << String::toHex( dapAddress )  << " (" << String::toHex( engine.ds() ) << ":" << String::toHex( engine.si() ) << ")"
@@ -160,28 +212,30 @@ namespace UB
                                      << std::endl;
                 
                 {
-                    std::vector< uint8_t > bytes( image.read( offset, size ) );
-                    
-                    if( bytes.size() == 0 )
-                    {
-                        machine.ui().debug() << "[ ERROR ]> No data received" << std::endl;
-                        
-                        goto error;
-                    }
-                    
-                    engine.write( destination, bytes );
+                    /* Large transfers go straight from the image into guest memory, in one read */
+                    engine.fill
+                    (
+                        destination,
+                        size,
+                        [ & ]( uint8_t * buf )
+                        {
+                            image.read( offset, buf, size );
+                        }
+                    );
                     
                     machine.ui().debug() << "[ SUCCESS ]> Wrote "
-                                         << bytes.size()
+                                         << size
                                          << " bytes at "
                                          << String::toHex( destination )
                                          << " -> "
-                                         << String::toHex( destination + bytes.size() )
+                                         << String::toHex( destination + size )
                                          << std::endl;
                     
                     engine.cf( false );
                     engine.ah( 0 );
                     
+                    finish( machine, access, true );
+                    
                     return true;
                 }
                 
@@ -190,8 +244,35 @@ namespace UB
                     engine.cf( true );
                     engine.ah( 1 );
                     
+                    finish( machine, access, false );
+                    
                     return true;
             }
+            
+            static uint64_t now( void )
+            {
+                return static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+            }
+            
+            static void finish( const Machine & machine, DiskAccess & access, bool success )
+            {
+                access.success( success );
+                access.latency( now() - access.time() );
+                
+                if( Timeline::shared().enabled() )
+                {
+                    Timeline::shared().complete
+                    (
+                        "Disk",
+                        ( access.type() == DiskAccess::Type::DAP ) ? "Extended read" : "Read",
+                        access.time(),
+                        access.instructions(),
+                        "LBA " + std::to_string( access.lba() ) + ", " + std::to_string( access.sectors() ) + " sectors" + ( ( success ) ? "" : " (failed)" )
+                    );
+                }
+                
+                machine.didReadDisk( access );
+            }
         }
     }
 }
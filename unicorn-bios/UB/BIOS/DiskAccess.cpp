@@ -0,0 +1,258 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/BIOS/DiskAccess.hpp"
+
+namespace UB
+{
+    namespace BIOS
+    {
+        class DiskAccess::IMPL
+        {
+            public:
+                
+                IMPL( void );
+                IMPL( const IMPL & o );
+                ~IMPL( void );
+                
+                Type     _type;
+                uint8_t  _drive;
+                uint8_t  _cylinder;
+                uint8_t  _head;
+                uint8_t  _sector;
+                uint64_t _lba;
+                uint64_t _sectors;
+                uint64_t _bytesPerSector;
+                uint64_t _destination;
+                bool     _success;
+                uint64_t _time;
+                uint64_t _latency;
+                uint64_t _instructions;
+        };
+        
+        DiskAccess::DiskAccess( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        DiskAccess::DiskAccess( const DiskAccess & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        DiskAccess::DiskAccess( DiskAccess && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        DiskAccess::~DiskAccess( void )
+        {}
+        
+        DiskAccess & DiskAccess::operator =( DiskAccess o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        DiskAccess::Type DiskAccess::type( void ) const
+        {
+            return this->impl->_type;
+        }
+        
+        uint8_t DiskAccess::drive( void ) const
+        {
+            return this->impl->_drive;
+        }
+        
+        uint8_t DiskAccess::cylinder( void ) const
+        {
+            return this->impl->_cylinder;
+        }
+        
+        uint8_t DiskAccess::head( void ) const
+        {
+            return this->impl->_head;
+        }
+        
+        uint8_t DiskAccess::sector( void ) const
+        {
+            return this->impl->_sector;
+        }
+        
+        uint64_t DiskAccess::lba( void ) const
+        {
+            return this->impl->_lba;
+        }
+        
+        uint64_t DiskAccess::sectors( void ) const
+        {
+            return this->impl->_sectors;
+        }
+        
+        uint64_t DiskAccess::bytesPerSector( void ) const
+        {
+            return this->impl->_bytesPerSector;
+        }
+        
+        uint64_t DiskAccess::destination( void ) const
+        {
+            return this->impl->_destination;
+        }
+        
+        bool DiskAccess::success( void ) const
+        {
+            return this->impl->_success;
+        }
+        
+        uint64_t DiskAccess::time( void ) const
+        {
+            return this->impl->_time;
+        }
+        
+        uint64_t DiskAccess::latency( void ) const
+        {
+            return this->impl->_latency;
+        }
+        
+        uint64_t DiskAccess::instructions( void ) const
+        {
+            return this->impl->_instructions;
+        }
+        
+        uint64_t DiskAccess::offset( void ) const
+        {
+            return this->impl->_lba * this->impl->_bytesPerSector;
+        }
+        
+        uint64_t DiskAccess::size( void ) const
+        {
+            return this->impl->_sectors * this->impl->_bytesPerSector;
+        }
+        
+        void DiskAccess::type( Type value )
+        {
+            this->impl->_type = value;
+        }
+        
+        void DiskAccess::drive( uint8_t value )
+        {
+            this->impl->_drive = value;
+        }
+        
+        void DiskAccess::cylinder( uint8_t value )
+        {
+            this->impl->_cylinder = value;
+        }
+        
+        void DiskAccess::head( uint8_t value )
+        {
+            this->impl->_head = value;
+        }
+        
+        void DiskAccess::sector( uint8_t value )
+        {
+            this->impl->_sector = value;
+        }
+        
+        void DiskAccess::lba( uint64_t value )
+        {
+            this->impl->_lba = value;
+        }
+        
+        void DiskAccess::sectors( uint64_t value )
+        {
+            this->impl->_sectors = value;
+        }
+        
+        void DiskAccess::bytesPerSector( uint64_t value )
+        {
+            this->impl->_bytesPerSector = value;
+        }
+        
+        void DiskAccess::destination( uint64_t value )
+        {
+            this->impl->_destination = value;
+        }
+        
+        void DiskAccess::success( bool value )
+        {
+            this->impl->_success = value;
+        }
+        
+        void DiskAccess::time( uint64_t value )
+        {
+            this->impl->_time = value;
+        }
+        
+        void DiskAccess::latency( uint64_t value )
+        {
+            this->impl->_latency = value;
+        }
+        
+        void DiskAccess::instructions( uint64_t value )
+        {
+            this->impl->_instructions = value;
+        }
+        
+        void swap( DiskAccess & o1, DiskAccess & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        DiskAccess::IMPL::IMPL( void ):
+            _type(           Type::CHS ),
+            _drive(          0 ),
+            _cylinder(       0 ),
+            _head(           0 ),
+            _sector(         0 ),
+            _lba(            0 ),
+            _sectors(        0 ),
+            _bytesPerSector( 512 ),
+            _destination(    0 ),
+            _success(        false ),
+            _time(           0 ),
+            _latency(        0 ),
+            _instructions(   0 )
+        {}
+        
+        DiskAccess::IMPL::IMPL( const IMPL & o ):
+            _type(           o._type ),
+            _drive(          o._drive ),
+            _cylinder(       o._cylinder ),
+            _head(           o._head ),
+            _sector(         o._sector ),
+            _lba(            o._lba ),
+            _sectors(        o._sectors ),
+            _bytesPerSector( o._bytesPerSector ),
+            _destination(    o._destination ),
+            _success(        o._success ),
+            _time(           o._time ),
+            _latency(        o._latency ),
+            _instructions(   o._instructions )
+        {}
+        
+        DiskAccess::IMPL::~IMPL( void )
+        {}
+    }
+}
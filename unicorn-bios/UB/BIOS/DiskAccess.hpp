@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_BIOS_DISK_ACCESS_HPP
+#define UB_BIOS_DISK_ACCESS_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+namespace UB
+{
+    namespace BIOS
+    {
+        class DiskAccess
+        {
+            public:
+                
+                enum class Type: uint8_t
+                {
+                    CHS = 0x00,
+                    DAP = 0x01
+                };
+                
+                DiskAccess( void );
+                DiskAccess( const DiskAccess & o );
+                DiskAccess( DiskAccess && o ) noexcept;
+                ~DiskAccess( void );
+                
+                DiskAccess & operator =( DiskAccess o );
+                
+                Type     type( void )           const;
+                uint8_t  drive( void )          const;
+                uint8_t  cylinder( void )       const;
+                uint8_t  head( void )           const;
+                uint8_t  sector( void )         const;
+                uint64_t lba( void )            const;
+                uint64_t sectors( void )        const;
+                uint64_t bytesPerSector( void ) const;
+                uint64_t destination( void )    const;
+                bool     success( void )        const;
+                uint64_t time( void )           const;
+                uint64_t latency( void )        const;
+                uint64_t instructions( void )   const;
+                uint64_t offset( void )         const;
+                uint64_t size( void )           const;
+                
+                void type(           Type value );
+                void drive(          uint8_t value );
+                void cylinder(       uint8_t value );
+                void head(           uint8_t value );
+                void sector(         uint8_t value );
+                void lba(            uint64_t value );
+                void sectors(        uint64_t value );
+                void bytesPerSector( uint64_t value );
+                void destination(    uint64_t value );
+                void success(        bool value );
+                void time(           uint64_t value );
+                void latency(        uint64_t value );
+                void instructions(   uint64_t value );
+                
+                friend void swap( DiskAccess & o1, DiskAccess & o2 );
+            
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_BIOS_DISK_ACCESS_HPP */
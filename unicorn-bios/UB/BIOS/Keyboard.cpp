@@ -34,8 +34,41 @@ namespace UB
         {
             bool readKey( const Machine & machine, Engine & engine )
             {
-                ( void )machine;
-                ( void )engine;
+                std::optional< uint8_t > key( machine.readKey() );
+                
+                /*
+                 * A real BIOS blocks until a key is pressed. When the machine
+                 * can wait for keys (a script drives it), rewind to the INT 16h
+                 * instruction so it runs again once the machine is resumed.
+                 * Otherwise, no key ever comes, and AL=0 lets the guest go on.
+                 */
+                if( key.has_value() == false && machine.yield() )
+                {
+                    engine.ip( static_cast< uint16_t >( engine.ip() - 2 ) );
+                    
+                    return true;
+                }
+                
+                engine.ah( 0 );
+                engine.al( key.value_or( 0 ) );
+                
+                return true;
+            }
+            
+            bool checkKey( const Machine & machine, Engine & engine )
+            {
+                std::optional< uint8_t > key( machine.peekKey() );
+                
+                if( key.has_value() )
+                {
+                    engine.ah( 0 );
+                    engine.al( key.value() );
+                    engine.zf( false );
+                }
+                else
+                {
+                    engine.zf( true );
+                }
                 
                 return true;
             }
@@ -35,6 +35,7 @@ namespace UB
         namespace Keyboard
         {
             bool readKey( const Machine & machine, Engine & engine );
+            bool checkKey( const Machine & machine, Engine & engine );
         }
     }
 }
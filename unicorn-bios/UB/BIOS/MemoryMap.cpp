@@ -23,6 +23,10 @@
  ******************************************************************************/
 
 #include "UB/BIOS/MemoryMap.hpp"
+#include "UB/String.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
 
 namespace UB
 {
@@ -33,15 +37,56 @@ namespace UB
             public:
                 
                 IMPL( size_t memory );
+                IMPL( const std::vector< Entry > & entries );
                 IMPL( const IMPL & o );
                 ~IMPL( void );
                 
+                static std::string _trim( const std::string & s );
+                static uint64_t    _parseNumber( const std::string & s );
+                static Entry       _parseEntry( const std::string & s );
+                
                 std::vector< Entry > _entries;
         };
 
+        MemoryMap MemoryMap::fromLayout( const std::string & layout )
+        {
+            std::ifstream        stream( layout );
+            std::string          text( layout );
+            std::vector< Entry > entries;
+            
+            if( stream.good() )
+            {
+                std::stringstream ss;
+                
+                ss << stream.rdbuf();
+                
+                text = ss.str();
+            }
+            
+            for( auto line: String::lines( text ) )
+            {
+                std::stringstream ss( line.substr( 0, line.find( '#' ) ) );
+                std::string       entry;
+                
+                while( std::getline( ss, entry, ',' ) )
+                {
+                    if( IMPL::_trim( entry ).length() > 0 )
+                    {
+                        entries.push_back( IMPL::_parseEntry( IMPL::_trim( entry ) ) );
+                    }
+                }
+            }
+            
+            return MemoryMap( entries );
+        }
+        
         MemoryMap::MemoryMap( size_t memory ):
             impl( std::make_unique< IMPL >( memory ) )
         {}
+        
+        MemoryMap::MemoryMap( const std::vector< Entry > & entries ):
+            impl( std::make_unique< IMPL >( entries ) )
+        {}
 
         MemoryMap::MemoryMap( const MemoryMap & o ):
             impl( std::make_unique< IMPL >( *( o.impl ) ) )
@@ -66,6 +111,46 @@ namespace UB
             return this->impl->_entries;
         }
         
+        std::vector< std::pair< uint64_t, uint64_t > > MemoryMap::regions( void ) const
+        {
+            std::vector< std::pair< uint64_t, uint64_t > > ranges;
+            std::vector< std::pair< uint64_t, uint64_t > > regions;
+            
+            /* The legacy area below 1MB stays mapped even where no entry covers it */
+            ranges.push_back( { 0, 0x00100000 } );
+            
+            /*
+             * Only RAM the guest may use is backed. Reserved ranges above 1MB
+             * (APICs, firmware holes) stay unmapped; devices claiming them
+             * get their own mapping through Engine::onDeviceAccess.
+             */
+            for( const auto & entry: this->impl->_entries )
+            {
+                if( entry.type() != Entry::Type::Usable && entry.type() != Entry::Type::ACPI )
+                {
+                    continue;
+                }
+                
+                ranges.push_back( { entry.base() & ~0xFFFULL, ( entry.base() + entry.length() + 0xFFF ) & ~0xFFFULL } );
+            }
+            
+            std::sort( ranges.begin(), ranges.end() );
+            
+            for( const auto & range: ranges )
+            {
+                if( regions.size() > 0 && range.first <= regions.back().first + regions.back().second )
+                {
+                    regions.back().second = std::max( regions.back().second, range.second - regions.back().first );
+                }
+                else
+                {
+                    regions.push_back( { range.first, range.second - range.first } );
+                }
+            }
+            
+            return regions;
+        }
+        
         void swap( MemoryMap & o1, MemoryMap & o2 )
         {
             using std::swap;
@@ -75,6 +160,7 @@ namespace UB
 
         MemoryMap::IMPL::IMPL( size_t memory )
         {
+            uint64_t low;
             uint64_t free;
             uint64_t after;
             
@@ -83,8 +169,10 @@ namespace UB
                 throw std::runtime_error( "Memory must be at least 2MB" );
             }
             
-            free  = memory - 0x00100000 - 0x00010000;
-            after = memory - 0x00010000;
+            /* Memory past 3GB is relocated above 4GB, leaving a hole for PCI devices */
+            low   = std::min< uint64_t >( memory, 0xC0000000 );
+            free  = low - 0x00100000 - 0x00010000;
+            after = low - 0x00010000;
             
             this->_entries.push_back( { 0x00000000, 0x0009FC00, Entry::Type::Usable } );
             this->_entries.push_back( { 0x0009FC00, 0x00000400, Entry::Type::Reserved } );
@@ -93,6 +181,43 @@ namespace UB
             this->_entries.push_back( { after,      0x00010000, Entry::Type::ACPI } );
             this->_entries.push_back( { 0xFEC00000, 0x00001000, Entry::Type::Reserved } );
             this->_entries.push_back( { 0xFEE00000, 0x00001000, Entry::Type::Reserved } );
+            
+            if( memory > low )
+            {
+                this->_entries.push_back( { 0x100000000, memory - low, Entry::Type::Usable } );
+            }
+        }
+        
+        MemoryMap::IMPL::IMPL( const std::vector< Entry > & entries ):
+            _entries( entries )
+        {
+            if( this->_entries.size() == 0 )
+            {
+                throw std::runtime_error( "Memory map must contain at least one entry" );
+            }
+            
+            std::sort
+            (
+                this->_entries.begin(),
+                this->_entries.end(),
+                []( const Entry & e1, const Entry & e2 )
+                {
+                    return e1.base() < e2.base();
+                }
+            );
+            
+            for( size_t i = 0; i < this->_entries.size(); i++ )
+            {
+                if( this->_entries[ i ].length() == 0 )
+                {
+                    throw std::runtime_error( "Memory map entry at " + String::toHex( this->_entries[ i ].base() ) + " is empty" );
+                }
+                
+                if( i > 0 && this->_entries[ i ].base() <= this->_entries[ i - 1 ].end() )
+                {
+                    throw std::runtime_error( "Memory map entry at " + String::toHex( this->_entries[ i ].base() ) + " overlaps the previous entry" );
+                }
+            }
         }
 
         MemoryMap::IMPL::IMPL( const IMPL & o ):
@@ -101,5 +226,88 @@ namespace UB
 
         MemoryMap::IMPL::~IMPL( void )
         {}
+        
+        std::string MemoryMap::IMPL::_trim( const std::string & s )
+        {
+            size_t start( s.find_first_not_of( " \t\r" ) );
+            size_t end(   s.find_last_not_of(  " \t\r" ) );
+            
+            if( start == std::string::npos )
+            {
+                return "";
+            }
+            
+            return s.substr( start, ( end - start ) + 1 );
+        }
+        
+        uint64_t MemoryMap::IMPL::_parseNumber( const std::string & s )
+        {
+            std::string n( String::toLower( _trim( s ) ) );
+            uint64_t    multiplier( 1 );
+            uint64_t    v;
+            char      * end;
+            
+            if( n.length() > 0 )
+            {
+                switch( n.back() )
+                {
+                    case 'k': multiplier = 1ULL << 10; break;
+                    case 'm': multiplier = 1ULL << 20; break;
+                    case 'g': multiplier = 1ULL << 30; break;
+                    case 't': multiplier = 1ULL << 40; break;
+                    
+                    default: break;
+                }
+            }
+            
+            if( multiplier > 1 )
+            {
+                n = n.substr( 0, n.length() - 1 );
+            }
+            
+            v = std::strtoull( n.c_str(), &end, 0 );
+            
+            if( n.length() == 0 || *( end ) != 0 )
+            {
+                throw std::runtime_error( "Invalid number in memory map: " + s );
+            }
+            
+            return v * multiplier;
+        }
+        
+        MemoryMap::Entry MemoryMap::IMPL::_parseEntry( const std::string & s )
+        {
+            std::stringstream          ss( s );
+            std::vector< std::string > parts;
+            std::string                part;
+            std::string                type;
+            
+            while( std::getline( ss, part, ':' ) )
+            {
+                parts.push_back( part );
+            }
+            
+            if( parts.size() != 3 )
+            {
+                throw std::runtime_error( "Invalid memory map entry: " + s + " - Expected BASE:LENGTH:TYPE" );
+            }
+            
+            type = String::toLower( _trim( parts[ 2 ] ) );
+            
+            if( type == "usable" )
+            {
+                return { _parseNumber( parts[ 0 ] ), _parseNumber( parts[ 1 ] ), Entry::Type::Usable };
+            }
+            else if( type == "reserved" )
+            {
+                return { _parseNumber( parts[ 0 ] ), _parseNumber( parts[ 1 ] ), Entry::Type::Reserved };
+            }
+            else if( type == "acpi" )
+            {
+                return { _parseNumber( parts[ 0 ] ), _parseNumber( parts[ 1 ] ), Entry::Type::ACPI };
+            }
+            
+            throw std::runtime_error( "Invalid memory map entry type: " + parts[ 2 ] );
+        }
     }
 }
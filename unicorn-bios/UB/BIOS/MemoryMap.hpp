@@ -30,6 +30,8 @@
 #include <cstdint>
 #include <vector>
 #include <array>
+#include <string>
+#include <utility>
 
 namespace UB
 {
@@ -76,14 +78,18 @@ namespace UB
                         std::unique_ptr< IMPL > impl;
                 };
                 
+                static MemoryMap fromLayout( const std::string & layout );
+                
                 MemoryMap( size_t memory );
+                MemoryMap( const std::vector< Entry > & entries );
                 MemoryMap( const MemoryMap & o );
                 MemoryMap( MemoryMap && o ) noexcept;
                 ~MemoryMap( void );
                 
                 MemoryMap & operator =( MemoryMap o );
                 
-                std::vector< Entry > entries( void ) const;
+                std::vector< Entry >                           entries( void ) const;
+                std::vector< std::pair< uint64_t, uint64_t > > regions( void ) const;
                 
                 friend void swap( MemoryMap & o1, MemoryMap & o2 );
                 
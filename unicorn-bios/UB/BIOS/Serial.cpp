@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/BIOS/Serial.hpp"
+#include "UB/Machine.hpp"
+#include "UB/Engine.hpp"
+#include "UB/String.hpp"
+
+namespace UB
+{
+    namespace BIOS
+    {
+        namespace Serial
+        {
+            bool initialize( const Machine & machine, Engine & engine )
+            {
+                machine.ui().debug() << "Initializing serial port " << String::toHex( engine.dx() ) << std::endl;
+                
+                engine.ah( 0x60 );
+                engine.al( 0x00 );
+                
+                return true;
+            }
+            
+            bool transmit( const Machine & machine, Engine & engine )
+            {
+                machine.didOutput( Machine::Output::Serial, engine.al() );
+                
+                engine.ah( 0x60 );
+                
+                return true;
+            }
+            
+            bool receive( const Machine & machine, Engine & engine )
+            {
+                ( void )machine;
+                
+                engine.ah( 0x80 );
+                
+                return true;
+            }
+            
+            bool status( const Machine & machine, Engine & engine )
+            {
+                ( void )machine;
+                
+                engine.ah( 0x60 );
+                engine.al( 0x00 );
+                
+                return true;
+            }
+        }
+    }
+}
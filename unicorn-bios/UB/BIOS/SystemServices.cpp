@@ -142,6 +142,11 @@ namespace UB
                     return false;
             }
 
+            /*
+             * INT 15h EC00h only tells the BIOS which mode the OS will run
+             * in: it switches nothing. The guest then sets CR0, EFER and its
+             * GDT itself, and the engine derives the mode from those.
+             */
             bool enterLongMode( const Machine & machine, Engine & engine )
             {
                 uint8_t mode( engine.bl() );
@@ -161,11 +166,12 @@ namespace UB
                     break;
 
                     default:
-                        machine.ui().debug() << "BIOS::SystemsServices::enterLongMode: Unknown mode " << mode << std::endl;
+                        machine.ui().debug() << "BIOS::SystemsServices::enterLongMode: Unknown mode " << String::toHex( mode ) << std::endl;
                         goto error;
                 }
 
                 engine.cf( false );
+                engine.ah( 0 );
                 return true;
 
                 error:
@@ -27,7 +27,6 @@
 #include "UB/Machine.hpp"
 #include "UB/Engine.hpp"
 #include "UB/String.hpp"
-#include <cctype>
 
 namespace UB
 {
@@ -75,6 +74,8 @@ namespace UB
                     machine.ui().debug() << "    - " << description << std::endl;
                 }
                 
+                machine.didSetVideoMode( maskedMode );
+                
                 if( maskedMode > 7 )
                 {
                     engine.al( 0x20 );
@@ -110,21 +111,12 @@ namespace UB
             
             bool ttyOutput( const Machine & machine, Engine & engine )
             {
-                char c( static_cast< char >( engine.al() ) );
-                
                 if( machine.debugVideo() )
                 {
                     machine.ui().debug() << "TTY output: " << String::toHex( engine.al() ) << std::endl;
                 }
                 
-                if( std::isprint( c ) || std::isspace( c ) )
-                {
-                    machine.ui().output() << std::string( 1, c );
-                }
-                else
-                {
-                    machine.ui().output() << ".";
-                }
+                machine.didOutput( Machine::Output::TTY, engine.al() );
                 
                 return true;
             }
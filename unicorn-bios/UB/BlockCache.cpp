@@ -0,0 +1,275 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/BlockCache.hpp"
+#include "UB/Capstone.hpp"
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+namespace UB
+{
+    class BlockCache::Block::IMPL
+    {
+        public:
+            
+            IMPL( size_t id, Engine::Mode mode, unsigned int bits, uint64_t address, size_t size, const std::vector< uint8_t > & code );
+            ~IMPL( void );
+            
+            size_t                                                              _id;
+            Engine::Mode                                                        _mode;
+            unsigned int                                                        _bits;
+            uint64_t                                                            _address;
+            size_t                                                              _size;
+            Exit                                                                _exit;
+            std::vector< std::pair< std::string, std::vector< std::string > > > _instructions;
+    };
+    
+    class BlockCache::IMPL
+    {
+        public:
+            
+            class Entry
+            {
+                public:
+                    
+                    size_t       _size;
+                    Engine::Mode _mode;
+                    unsigned int _bits;
+                    size_t       _id;
+            };
+            
+            IMPL( const std::function< std::vector< uint8_t >( uint64_t, size_t ) > & reader );
+            ~IMPL( void );
+            
+            void _drain( void );
+            
+            std::function< std::vector< uint8_t >( uint64_t, size_t ) > _reader;
+            std::unordered_map< uint64_t, std::vector< Entry > >         _live;
+            std::unordered_map< uint64_t, std::vector< size_t > >        _pages;
+            std::vector< std::shared_ptr< Block > >                      _blocks;
+            std::deque< std::atomic< uint64_t > >                        _executions;
+            std::vector< uint64_t >                                      _invalid;
+            std::atomic< bool >                                          _pending;
+            mutable std::mutex                                           _mtx;
+    };
+    
+    BlockCache::BlockCache( const std::function< std::vector< uint8_t >( uint64_t, size_t ) > & reader ):
+        impl( std::make_unique< IMPL >( reader ) )
+    {}
+    
+    BlockCache::~BlockCache( void )
+    {}
+    
+    const BlockCache::Block & BlockCache::block( Engine::Mode mode, unsigned int bits, uint64_t address, size_t size )
+    {
+        std::shared_ptr< Block > block;
+        
+        if( this->impl->_pending.load( std::memory_order_acquire ) )
+        {
+            this->impl->_drain();
+        }
+        
+        {
+            auto it( this->impl->_live.find( address ) );
+            
+            if( it != this->impl->_live.end() )
+            {
+                for( const auto & entry: it->second )
+                {
+                    if( entry._size == size && entry._mode == mode && entry._bits == bits )
+                    {
+                        /* Only this thread counts, so a plain load and store is enough */
+                        std::atomic< uint64_t > & executions( this->impl->_executions[ entry._id ] );
+                        
+                        executions.store( executions.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+                        
+                        return *( this->impl->_blocks[ entry._id ] );
+                    }
+                }
+            }
+        }
+        
+        block = std::make_shared< Block >( this->impl->_blocks.size(), mode, bits, address, size, this->impl->_reader( address, size ) );
+        
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            this->impl->_blocks.push_back( block );
+            this->impl->_executions.emplace_back( 1 );
+        }
+        
+        this->impl->_live[ address ].push_back( { size, mode, bits, block->id() } );
+        
+        for( uint64_t page = address & ~0xFFFULL; page <= ( ( address + std::max< size_t >( size, 1 ) - 1 ) & ~0xFFFULL ); page += 0x1000 )
+        {
+            this->impl->_pages[ page ].push_back( block->id() );
+        }
+        
+        return *( block );
+    }
+    
+    void BlockCache::invalidate( uint64_t page )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_invalid.push_back( page & ~0xFFFULL );
+        this->impl->_pending.store( true, std::memory_order_release );
+    }
+    
+    std::vector< std::pair< std::shared_ptr< const BlockCache::Block >, uint64_t > > BlockCache::blocks( void ) const
+    {
+        std::lock_guard< std::mutex >                                        l( this->impl->_mtx );
+        std::vector< std::pair< std::shared_ptr< const Block >, uint64_t > > blocks;
+        
+        blocks.reserve( this->impl->_blocks.size() );
+        
+        for( size_t i = 0; i < this->impl->_blocks.size(); i++ )
+        {
+            blocks.push_back( { this->impl->_blocks[ i ], this->impl->_executions[ i ].load( std::memory_order_relaxed ) } );
+        }
+        
+        return blocks;
+    }
+    
+    BlockCache::Block::Block( size_t id, Engine::Mode mode, unsigned int bits, uint64_t address, size_t size, const std::vector< uint8_t > & code ):
+        impl( std::make_unique< IMPL >( id, mode, bits, address, size, code ) )
+    {}
+    
+    BlockCache::Block::~Block( void )
+    {}
+    
+    size_t BlockCache::Block::id( void ) const
+    {
+        return this->impl->_id;
+    }
+    
+    Engine::Mode BlockCache::Block::mode( void ) const
+    {
+        return this->impl->_mode;
+    }
+    
+    unsigned int BlockCache::Block::bits( void ) const
+    {
+        return this->impl->_bits;
+    }
+    
+    uint64_t BlockCache::Block::address( void ) const
+    {
+        return this->impl->_address;
+    }
+    
+    size_t BlockCache::Block::size( void ) const
+    {
+        return this->impl->_size;
+    }
+    
+    BlockCache::Exit BlockCache::Block::exit( void ) const
+    {
+        return this->impl->_exit;
+    }
+    
+    const std::vector< std::pair< std::string, std::vector< std::string > > > & BlockCache::Block::instructions( void ) const
+    {
+        return this->impl->_instructions;
+    }
+    
+    BlockCache::Block::IMPL::IMPL( size_t id, Engine::Mode mode, unsigned int bits, uint64_t address, size_t size, const std::vector< uint8_t > & code ):
+        _id(           id ),
+        _mode(         mode ),
+        _bits(         bits ),
+        _address(      address ),
+        _size(         size ),
+        _exit(         Exit::None ),
+        _instructions( Capstone::groups( code, address, bits ) )
+    {
+        if( this->_instructions.size() > 0 )
+        {
+            const std::vector< std::string > & groups( this->_instructions.back().second );
+            
+            if( std::find( groups.begin(), groups.end(), "call" ) != groups.end() )
+            {
+                this->_exit = Exit::Call;
+            }
+            else if( std::find( groups.begin(), groups.end(), "ret" ) != groups.end() )
+            {
+                this->_exit = Exit::Return;
+            }
+        }
+    }
+    
+    BlockCache::Block::IMPL::~IMPL( void )
+    {}
+    
+    BlockCache::IMPL::IMPL( const std::function< std::vector< uint8_t >( uint64_t, size_t ) > & reader ):
+        _reader(  reader ),
+        _pending( false )
+    {}
+    
+    BlockCache::IMPL::~IMPL( void )
+    {}
+    
+    void BlockCache::IMPL::_drain( void )
+    {
+        std::vector< uint64_t > pages;
+        
+        {
+            std::lock_guard< std::mutex > l( this->_mtx );
+            
+            std::swap( pages, this->_invalid );
+            this->_pending.store( false, std::memory_order_relaxed );
+        }
+        
+        for( uint64_t page: pages )
+        {
+            auto it( this->_pages.find( page ) );
+            
+            if( it == this->_pages.end() )
+            {
+                continue;
+            }
+            
+            /* Blocks spanning two pages stay listed under the other one, where erasing them again is a no-op */
+            for( size_t id: it->second )
+            {
+                auto live( this->_live.find( this->_blocks[ id ]->address() ) );
+                
+                if( live == this->_live.end() )
+                {
+                    continue;
+                }
+                
+                live->second.erase( std::remove_if( live->second.begin(), live->second.end(), [ & ]( const Entry & entry ) { return entry._id == id; } ), live->second.end() );
+                
+                if( live->second.size() == 0 )
+                {
+                    this->_live.erase( live );
+                }
+            }
+            
+            this->_pages.erase( it );
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_BLOCK_CACHE_HPP
+#define UB_BLOCK_CACHE_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include "UB/Engine.hpp"
+
+namespace UB
+{
+    /*!
+     * Decode-once cache of executed basic blocks, shared by the block
+     * consumers (instruction mix, timing model and cache simulator).
+     * 
+     * block() is called from the block hook on the emulation thread. It
+     * finds the block by address, size, mode and code size (16, 32 or 64
+     * bits, from the CS descriptor) and counts one execution;
+     * guest memory is only read and decoded the first time a block runs,
+     * or after invalidate() reported a write to one of its pages.
+     * invalidate() may be called from any thread. Invalidated blocks keep
+     * their execution counts for the reports.
+     */
+    class BlockCache
+    {
+        public:
+            
+            enum class Exit
+            {
+                None,
+                Call,
+                Return
+            };
+            
+            class Block
+            {
+                public:
+                    
+                    Block( size_t id, Engine::Mode mode, unsigned int bits, uint64_t address, size_t size, const std::vector< uint8_t > & code );
+                    ~Block( void );
+                    
+                    Block( const Block & o )              = delete;
+                    Block( Block && o )                   = delete;
+                    Block & operator =( const Block & o ) = delete;
+                    Block & operator =( Block && o )      = delete;
+                    
+                    size_t       id( void )      const;
+                    Engine::Mode mode( void )    const;
+                    unsigned int bits( void )    const;
+                    uint64_t     address( void ) const;
+                    size_t       size( void )    const;
+                    Exit         exit( void )    const;
+                    
+                    const std::vector< std::pair< std::string, std::vector< std::string > > > & instructions( void ) const;
+                
+                private:
+                    
+                    class IMPL;
+                    std::unique_ptr< IMPL > impl;
+            };
+            
+            BlockCache( const std::function< std::vector< uint8_t >( uint64_t, size_t ) > & reader );
+            ~BlockCache( void );
+            
+            BlockCache( const BlockCache & o )              = delete;
+            BlockCache( BlockCache && o )                   = delete;
+            BlockCache & operator =( const BlockCache & o ) = delete;
+            BlockCache & operator =( BlockCache && o )      = delete;
+            
+            const Block & block( Engine::Mode mode, unsigned int bits, uint64_t address, size_t size );
+            void          invalidate( uint64_t page );
+            
+            std::vector< std::pair< std::shared_ptr< const Block >, uint64_t > > blocks( void ) const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_BLOCK_CACHE_HPP */
@@ -0,0 +1,453 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/CacheSimulator.hpp"
+#include "UB/RingBuffer.hpp"
+#include "UB/CallStack.hpp"
+#include "UB/String.hpp"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+
+namespace UB
+{
+    class CacheSimulator::IMPL
+    {
+        public:
+            
+            enum class Kind: uint8_t
+            {
+                Read,
+                Write,
+                Fetch,
+                Block
+            };
+            
+            enum Counter
+            {
+                L1DAccesses,
+                L1DMisses,
+                L1IAccesses,
+                L1IMisses,
+                L2Accesses,
+                L2Misses,
+                Counters
+            };
+            
+            class Event
+            {
+                public:
+                    
+                    uint64_t _address;
+                    uint32_t _size;
+                    Kind     _kind;
+                    uint8_t  _exit;
+            };
+            
+            class Level
+            {
+                public:
+                    
+                    Level( uint64_t size, uint64_t ways, uint64_t line );
+                    
+                    bool access( uint64_t line );
+                    
+                    uint64_t                _size;
+                    uint64_t                _ways;
+                    uint64_t                _line;
+                    uint64_t                _sets;
+                    uint64_t                _clock;
+                    std::vector< uint64_t > _tags;
+                    std::vector< uint64_t > _ages;
+            };
+            
+            typedef std::array< uint64_t, Counters > Stats;
+            
+            IMPL( const std::string & geometry );
+            ~IMPL( void );
+            
+            static void _print( std::stringstream & ss, const std::string & title, const std::map< uint64_t, Stats > & stats, size_t max );
+            
+            void _run( void );
+            void _push( const Event & event );
+            void _process( const Event & event );
+            void _access( bool instruction, uint64_t address, uint32_t size );
+            
+            std::map< std::string, Level > _levels;
+            RingBuffer< Event >            _ring;
+            std::thread                    _thread;
+            std::atomic< bool >            _stopping;
+            CallStack                      _stack;
+            Stats                          _totals;
+            std::map< uint64_t, Stats >    _blocks;
+            std::map< uint64_t, Stats >    _functions;
+            Stats                        * _block;
+            Stats                        * _function;
+            mutable std::mutex             _mtx;
+    };
+    
+    CacheSimulator::CacheSimulator( const std::string & geometry ):
+        impl( std::make_unique< IMPL >( geometry ) )
+    {}
+    
+    CacheSimulator::~CacheSimulator( void )
+    {
+        this->stop();
+    }
+    
+    void CacheSimulator::access( Engine::MemoryAccess access, uint64_t address, size_t size )
+    {
+        IMPL::Event event;
+        
+        event._address = address;
+        event._size    = static_cast< uint32_t >( size );
+        event._kind    = ( access == Engine::MemoryAccess::Read ) ? IMPL::Kind::Read : ( ( access == Engine::MemoryAccess::Write ) ? IMPL::Kind::Write : IMPL::Kind::Fetch );
+        event._exit    = 0;
+        
+        this->impl->_push( event );
+    }
+    
+    void CacheSimulator::block( const BlockCache::Block & block )
+    {
+        IMPL::Event event;
+        
+        event._address = block.address();
+        event._size    = static_cast< uint32_t >( block.size() );
+        event._kind    = IMPL::Kind::Block;
+        event._exit    = static_cast< uint8_t >( block.exit() );
+        
+        this->impl->_push( event );
+    }
+    
+    void CacheSimulator::stop( void )
+    {
+        this->impl->_stopping = true;
+        
+        if( this->impl->_thread.joinable() )
+        {
+            this->impl->_thread.join();
+        }
+    }
+    
+    std::string CacheSimulator::report( size_t top ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        std::stringstream             ss;
+        
+        ss << "Cache simulation:";
+        
+        for( const auto & p: this->impl->_levels )
+        {
+            ss << " " << String::toUpper( p.first ) << " "
+               << p.second._size / 1024 << "KB "
+               << p.second._ways << "-way "
+               << p.second._line << "B lines"
+               << ( ( p.first == "l2" ) ? "" : "," );
+        }
+        
+        ss << std::endl;
+        
+        IMPL::_print( ss, "Totals",                                        { { 0, this->impl->_totals } }, 1 );
+        IMPL::_print( ss, "Functions (top " + std::to_string( top ) + ")", this->impl->_functions,        top );
+        IMPL::_print( ss, "Blocks (top " + std::to_string( top ) + ")",    this->impl->_blocks,           top );
+        
+        return ss.str();
+    }
+    
+    CacheSimulator::IMPL::Level::Level( uint64_t size, uint64_t ways, uint64_t line ):
+        _size(  size ),
+        _ways(  ways ),
+        _line(  line ),
+        _sets(  0 ),
+        _clock( 0 )
+    {
+        if( ways == 0 || line == 0 || ( line & ( line - 1 ) ) != 0 || size % ( ways * line ) != 0 || size / ( ways * line ) == 0 )
+        {
+            throw std::runtime_error( "Invalid cache geometry: " + std::to_string( size ) + " bytes, " + std::to_string( ways ) + " ways, " + std::to_string( line ) + " bytes per line" );
+        }
+        
+        this->_sets = size / ( ways * line );
+        
+        this->_tags.resize( this->_sets * ways, 0 );
+        this->_ages.resize( this->_sets * ways, 0 );
+    }
+    
+    bool CacheSimulator::IMPL::Level::access( uint64_t line )
+    {
+        size_t first( static_cast< size_t >( ( line % this->_sets ) * this->_ways ) );
+        size_t victim( first );
+        
+        this->_clock++;
+        
+        /* Tags are stored as line + 1, so zero marks an empty way */
+        for( size_t i = first; i < first + this->_ways; i++ )
+        {
+            if( this->_tags[ i ] == line + 1 )
+            {
+                this->_ages[ i ] = this->_clock;
+                
+                return true;
+            }
+            
+            if( this->_ages[ i ] < this->_ages[ victim ] )
+            {
+                victim = i;
+            }
+        }
+        
+        this->_tags[ victim ] = line + 1;
+        this->_ages[ victim ] = this->_clock;
+        
+        return false;
+    }
+    
+    CacheSimulator::IMPL::IMPL( const std::string & geometry ):
+        _ring(     1 << 16 ),
+        _stopping( false ),
+        _block(    nullptr ),
+        _function( nullptr )
+    {
+        std::stringstream ss( geometry );
+        std::string       entry;
+        
+        this->_levels.emplace( "l1d", Level(  32 * 1024, 8, 64 ) );
+        this->_levels.emplace( "l1i", Level(  32 * 1024, 8, 64 ) );
+        this->_levels.emplace( "l2",  Level( 256 * 1024, 8, 64 ) );
+        
+        while( std::getline( ss, entry, ',' ) )
+        {
+            size_t                  equal( entry.find( '=' ) );
+            std::string             name( String::toLower( entry.substr( 0, equal ) ) );
+            std::stringstream       values( ( equal == std::string::npos ) ? "" : entry.substr( equal + 1 ) );
+            std::vector< uint64_t > v;
+            std::string             value;
+            
+            if( entry.length() == 0 )
+            {
+                continue;
+            }
+            
+            while( std::getline( values, value, ':' ) )
+            {
+                char   * end;
+                uint64_t n( std::strtoull( value.c_str(), &end, 0 ) );
+                
+                if( *( end ) == 'k' || *( end ) == 'K' )
+                {
+                    n *= 1024;
+                    end++;
+                }
+                else if( *( end ) == 'm' || *( end ) == 'M' )
+                {
+                    n *= 1024 * 1024;
+                    end++;
+                }
+                
+                if( value.length() == 0 || *( end ) != 0 )
+                {
+                    throw std::runtime_error( "Invalid cache geometry: " + entry );
+                }
+                
+                v.push_back( n );
+            }
+            
+            if( this->_levels.count( name ) == 0 || v.size() != 3 )
+            {
+                throw std::runtime_error( "Invalid cache geometry: " + entry + " - Expected l1d, l1i or l2=SIZE:WAYS:LINE" );
+            }
+            
+            this->_levels.erase( name );
+            this->_levels.emplace( name, Level( v[ 0 ], v[ 1 ], v[ 2 ] ) );
+        }
+        
+        this->_totals.fill( 0 );
+        
+        this->_thread = std::thread( [ this ] { this->_run(); } );
+    }
+    
+    CacheSimulator::IMPL::~IMPL( void )
+    {}
+    
+    void CacheSimulator::IMPL::_print( std::stringstream & ss, const std::string & title, const std::map< uint64_t, Stats > & stats, size_t max )
+    {
+        std::vector< std::pair< uint64_t, Stats > > sorted( stats.begin(), stats.end() );
+        
+        std::sort
+        (
+            sorted.begin(),
+            sorted.end(),
+            []( const std::pair< uint64_t, Stats > & o1, const std::pair< uint64_t, Stats > & o2 ) -> bool
+            {
+                uint64_t m1( o1.second[ L1DMisses ] + o1.second[ L1IMisses ] );
+                uint64_t m2( o2.second[ L1DMisses ] + o2.second[ L1IMisses ] );
+                
+                return ( m1 == m2 ) ? o1.first < o2.first : m1 > m2;
+            }
+        );
+        
+        ss << std::endl << "    " << title << ":" << std::endl << std::endl
+           << "        "
+           << std::left  << std::setw( 20 ) << ""
+           << std::right
+           << std::setw( 14 ) << "L1D accesses" << std::setw( 9 ) << "miss"
+           << std::setw( 14 ) << "L1I accesses" << std::setw( 9 ) << "miss"
+           << std::setw( 14 ) << "L2 accesses"  << std::setw( 9 ) << "miss"
+           << std::endl;
+        
+        for( size_t i = 0; i < sorted.size() && i < max; i++ )
+        {
+            ss << "        " << std::left << std::setw( 20 ) << ( ( title == "Totals" ) ? "All" : String::toHex( sorted[ i ].first ) ) << std::right;
+            
+            for( size_t j = 0; j < Counters; j += 2 )
+            {
+                uint64_t accesses( sorted[ i ].second[ j ] );
+                uint64_t misses(   sorted[ i ].second[ j + 1 ] );
+                
+                ss << std::setw( 14 ) << accesses
+                   << std::fixed << std::setprecision( 2 ) << std::setw( 8 )
+                   << ( ( accesses > 0 ) ? ( static_cast< double >( misses ) * 100.0 ) / static_cast< double >( accesses ) : 0.0 )
+                   << "%";
+            }
+            
+            ss << std::endl;
+        }
+    }
+    
+    void CacheSimulator::IMPL::_run( void )
+    {
+        std::vector< Event > events( 4096 );
+        
+        while( true )
+        {
+            size_t n( this->_ring.pop( events.data(), events.size() ) );
+            
+            if( n == 0 )
+            {
+                if( this->_stopping && this->_ring.size() == 0 )
+                {
+                    break;
+                }
+                
+                std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+                
+                continue;
+            }
+            
+            {
+                std::lock_guard< std::mutex > l( this->_mtx );
+                
+                for( size_t i = 0; i < n; i++ )
+                {
+                    this->_process( events[ i ] );
+                }
+            }
+        }
+    }
+    
+    void CacheSimulator::IMPL::_push( const Event & event )
+    {
+        /* Waiting rather than dropping keeps the simulation exact */
+        while( this->_ring.push( event ) == false )
+        {
+            if( this->_stopping )
+            {
+                return;
+            }
+            
+            std::this_thread::yield();
+        }
+    }
+    
+    void CacheSimulator::IMPL::_process( const Event & event )
+    {
+        if( event._kind == Kind::Block )
+        {
+            this->_stack.block( event._address, static_cast< BlockCache::Exit >( event._exit ) );
+            
+            this->_block    = &( this->_blocks[ event._address ] );
+            this->_function = &( this->_functions[ this->_stack.function() ] );
+            
+            return;
+        }
+        
+        this->_access( event._kind == Kind::Fetch, event._address, event._size );
+    }
+    
+    void CacheSimulator::IMPL::_access( bool instruction, uint64_t address, uint32_t size )
+    {
+        Level & l1( this->_levels.at( ( instruction ) ? "l1i" : "l1d" ) );
+        Level & l2( this->_levels.at( "l2" ) );
+        size_t  accesses( ( instruction ) ? L1IAccesses : L1DAccesses );
+        uint64_t first( address / l1._line );
+        uint64_t last( ( address + std::max< uint32_t >( size, 1 ) - 1 ) / l1._line );
+        
+        for( uint64_t line = first; line <= last; line++ )
+        {
+            std::array< size_t, 2 > counters{ { accesses, accesses + 1 } };
+            bool                    hit( l1.access( line ) );
+            
+            this->_totals[ counters[ 0 ] ]++;
+            
+            if( this->_block != nullptr )
+            {
+                ( *( this->_block ) )[ counters[ 0 ] ]++;
+                ( *( this->_function ) )[ counters[ 0 ] ]++;
+            }
+            
+            if( hit )
+            {
+                continue;
+            }
+            
+            this->_totals[ counters[ 1 ] ]++;
+            this->_totals[ L2Accesses ]++;
+            
+            if( this->_block != nullptr )
+            {
+                ( *( this->_block ) )[ counters[ 1 ] ]++;
+                ( *( this->_function ) )[ counters[ 1 ] ]++;
+                ( *( this->_block ) )[ L2Accesses ]++;
+                ( *( this->_function ) )[ L2Accesses ]++;
+            }
+            
+            if( l2.access( ( line * l1._line ) / l2._line ) == false )
+            {
+                this->_totals[ L2Misses ]++;
+                
+                if( this->_block != nullptr )
+                {
+                    ( *( this->_block ) )[ L2Misses ]++;
+                    ( *( this->_function ) )[ L2Misses ]++;
+                }
+            }
+        }
+    }
+}
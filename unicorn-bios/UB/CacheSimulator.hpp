@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_CACHE_SIMULATOR_HPP
+#define UB_CACHE_SIMULATOR_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "UB/Engine.hpp"
+#include "UB/BlockCache.hpp"
+
+namespace UB
+{
+    /*!
+     * Set-associative L1D/L1I/L2 cache simulator with LRU replacement.
+     * 
+     * The geometry is given as "level=SIZE:WAYS:LINE" entries separated by
+     * commas (e.g. "l1d=32K:8:64,l1i=32K:8:64,l2=256K:8:64"). Levels left
+     * out keep their defaults. L2 is unified and sees L1 misses only.
+     * 
+     * access() and block() are called on the emulation thread. They only
+     * push events to a ring buffer, which a simulator thread drains.
+     * Block events carry the exit kind the BlockCache decoded on the
+     * emulation thread, so calls and returns are tracked for the
+     * per-function report without the simulator reading guest memory.
+     */
+    class CacheSimulator
+    {
+        public:
+            
+            CacheSimulator( const std::string & geometry );
+            ~CacheSimulator( void );
+            
+            CacheSimulator( const CacheSimulator & o )              = delete;
+            CacheSimulator( CacheSimulator && o )                   = delete;
+            CacheSimulator & operator =( const CacheSimulator & o ) = delete;
+            CacheSimulator & operator =( CacheSimulator && o )      = delete;
+            
+            void access( Engine::MemoryAccess access, uint64_t address, size_t size );
+            void block( const BlockCache::Block & block );
+            void stop( void );
+            
+            std::string report( size_t top = 20 ) const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_CACHE_SIMULATOR_HPP */
@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/CallStack.hpp"
+#include <vector>
+
+namespace UB
+{
+    class CallStack::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            IMPL( const IMPL & o );
+            ~IMPL( void );
+            
+            std::vector< uint64_t > _stack;
+            uint64_t                _function;
+            bool                    _call;
+            bool                    _entered;
+    };
+    
+    CallStack::CallStack( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    CallStack::CallStack( const CallStack & o ):
+        impl( std::make_unique< IMPL >( *( o.impl ) ) )
+    {}
+    
+    CallStack::CallStack( CallStack && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    CallStack::~CallStack( void )
+    {}
+    
+    CallStack & CallStack::operator =( CallStack o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void CallStack::block( uint64_t address, BlockCache::Exit exit )
+    {
+        this->impl->_entered = this->impl->_call || this->impl->_stack.size() == 0;
+        
+        if( this->impl->_entered && this->impl->_stack.size() < 1024 )
+        {
+            this->impl->_stack.push_back( address );
+        }
+        
+        this->impl->_function = this->impl->_stack.back();
+        this->impl->_call     = exit == BlockCache::Exit::Call;
+        
+        if( exit == BlockCache::Exit::Return && this->impl->_stack.size() > 1 )
+        {
+            this->impl->_stack.pop_back();
+        }
+    }
+    
+    uint64_t CallStack::function( void ) const
+    {
+        return this->impl->_function;
+    }
+    
+    bool CallStack::entered( void ) const
+    {
+        return this->impl->_entered;
+    }
+    
+    void swap( CallStack & o1, CallStack & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    CallStack::IMPL::IMPL( void ):
+        _function( 0 ),
+        _call(     false ),
+        _entered(  false )
+    {}
+    
+    CallStack::IMPL::IMPL( const IMPL & o ):
+        _stack(    o._stack ),
+        _function( o._function ),
+        _call(     o._call ),
+        _entered(  o._entered )
+    {}
+    
+    CallStack::IMPL::~IMPL( void )
+    {}
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_CALL_STACK_HPP
+#define UB_CALL_STACK_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include "UB/BlockCache.hpp"
+
+namespace UB
+{
+    /*!
+     * Shadow call stack rebuilt from block exits, to attribute blocks to
+     * the function they run in.
+     * 
+     * The first block, and any block following a call, enters a function
+     * starting at its address. A returning block still belongs to the
+     * function it returns from. The depth is capped so code that calls
+     * without returning can't grow it without bound.
+     */
+    class CallStack
+    {
+        public:
+            
+            CallStack( void );
+            CallStack( const CallStack & o );
+            CallStack( CallStack && o ) noexcept;
+            ~CallStack( void );
+            
+            CallStack & operator =( CallStack o );
+            
+            void     block( uint64_t address, BlockCache::Exit exit );
+            uint64_t function( void ) const;
+            bool     entered( void )  const;
+            
+            friend void swap( CallStack & o1, CallStack & o2 );
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_CALL_STACK_HPP */
@@ -41,15 +41,25 @@ namespace UB
 {
     namespace Capstone
     {
-        std::vector< std::pair< std::string, std::string > > disassemble( const std::vector< uint8_t > & data, uint64_t org )
+        std::vector< std::pair< std::string, std::string > > disassemble( const std::vector< uint8_t > & data, uint64_t org, unsigned int bits )
         {
             csh       handle;
             cs_insn * instruction;
             size_t    count;
+            cs_mode   mode;
             
             std::vector< std::pair< std::string, std::string > > v;
             
-            if( cs_open( CS_ARCH_X86, CS_MODE_16, &handle ) != CS_ERR_OK )
+            switch( bits )
+            {
+                case 16: mode = CS_MODE_16; break;
+                case 32: mode = CS_MODE_32; break;
+                case 64: mode = CS_MODE_64; break;
+                
+                default: return {};
+            }
+            
+            if( cs_open( CS_ARCH_X86, mode, &handle ) != CS_ERR_OK )
             {
                 return {};
             }
@@ -80,15 +90,25 @@ namespace UB
             return v;
         }
         
-        std::vector< std::pair< std::string, std::string > > instructions( const std::vector< uint8_t > & data, uint64_t org )
+        std::vector< std::pair< std::string, std::string > > instructions( const std::vector< uint8_t > & data, uint64_t org, unsigned int bits )
         {
             csh       handle;
             cs_insn * instruction;
             size_t    count;
+            cs_mode   mode;
             
             std::vector< std::pair< std::string, std::string > > v;
             
-            if( cs_open( CS_ARCH_X86, CS_MODE_16, &handle ) != CS_ERR_OK )
+            switch( bits )
+            {
+                case 16: mode = CS_MODE_16; break;
+                case 32: mode = CS_MODE_32; break;
+                case 64: mode = CS_MODE_64; break;
+                
+                default: return {};
+            }
+            
+            if( cs_open( CS_ARCH_X86, mode, &handle ) != CS_ERR_OK )
             {
                 return {};
             }
@@ -129,5 +149,70 @@ namespace UB
             
             return v;
         }
+        
+        std::vector< std::pair< std::string, std::vector< std::string > > > groups( const std::vector< uint8_t > & data, uint64_t org, unsigned int bits )
+        {
+            csh       handle;
+            cs_insn * instruction;
+            size_t    count;
+            cs_mode   mode;
+            
+            std::vector< std::pair< std::string, std::vector< std::string > > > v;
+            
+            if( data.size() == 0 )
+            {
+                return {};
+            }
+            
+            switch( bits )
+            {
+                case 16: mode = CS_MODE_16; break;
+                case 32: mode = CS_MODE_32; break;
+                case 64: mode = CS_MODE_64; break;
+                
+                default: return {};
+            }
+            
+            if( cs_open( CS_ARCH_X86, mode, &handle ) != CS_ERR_OK )
+            {
+                return {};
+            }
+            
+            cs_option( handle, CS_OPT_DETAIL, CS_OPT_ON );
+            
+            count = cs_disasm( handle, &( data[ 0 ] ), data.size(), org, 0, &instruction );
+            
+            if( count == 0 )
+            {
+                cs_close( &handle );
+                
+                return {};
+            }
+            
+            for( size_t i = 0; i < count; i++ )
+            {
+                std::vector< std::string > names;
+                
+                if( instruction[ i ].detail != nullptr )
+                {
+                    for( size_t j = 0; j < instruction[ i ].detail->groups_count; j++ )
+                    {
+                        const char * name( cs_group_name( handle, instruction[ i ].detail->groups[ j ] ) );
+                        
+                        if( name != nullptr )
+                        {
+                            names.push_back( name );
+                        }
+                    }
+                }
+                
+                v.push_back( { instruction[ i ].mnemonic, names } );
+            }
+            
+            cs_free( instruction, count );
+            cs_close( &handle );
+            
+            return v;
+        }
     }
 }
@@ -33,8 +33,10 @@ namespace UB
 {
     namespace Capstone
     {
-        std::vector< std::pair< std::string, std::string > > disassemble(  const std::vector< uint8_t > & data, uint64_t org );
-        std::vector< std::pair< std::string, std::string > > instructions( const std::vector< uint8_t > & data, uint64_t org );
+        std::vector< std::pair< std::string, std::string > > disassemble(  const std::vector< uint8_t > & data, uint64_t org, unsigned int bits = 16 );
+        std::vector< std::pair< std::string, std::string > > instructions( const std::vector< uint8_t > & data, uint64_t org, unsigned int bits = 16 );
+        
+        std::vector< std::pair< std::string, std::vector< std::string > > > groups( const std::vector< uint8_t > & data, uint64_t org, unsigned int bits );
     }
 }
 
@@ -0,0 +1,226 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/DiskAttribution.hpp"
+#include "UB/FAT/FileMap.hpp"
+#include <mutex>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <sstream>
+#include <iomanip>
+
+namespace UB
+{
+    class DiskAttribution::IMPL
+    {
+        public:
+            
+            class Stats
+            {
+                public:
+                    
+                    Stats( void );
+                    
+                    uint64_t _order;
+                    uint64_t _requests;
+                    uint64_t _bytes;
+                    uint64_t _rereads;
+                    uint64_t _rereadBytes;
+            };
+            
+            IMPL( const FAT::Image & image );
+            ~IMPL( void );
+            
+            static uint64_t _mark( std::map< uint64_t, uint64_t > & read, uint64_t begin, uint64_t end );
+            
+            mutable std::mutex                            _mtx;
+            FAT::FileMap                                  _map;
+            std::vector< Stats >                          _stats;
+            std::vector< std::map< uint64_t, uint64_t > > _read;
+            uint64_t                                      _requests;
+            uint64_t                                      _bytes;
+            uint64_t                                      _rereadBytes;
+            uint64_t                                      _objects;
+    };
+    
+    DiskAttribution::DiskAttribution( const FAT::Image & image ):
+        impl( std::make_unique< IMPL >( image ) )
+    {}
+    
+    DiskAttribution::~DiskAttribution( void )
+    {}
+    
+    void DiskAttribution::read( const BIOS::DiskAccess & access )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        uint64_t                      bytesPerSector( std::max< uint64_t >( access.bytesPerSector(), 1 ) );
+        uint64_t                      lba( access.lba() );
+        std::vector< size_t >         touched;
+        
+        if( access.success() == false || access.sectors() == 0 )
+        {
+            return;
+        }
+        
+        this->impl->_requests++;
+        this->impl->_bytes += access.sectors() * bytesPerSector;
+        
+        for( const auto & piece: this->impl->_map.find( lba, access.sectors() ) )
+        {
+            IMPL::Stats & stats( this->impl->_stats[ std::get< 0 >( piece ) ] );
+            uint64_t      rereads( IMPL::_mark( this->impl->_read[ std::get< 0 >( piece ) ], std::get< 1 >( piece ), std::get< 1 >( piece ) + std::get< 2 >( piece ) ) );
+            
+            if( stats._requests == 0 )
+            {
+                stats._order = ++this->impl->_objects;
+            }
+            
+            /* A request spanning several extents of one object counts once */
+            if( std::find( touched.begin(), touched.end(), std::get< 0 >( piece ) ) == touched.end() )
+            {
+                touched.push_back( std::get< 0 >( piece ) );
+                
+                stats._requests++;
+                
+                if( rereads > 0 )
+                {
+                    stats._rereads++;
+                }
+            }
+            
+            stats._bytes             += std::get< 2 >( piece ) * bytesPerSector;
+            stats._rereadBytes       += rereads * bytesPerSector;
+            this->impl->_rereadBytes += rereads * bytesPerSector;
+        }
+    }
+    
+    std::string DiskAttribution::report( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        std::stringstream             ss;
+        std::vector< size_t >         objects;
+        
+        for( size_t i = 0; i < this->impl->_stats.size(); i++ )
+        {
+            if( this->impl->_stats[ i ]._requests > 0 )
+            {
+                objects.push_back( i );
+            }
+        }
+        
+        std::sort
+        (
+            objects.begin(),
+            objects.end(),
+            [ & ]( size_t o1, size_t o2 ) -> bool
+            {
+                return this->impl->_stats[ o1 ]._order < this->impl->_stats[ o2 ]._order;
+            }
+        );
+        
+        ss << "Disk attribution: "
+           << this->impl->_map.type() << " volume, "
+           << this->impl->_requests << " read requests, "
+           << this->impl->_bytes << " bytes, "
+           << this->impl->_rereadBytes << " bytes re-read"
+           << std::endl
+           << std::endl
+           << std::setw( 6 )  << "Order"
+           << std::setw( 10 ) << "Requests"
+           << std::setw( 14 ) << "Bytes"
+           << std::setw( 10 ) << "Re-reads"
+           << std::setw( 14 ) << "Re-read bytes"
+           << std::setw( 14 ) << "Size"
+           << "  Object"
+           << std::endl;
+        
+        for( size_t object: objects )
+        {
+            const IMPL::Stats & stats( this->impl->_stats[ object ] );
+            
+            ss << std::setw( 6 )  << stats._order
+               << std::setw( 10 ) << stats._requests
+               << std::setw( 14 ) << stats._bytes
+               << std::setw( 10 ) << stats._rereads
+               << std::setw( 14 ) << stats._rereadBytes
+               << std::setw( 14 ) << this->impl->_map.size( object )
+               << "  " << this->impl->_map.name( object )
+               << std::endl;
+        }
+        
+        return ss.str();
+    }
+    
+    DiskAttribution::IMPL::Stats::Stats( void ):
+        _order(       0 ),
+        _requests(    0 ),
+        _bytes(       0 ),
+        _rereads(     0 ),
+        _rereadBytes( 0 )
+    {}
+    
+    DiskAttribution::IMPL::IMPL( const FAT::Image & image ):
+        _map(         image ),
+        _stats(       this->_map.count() ),
+        _read(        this->_map.count() ),
+        _requests(    0 ),
+        _bytes(       0 ),
+        _rereadBytes( 0 ),
+        _objects(     0 )
+    {}
+    
+    DiskAttribution::IMPL::~IMPL( void )
+    {}
+    
+    uint64_t DiskAttribution::IMPL::_mark( std::map< uint64_t, uint64_t > & read, uint64_t begin, uint64_t end )
+    {
+        uint64_t first( begin );
+        uint64_t last( end );
+        uint64_t overlap( 0 );
+        auto     it( read.upper_bound( begin ) );
+        
+        /* Sectors read so far are kept as disjoint [ begin, end ) ranges, merged as they touch */
+        if( it != read.begin() && std::prev( it )->second >= begin )
+        {
+            it = std::prev( it );
+        }
+        
+        while( it != read.end() && it->first <= end )
+        {
+            if( std::min( it->second, end ) > std::max( it->first, begin ) )
+            {
+                overlap += std::min( it->second, end ) - std::max( it->first, begin );
+            }
+            
+            first = std::min( first, it->first );
+            last  = std::max( last,  it->second );
+            it    = read.erase( it );
+        }
+        
+        read.emplace( first, last );
+        
+        return overlap;
+    }
+}
@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_DISK_ATTRIBUTION_HPP
+#define UB_DISK_ATTRIBUTION_HPP
+
+#include <memory>
+#include <algorithm>
+#include <string>
+#include "UB/FAT/Image.hpp"
+#include "UB/BIOS/DiskAccess.hpp"
+
+namespace UB
+{
+    /*!
+     * Attributes INT 13h reads to the FAT objects they touch, using the
+     * extent table of FAT::FileMap, and counts requests, bytes and
+     * re-reads (sectors already read earlier in the run) per object.
+     * Objects are reported in the order they were first read.
+     */
+    class DiskAttribution
+    {
+        public:
+            
+            DiskAttribution( const FAT::Image & image );
+            ~DiskAttribution( void );
+            
+            DiskAttribution( const DiskAttribution & o )              = delete;
+            DiskAttribution( DiskAttribution && o )                   = delete;
+            DiskAttribution & operator =( const DiskAttribution & o ) = delete;
+            DiskAttribution & operator =( DiskAttribution && o )      = delete;
+            
+            void read( const BIOS::DiskAccess & access );
+            
+            std::string report( void ) const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_DISK_ATTRIBUTION_HPP */
@@ -30,12 +30,22 @@
 #include "UB/Engine.hpp"
 #include "UB/String.hpp"
 #include "UB/Casts.hpp"
+#include "UB/Timeline.hpp"
+#include "UB/RecursiveMutex.hpp"
+#include "UB/Probes.hpp"
+#include "UB/FlightRecorder.hpp"
 #include <unicorn/unicorn.h>
 #include <map>
+#include <set>
+#include <array>
+#include <list>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <limits>
+#include <atomic>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace UB
 {
@@ -43,27 +53,54 @@ namespace UB
     {
         public:
             
-            IMPL( size_t memory );
+            IMPL( const std::vector< std::pair< uint64_t, uint64_t > > & regions );
             ~IMPL( void );
             
+            void _setup( const std::vector< std::pair< uint64_t, uint64_t > > & regions );
+            void _release( void );
+            
             static void _handleInterrupt(   uc_engine * uc, uint32_t i, void * data );
             static void _handleInstruction( uc_engine * uc, uint64_t address, uint32_t size, void * data );
             static bool _handleInvalidMemoryAccess( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data );
             static void _handleValidMemoryAccess( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data );
+            static void _handlePortOutput( uc_engine * uc, uint32_t port, int size, uint32_t value, void * data );
+            static void _handleBlock( uc_engine * uc, uint64_t address, uint32_t size, void * data );
+            static void _handleRangedMemoryAccess( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data );
+            static void _handleRangedFetch( uc_engine * uc, uint64_t address, uint32_t size, void * data );
+            static void _handleDeviceAccess( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data );
+            static void _handleCodeWrite( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data );
             
-            std::vector< uint8_t > _read( size_t address, size_t size );
-            void                   _write( size_t address, const uint8_t * bytes, size_t size );
-            void                   _switchMode( Mode mode );
+            std::vector< uint8_t >  _read( size_t address, size_t size );
+            void                    _write( size_t address, const uint8_t * bytes, size_t size );
+            bool                    _updateMode( uc_engine * uc, Mode & previous );
+            bool                    _mapped( size_t address, size_t size ) const;
+            bool                    _special( size_t address, size_t size ) const;
+            void                    _map( uint64_t begin, uint64_t end );
+            void                    _executed( uint64_t address, size_t size );
+            bool                    _hasExecuted( size_t region, uint64_t address, size_t size ) const;
+            void                    _track( uint64_t address );
+            std::vector< uint64_t > _invalidate( uint64_t address, size_t size );
             
-            size_t                       _memory;
-            Mode                         _mode;
-            Registers                    _registers;
-            uint64_t                     _lastInstructionAddress;
-            std::vector< uint8_t >       _lastInstruction;
-            uc_engine                  * _uc;
-            bool                         _running;
-            mutable std::recursive_mutex _rmtx;
-            std::condition_variable_any  _cv;
+            std::vector< std::pair< uint64_t, uint64_t > >   _regions;
+            std::vector< void * >                            _backing;
+            std::vector< std::vector< bool > >               _executedPages;
+            std::vector< std::vector< bool > >               _codePages;
+            std::set< uint64_t >                             _trackedChunks;
+            std::vector< std::pair< uint64_t, uint64_t > >   _specialRanges;
+            size_t                                           _memory;
+            Mode                                             _mode;
+            std::atomic< unsigned int >                      _bits;
+            uint64_t                                         _cr0;
+            uint16_t                                         _cs;
+            Registers                                        _registers;
+            uint64_t                                         _lastInstructionAddress;
+            std::vector< uint8_t >                           _lastInstruction;
+            uc_engine                                      * _uc;
+            bool                                             _running;
+            std::atomic< uint64_t >                          _instructions;
+            std::atomic< FlightRecorder * >                  _recorder;
+            mutable RecursiveMutex                           _rmtx;
+            std::condition_variable_any                      _cv;
             
             std::vector< std::function< void( void ) > >                                                        _onStart;
             std::vector< std::function< void( void ) > >                                                        _onStop;
@@ -73,13 +110,19 @@ namespace UB
             std::vector< std::function< void( uint64_t, size_t ) > >                                            _validMemoryHandlers;
             std::vector< std::function< void( uint64_t, const std::vector< uint8_t > & ) > >                    _beforeInstructionHandlers;
             std::vector< std::function< void( uint64_t, const Registers &, const std::vector< uint8_t > & ) > > _afterInstructionHandlers;
+            std::vector< std::function< void( uint16_t, size_t, uint32_t ) > >                                  _portOutputHandlers;
+            std::vector< std::function< void( uint64_t, size_t ) > >                                            _blockHandlers;
+            std::list< std::function< void( MemoryAccess, uint64_t, size_t ) > >                                _memoryAccessHandlers;
+            std::list< std::function< uint64_t( MemoryAccess, uint64_t, size_t, uint64_t ) > >                  _deviceHandlers;
+            std::vector< std::function< void( uint64_t ) > >                                                    _codeWriteHandlers;
+            std::vector< std::function< void( Mode, Mode ) > >                                                  _modeHandlers;
             
             template< typename _T_ >
             _T_ _readRegister( int reg ) const
             {
                 _T_                                     v( 0 );
                 uc_err                                  e;
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->_rmtx );
                 
                 if( ( e = uc_reg_read( this->_uc, reg, &v ) ) != UC_ERR_OK )
                 {
@@ -93,7 +136,7 @@ namespace UB
             void _writeRegister( int reg, _T_ value )
             {
                 uc_err                                  e;
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->_rmtx );
                 
                 if( ( e = uc_reg_write( this->_uc, reg, &value ) ) != UC_ERR_OK )
                 {
@@ -113,12 +156,18 @@ namespace UB
     }
     
     Engine::Engine( size_t memory ):
-        impl( std::make_unique< IMPL >( memory ) )
+        Engine( std::vector< std::pair< uint64_t, uint64_t > > { { 0, memory } } )
+    {}
+    
+    Engine::Engine( const std::vector< std::pair< uint64_t, uint64_t > > & regions ):
+        impl( std::make_unique< IMPL >( regions ) )
     {
         uc_hook h1;
         uc_hook h2;
         uc_hook h3;
         uc_hook h4;
+        uc_hook h5;
+        uc_hook h6;
         uc_err  e;
         
         if( ( e = uc_hook_add( this->impl->_uc, &h1, UC_HOOK_INTR, reinterpret_cast< void * >( &IMPL::_handleInterrupt ), this, 0, std::numeric_limits< uint64_t >::max() ) ) != UC_ERR_OK )
@@ -140,6 +189,16 @@ namespace UB
         {
             throw std::runtime_error( uc_strerror( e ) );
         }
+        
+        if( ( e = uc_hook_add( this->impl->_uc, &h5, UC_HOOK_INSN, reinterpret_cast< void * >( &IMPL::_handlePortOutput ), this, 0, std::numeric_limits< uint64_t >::max(), UC_X86_INS_OUT ) ) != UC_ERR_OK )
+        {
+            throw std::runtime_error( uc_strerror( e ) );
+        }
+        
+        if( ( e = uc_hook_add( this->impl->_uc, &h6, UC_HOOK_BLOCK, reinterpret_cast< void * >( &IMPL::_handleBlock ), this, 0, std::numeric_limits< uint64_t >::max() ) ) != UC_ERR_OK )
+        {
+            throw std::runtime_error( uc_strerror( e ) );
+        }
     }
     
     Engine::~Engine( void )
@@ -149,17 +208,58 @@ namespace UB
     {
         return this->impl->_memory;
     }
+    
+    std::vector< std::pair< uint64_t, uint64_t > > Engine::regions( void ) const
+    {
+        return this->impl->_regions;
+    }
 
     Engine::Mode Engine::mode( void ) const
     {
         return this->impl->_mode;
     }
     
-    void Engine::mode( Mode mode )
+    unsigned int Engine::bits( void ) const
+    {
+        return this->impl->_bits.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Engine::pc( void ) const
     {
-        this->impl->_switchMode( mode );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        uint16_t                          cs( this->cs() );
+        uc_x86_mmr                        gdtr;
+        uint8_t                           descriptor[ 8 ];
+        uint64_t                          base( 0 );
+        
+        if( this->impl->_mode == Mode::Real )
+        {
+            return getAddress( cs, this->ip() );
+        }
+        
+        if( this->impl->_mode == Mode::Long )
+        {
+            return this->rip();
+        }
+        
+        /* Linear address as the translator sees it: CS base from its GDT descriptor plus EIP */
+        if
+        (
+               ( cs & 0x04 ) == 0
+            && uc_reg_read( this->impl->_uc, UC_X86_REG_GDTR, &gdtr ) == UC_ERR_OK
+            && uc_mem_read( this->impl->_uc, gdtr.base + ( cs & ~0x07u ), descriptor, sizeof( descriptor ) ) == UC_ERR_OK
+        )
+        {
+            base = static_cast< uint64_t >( descriptor[ 2 ] )
+                 | ( static_cast< uint64_t >( descriptor[ 3 ] ) << 8 )
+                 | ( static_cast< uint64_t >( descriptor[ 4 ] ) << 16 )
+                 | ( static_cast< uint64_t >( descriptor[ 7 ] ) << 24 );
+        }
+        
+        return ( base + this->eip() ) & 0xFFFFFFFF;
     }
     
+    
     bool Engine::cf( void ) const
     {
         uint32_t flags( this->eflags() );
@@ -167,6 +267,13 @@ namespace UB
         return ( flags & 0x01 ) != 0;
     }
     
+    bool Engine::zf( void ) const
+    {
+        uint32_t flags( this->eflags() );
+        
+        return ( flags & 0x40 ) != 0;
+    }
+    
     uint8_t Engine::ah( void ) const
     {
         return this->impl->_readRegister< uint8_t >( UC_X86_REG_AH );
@@ -559,7 +666,7 @@ namespace UB
     
     void Engine::cf( bool value )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         uint32_t                                flags( this->eflags() );
         
         if( value )
@@ -573,6 +680,23 @@ namespace UB
         
         this->eflags( flags );
     }
+    
+    void Engine::zf( bool value )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        uint32_t                                flags( this->eflags() );
+        
+        if( value )
+        {
+            flags |= 0x40;
+        }
+        else
+        {
+            flags &= ~static_cast< uint32_t >( 0x40 );
+        }
+        
+        this->eflags( flags );
+    }
 
     void Engine::ah( uint8_t value )
     {
@@ -966,74 +1090,179 @@ namespace UB
 
     Registers Engine::registers( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_registers;
     }
     
     bool Engine::running( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_running;
     }
     
+    void Engine::flightRecorder( FlightRecorder * recorder )
+    {
+        this->impl->_recorder = recorder;
+    }
+    
+    uint64_t Engine::instructions( void ) const
+    {
+        return this->impl->_instructions;
+    }
+    
     void Engine::onStart( const std::function< void( void ) > f )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_onStart.push_back( f );
     }
     
     void Engine::onStop( const std::function< void( void ) > f )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_onStop.push_back( f );
     }
     
     void Engine::onInterrupt( const std::function< bool( uint32_t ) > handler )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_interruptHandlers.push_back( handler );
     }
     
     void Engine::onException( const std::function< bool( const std::exception & ) > handler )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_exceptionHandlers.push_back( handler );
     }
     
     void Engine::onInvalidMemoryAccess( const std::function< void( uint64_t, size_t ) > handler )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_invalidMemoryHandlers.push_back( handler );
     }
     
     void Engine::onValidMemoryAccess( const std::function< void( uint64_t, size_t ) > handler )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_validMemoryHandlers.push_back( handler );
     }
     
     void Engine::beforeInstruction( const std::function< void( uint64_t, const std::vector< uint8_t > & ) > handler )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_beforeInstructionHandlers.push_back( handler );
     }
     
     void Engine::afterInstruction( const std::function< void( uint64_t, const Registers &, const std::vector< uint8_t > & ) > handler )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_afterInstructionHandlers.push_back( handler );
     }
     
+    void Engine::onPortOutput( const std::function< void( uint16_t, size_t, uint32_t ) > handler )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        this->impl->_portOutputHandlers.push_back( handler );
+    }
+    
+    void Engine::onBlock( const std::function< void( uint64_t, size_t ) > handler )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        this->impl->_blockHandlers.push_back( handler );
+    }
+    
+    void Engine::onMemoryAccess( uint64_t begin, uint64_t end, const std::function< void( MemoryAccess, uint64_t, size_t ) > handler )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        uc_hook                           h1;
+        uc_hook                           h2;
+        uc_err                            e;
+        
+        /*
+         * Each handler gets its own uc hooks, limited to the range, so the
+         * callbacks run without copying handler lists under the lock.
+         */
+        this->impl->_memoryAccessHandlers.push_back( handler );
+        this->impl->_specialRanges.push_back( { begin, end } );
+        
+        if( ( e = uc_hook_add( this->impl->_uc, &h1, UC_HOOK_MEM_READ | UC_HOOK_MEM_WRITE, reinterpret_cast< void * >( &IMPL::_handleRangedMemoryAccess ), &( this->impl->_memoryAccessHandlers.back() ), begin, end ) ) != UC_ERR_OK )
+        {
+            throw std::runtime_error( uc_strerror( e ) );
+        }
+        
+        if( ( e = uc_hook_add( this->impl->_uc, &h2, UC_HOOK_CODE, reinterpret_cast< void * >( &IMPL::_handleRangedFetch ), &( this->impl->_memoryAccessHandlers.back() ), begin, end ) ) != UC_ERR_OK )
+        {
+            throw std::runtime_error( uc_strerror( e ) );
+        }
+    }
+    
+    void Engine::onDeviceAccess( uint64_t begin, uint64_t end, const std::function< uint64_t( MemoryAccess, uint64_t, size_t, uint64_t ) > handler )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        uc_hook                           h;
+        uc_err                            e;
+        
+        if( end < begin )
+        {
+            throw std::runtime_error( "Invalid device range: " + String::toHex( begin ) + "-" + String::toHex( end ) );
+        }
+        
+        if( this->impl->_mapped( begin, ( end - begin ) + 1 ) == false )
+        {
+            this->impl->_map( begin, end );
+        }
+        
+        this->impl->_deviceHandlers.push_back( handler );
+        this->impl->_specialRanges.push_back( { begin, end } );
+        
+        if( ( e = uc_hook_add( this->impl->_uc, &h, UC_HOOK_MEM_READ | UC_HOOK_MEM_WRITE, reinterpret_cast< void * >( &IMPL::_handleDeviceAccess ), &( this->impl->_deviceHandlers.back() ), begin, end ) ) != UC_ERR_OK )
+        {
+            throw std::runtime_error( uc_strerror( e ) );
+        }
+    }
+    
+    void Engine::onModeChange( const std::function< void( Mode, Mode ) > handler )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        this->impl->_modeHandlers.push_back( handler );
+    }
+    
+    void Engine::onCodeWrite( const std::function< void( uint64_t ) > handler )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        this->impl->_codeWriteHandlers.push_back( handler );
+        
+        /* Write hooks are only installed once someone listens, so pages executed before that need them now */
+        if( this->impl->_codeWriteHandlers.size() > 1 )
+        {
+            return;
+        }
+        
+        for( size_t i = 0; i < this->impl->_regions.size(); i++ )
+        {
+            for( size_t page = 0; page < this->impl->_codePages[ i ].size(); page++ )
+            {
+                if( this->impl->_codePages[ i ][ page ] )
+                {
+                    this->impl->_track( this->impl->_regions[ i ].first + ( page * 0x1000 ) );
+                }
+            }
+        }
+    }
+    
     std::vector< uint8_t > Engine::read( size_t address, size_t size )
     {
         return this->impl->_read( address, size );
@@ -1049,10 +1278,103 @@ namespace UB
         this->impl->_write( address, bytes, size );
     }
     
+    void Engine::fill( size_t address, size_t size, const std::function< void( uint8_t * ) > & filler )
+    {
+        uint8_t * p( nullptr );
+        
+        if( size == 0 )
+        {
+            return;
+        }
+        
+        {
+            std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+            
+            for( size_t i = 0; i < this->impl->_regions.size(); i++ )
+            {
+                const auto & region( this->impl->_regions[ i ] );
+                
+                if( address < region.first || address + size > region.first + region.second )
+                {
+                    continue;
+                }
+                
+                /*
+                 * Writing host memory directly bypasses unicorn, which would
+                 * otherwise invalidate code translated from the destination.
+                 * That's only safe on pages the guest never executed (code
+                 * write hooks only watch executed pages), and away from
+                 * devices, shared mappings and ranged hooks.
+                 */
+                if( this->impl->_hasExecuted( i, address, size ) == false && this->impl->_special( address, size ) == false )
+                {
+                    p = static_cast< uint8_t * >( this->impl->_backing[ i ] ) + ( address - region.first );
+                }
+                
+                break;
+            }
+        }
+        
+        if( p != nullptr )
+        {
+            filler( p );
+        }
+        else
+        {
+            std::vector< uint8_t > bytes( size );
+            
+            filler( bytes.data() );
+            
+            this->impl->_write( address, bytes.data(), bytes.size() );
+        }
+    }
+    
+    void Engine::share( size_t address, size_t size, int fd, int64_t offset )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        if( ( address & 0xFFF ) != 0 || ( size & 0xFFF ) != 0 || ( offset & 0xFFF ) != 0 )
+        {
+            throw std::runtime_error( "Shared guest memory must be page aligned: " + String::toHex( address ) );
+        }
+        
+        for( size_t i = 0; i < this->impl->_regions.size(); i++ )
+        {
+            const auto & region( this->impl->_regions[ i ] );
+            uint8_t    * p( static_cast< uint8_t * >( this->impl->_backing[ i ] ) + ( address - region.first ) );
+            
+            if( address < region.first || address + size > region.first + region.second )
+            {
+                continue;
+            }
+            
+            /*
+             * The file pages replace the anonymous ones at the same host
+             * address, so unicorn keeps using the same pointer and guest
+             * accesses go straight to the file. Current contents are kept.
+             */
+            if( pwrite( fd, p, size, offset ) != static_cast< ssize_t >( size ) )
+            {
+                throw std::runtime_error( "Cannot share guest memory at " + String::toHex( address ) );
+            }
+            
+            if( mmap( p, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset ) == MAP_FAILED )
+            {
+                throw std::runtime_error( "Cannot share guest memory at " + String::toHex( address ) );
+            }
+            
+            this->impl->_specialRanges.push_back( { address, address + size - 1 } );
+            
+            return;
+        }
+        
+        throw std::runtime_error( "Cannot share unmapped guest memory at " + String::toHex( address ) );
+    }
+    
     bool Engine::start( size_t address )
     {
         {
-            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
             
             if( this->impl->_running )
             {
@@ -1073,9 +1395,14 @@ namespace UB
         (
             [ = ]
             {
+                Timeline::shared().threadName( "Emulation" );
+                
+                UB_PROBE1( engine_start, static_cast< uint64_t >( address ) );
+                
                 try
                 {
-                    uc_err e;
+                    Timeline::Span span( "Engine", "Run" );
+                    uc_err         e;
                     
                     if( ( e = uc_emu_start( this->impl->_uc, address, std::numeric_limits< uint64_t >::max(), 0, 0 ) ) != UC_ERR_OK )
                     {
@@ -1087,8 +1414,13 @@ namespace UB
                     std::vector< std::function< bool( const std::exception & ) > > handlers;
                     bool                                                           handled( false );
                     
+                    if( UB_PROBE_ENABLED( exception ) )
                     {
-                        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                        UB_PROBE1( exception, e.what() );
+                    }
+                    
+                    {
+                        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
                         
                         handlers = this->impl->_exceptionHandlers;
                     }
@@ -1107,8 +1439,13 @@ namespace UB
                     }
                 }
                 
+                if( UB_PROBE_ENABLED( engine_stop ) )
+                {
+                    UB_PROBE1( engine_stop, this->impl->_instructions.load() );
+                }
+                
                 {
-                    std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                    std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
                     
                     this->impl->_running = false;
                     
@@ -1126,9 +1463,86 @@ namespace UB
         return true;
     }
     
+    bool Engine::execute( size_t instructions )
+    {
+        return this->execute( instructions, std::numeric_limits< uint64_t >::max() );
+    }
+    
+    /*
+     * Unicorn stops before translating the instruction at until (a linear
+     * address, as returned by pc()), so it is never executed.
+     */
+    bool Engine::execute( size_t instructions, uint64_t until )
+    {
+        uint64_t address;
+        bool     success( true );
+        
+        {
+            std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+            
+            if( this->impl->_running )
+            {
+                return false;
+            }
+            
+            this->impl->_running = true;
+            
+            this->impl->_cv.notify_all();
+            
+            /*
+             * A 16-bit uc subtracts CS * 16 from the start address whatever
+             * the CPU mode, which is only the segment base in real mode.
+             */
+            address = ( this->impl->_mode == Mode::Real ) ? getAddress( this->cs(), this->ip() ) : this->eip() + ( static_cast< uint64_t >( this->cs() ) << 4 );
+        }
+        
+        try
+        {
+            Timeline::Span span( "Engine", "Execute" );
+            uc_err         e;
+            
+            if( ( e = uc_emu_start( this->impl->_uc, address, until, 0, instructions ) ) != UC_ERR_OK )
+            {
+                throw std::runtime_error( uc_strerror( e ) );
+            }
+        }
+        catch( const std::exception & e )
+        {
+            std::vector< std::function< bool( const std::exception & ) > > handlers;
+            
+            success = false;
+            
+            if( UB_PROBE_ENABLED( exception ) )
+            {
+                UB_PROBE1( exception, e.what() );
+            }
+            
+            {
+                std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+                
+                handlers = this->impl->_exceptionHandlers;
+            }
+            
+            for( const auto & f: handlers )
+            {
+                f( e );
+            }
+        }
+        
+        {
+            std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+            
+            this->impl->_running = false;
+            
+            this->impl->_cv.notify_all();
+        }
+        
+        return success;
+    }
+    
     void Engine::stop( void )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         if( this->impl->_running == false )
         {
@@ -1140,7 +1554,7 @@ namespace UB
     
     void Engine::waitUntilFinished( void ) const
     {
-        std::unique_lock< std::recursive_mutex > l( this->impl->_rmtx );
+        std::unique_lock< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_cv.wait
         (
@@ -1152,21 +1566,112 @@ namespace UB
         );
     }
     
-    Engine::IMPL::IMPL( size_t memory ):
-        _memory( memory ),
+    Engine::IMPL::IMPL( const std::vector< std::pair< uint64_t, uint64_t > > & regions ):
+        _memory( 0 ),
         _mode( Mode::Real ),
+        _bits( 16 ),
+        _cr0( 0 ),
+        _cs( 0 ),
         _uc( nullptr ),
-        _running( false )
-    {
-        this->_switchMode( Mode::Real );
+        _running( false ),
+        _instructions( 0 ),
+        _recorder( nullptr ),
+        _rmtx( "Engine" )
+    {
+        /*
+         * The destructor doesn't run if the constructor throws, so mappings
+         * made before a failure are released here.
+         */
+        try
+        {
+            this->_setup( regions );
+        }
+        catch( ... )
+        {
+            this->_release();
+            
+            throw;
+        }
     }
     
     Engine::IMPL::~IMPL( void )
+    {
+        this->_release();
+    }
+    
+    void Engine::IMPL::_setup( const std::vector< std::pair< uint64_t, uint64_t > > & regions )
+    {
+        uc_err e;
+        
+        /* Reserved up front so recording a mapping can't throw and leak it */
+        this->_regions.reserve( regions.size() );
+        this->_backing.reserve( regions.size() );
+        
+        for( const auto & region: regions )
+        {
+            uint64_t base( region.first & ~0xFFFULL );
+            uint64_t size( ( ( region.first + region.second + 0xFFF ) & ~0xFFFULL ) - base );
+            void   * p;
+            
+            if( region.second == 0 )
+            {
+                continue;
+            }
+            
+            /*
+             * Guest memory is backed by anonymous mappings, so the host only
+             * commits the pages the guest actually touches.
+             */
+            if( ( p = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0 ) ) == MAP_FAILED )
+            {
+                throw std::runtime_error( "Cannot allocate " + std::to_string( size ) + " bytes of guest memory at " + String::toHex( base ) );
+            }
+            
+            this->_regions.push_back( { base, size } );
+            this->_backing.push_back( p );
+            this->_executedPages.push_back( std::vector< bool >( size / 0x1000, false ) );
+            this->_codePages.push_back( std::vector< bool >( size / 0x1000, false ) );
+            
+            this->_memory += size;
+        }
+        
+        /*
+         * One engine serves every CPU mode: translation follows CR0, EFER
+         * and the CS descriptor like on hardware, and the mode seen by the
+         * rest of the emulator is derived from them at block boundaries.
+         * The 16-bit uc mode is what the BIOS needs for real-mode segment
+         * register writes.
+         */
+        if( ( e = uc_open( UC_ARCH_X86, UC_MODE_16, &( this->_uc ) ) ) != UC_ERR_OK )
+        {
+            throw std::runtime_error( uc_strerror( e ) );
+        }
+        
+        for( size_t i = 0; i < this->_regions.size(); i++ )
+        {
+            if( ( e = uc_mem_map_ptr( this->_uc, this->_regions[ i ].first, this->_regions[ i ].second, UC_PROT_ALL, this->_backing[ i ] ) ) != UC_ERR_OK )
+            {
+                throw std::runtime_error( uc_strerror( e ) );
+            }
+        }
+    }
+    
+    void Engine::IMPL::_release( void )
     {
         if( this->_uc != nullptr )
         {
             uc_close( this->_uc );
+            
+            this->_uc = nullptr;
+        }
+        
+        for( size_t i = 0; i < this->_backing.size(); i++ )
+        {
+            munmap( this->_backing[ i ], this->_regions[ i ].second );
         }
+        
+        this->_regions.clear();
+        this->_backing.clear();
     }
     
     void Engine::IMPL::_handleInterrupt( uc_engine * uc, uint32_t i, void * data )
@@ -1184,7 +1689,7 @@ namespace UB
         }
         
         {
-            std::lock_guard< std::recursive_mutex > l( engine->impl->_rmtx );
+            std::lock_guard< RecursiveMutex > l( engine->impl->_rmtx );
             
             handlers = engine->impl->_interruptHandlers;
         }
@@ -1220,8 +1725,10 @@ namespace UB
             throw std::runtime_error( "Fatal internal error: unknown engine" );
         }
         
+        engine->impl->_instructions++;
+        
         {
-            std::lock_guard< std::recursive_mutex > l( engine->impl->_rmtx );
+            std::lock_guard< RecursiveMutex > l( engine->impl->_rmtx );
             
             before        = engine->impl->_beforeInstructionHandlers;
             after         = engine->impl->_afterInstructionHandlers;
@@ -1271,7 +1778,7 @@ namespace UB
         }
         
         {
-            std::lock_guard< std::recursive_mutex > l( engine->impl->_rmtx );
+            std::lock_guard< RecursiveMutex > l( engine->impl->_rmtx );
             
             handlers = engine->impl->_invalidMemoryHandlers;
         }
@@ -1301,7 +1808,7 @@ namespace UB
         }
         
         {
-            std::lock_guard< std::recursive_mutex > l( engine->impl->_rmtx );
+            std::lock_guard< RecursiveMutex > l( engine->impl->_rmtx );
             
             handlers = engine->impl->_validMemoryHandlers;
         }
@@ -1312,17 +1819,179 @@ namespace UB
         }
     }
     
+    void Engine::IMPL::_handlePortOutput( uc_engine * uc, uint32_t port, int size, uint32_t value, void * data )
+    {
+        Engine                                                           * engine;
+        std::vector< std::function< void( uint16_t, size_t, uint32_t ) > > handlers;
+        
+        ( void )uc;
+        
+        engine = static_cast< Engine * >( data );
+        
+        if( engine == nullptr )
+        {
+            throw std::runtime_error( "Fatal internal error: unknown engine" );
+        }
+        
+        {
+            std::lock_guard< RecursiveMutex > l( engine->impl->_rmtx );
+            
+            handlers = engine->impl->_portOutputHandlers;
+        }
+        
+        for( const auto & f: handlers )
+        {
+            f( numeric_cast< uint16_t >( port ), numeric_cast< size_t >( size ), value );
+        }
+    }
+    
+    void Engine::IMPL::_handleBlock( uc_engine * uc, uint64_t address, uint32_t size, void * data )
+    {
+        Engine                                                 * engine;
+        std::vector< std::function< void( uint64_t, size_t ) > > handlers;
+        std::vector< std::function< void( Mode, Mode ) > >       modeHandlers;
+        Mode                                                     previous;
+        Mode                                                     mode;
+        FlightRecorder                                         * recorder;
+        
+        engine = static_cast< Engine * >( data );
+        
+        if( engine == nullptr )
+        {
+            throw std::runtime_error( "Fatal internal error: unknown engine" );
+        }
+        
+        {
+            std::lock_guard< RecursiveMutex > l( engine->impl->_rmtx );
+            
+            engine->impl->_executed( address, size );
+            
+            if( engine->impl->_updateMode( uc, previous ) )
+            {
+                modeHandlers = engine->impl->_modeHandlers;
+            }
+            
+            mode     = engine->impl->_mode;
+            handlers = engine->impl->_blockHandlers;
+        }
+        
+        /* Only the emulation thread writes the recorder's rings, so no lock is needed */
+        if( ( recorder = engine->impl->_recorder.load( std::memory_order_relaxed ) ) != nullptr )
+        {
+            recorder->block( mode, address, size );
+        }
+        
+        /* Mode changes are published before the block, so block handlers decode it in the new mode */
+        if( mode != previous )
+        {
+            UB_PROBE2( mode_switch, static_cast< int >( previous ), static_cast< int >( mode ) );
+            
+            if( Timeline::shared().enabled() )
+            {
+                Timeline::shared().instant( "CPU", "Mode switch", ( mode == Mode::Real ) ? "Real" : ( ( mode == Mode::Protected ) ? "Protected" : "Long" ) );
+            }
+            
+            for( const auto & f: modeHandlers )
+            {
+                f( previous, mode );
+            }
+        }
+        
+        for( const auto & f: handlers )
+        {
+            f( address, size );
+        }
+    }
+    
+    void Engine::IMPL::_handleRangedMemoryAccess( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data )
+    {
+        auto handler( static_cast< std::function< void( MemoryAccess, uint64_t, size_t ) > * >( data ) );
+        
+        ( void )uc;
+        ( void )value;
+        
+        ( *( handler ) )( ( type == UC_MEM_WRITE ) ? MemoryAccess::Write : MemoryAccess::Read, address, static_cast< size_t >( size ) );
+    }
+    
+    void Engine::IMPL::_handleDeviceAccess( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data )
+    {
+        auto                     handler( static_cast< std::function< uint64_t( MemoryAccess, uint64_t, size_t, uint64_t ) > * >( data ) );
+        std::array< uint8_t, 8 > bytes;
+        uint64_t                 v;
+        
+        if( type == UC_MEM_WRITE )
+        {
+            ( *( handler ) )( MemoryAccess::Write, address, static_cast< size_t >( size ), static_cast< uint64_t >( value ) );
+            
+            return;
+        }
+        
+        /*
+         * Read hooks run before the load, so the device value is stored in
+         * the backing page and the guest then reads it from there.
+         */
+        v = ( *( handler ) )( MemoryAccess::Read, address, static_cast< size_t >( size ), 0 );
+        
+        for( size_t i = 0; i < bytes.size(); i++ )
+        {
+            bytes[ i ] = static_cast< uint8_t >( v >> ( i * 8 ) );
+        }
+        
+        uc_mem_write( uc, address, bytes.data(), std::min< size_t >( static_cast< size_t >( size ), bytes.size() ) );
+    }
+    
+    void Engine::IMPL::_handleRangedFetch( uc_engine * uc, uint64_t address, uint32_t size, void * data )
+    {
+        auto handler( static_cast< std::function< void( MemoryAccess, uint64_t, size_t ) > * >( data ) );
+        
+        ( void )uc;
+        
+        ( *( handler ) )( MemoryAccess::Fetch, address, size );
+    }
+    
+    void Engine::IMPL::_handleCodeWrite( uc_engine * uc, uc_mem_type type, uint64_t address, int size, int64_t value, void * data )
+    {
+        IMPL                                             * impl( static_cast< IMPL * >( data ) );
+        std::vector< uint64_t >                            pages;
+        std::vector< std::function< void( uint64_t ) > >   handlers;
+        
+        ( void )uc;
+        ( void )type;
+        ( void )value;
+        
+        {
+            std::lock_guard< RecursiveMutex > l( impl->_rmtx );
+            
+            pages = impl->_invalidate( address, static_cast< size_t >( size ) );
+            
+            if( pages.size() == 0 )
+            {
+                return;
+            }
+            
+            handlers = impl->_codeWriteHandlers;
+        }
+        
+        for( uint64_t page: pages )
+        {
+            for( const auto & f: handlers )
+            {
+                f( page );
+            }
+        }
+    }
+    
     std::vector< uint8_t > Engine::IMPL::_read( size_t address, size_t size )
     {
         uc_err                                  e;
-        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->_rmtx );
         
         if( size == 0 )
         {
             return {};
         }
         
-        if( address + size >= this->_memory )
+        if( this->_mapped( address, size ) == false )
         {
             throw std::runtime_error( "Cannot read from address " + String::toHex( address ) + " - Not enough memory allocated" );
         }
@@ -1341,93 +2010,276 @@ namespace UB
     
     void Engine::IMPL::_write( size_t address, const uint8_t * bytes, size_t size )
     {
-        uc_err                                  e;
-        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+        uc_err                                           e;
+        std::vector< uint64_t >                          pages;
+        std::vector< std::function< void( uint64_t ) > > handlers;
         
         if( size == 0 )
         {
             return;
         }
         
-        if( address >= this->_memory )
         {
-            throw std::runtime_error( "Cannot write to address " + String::toHex( address ) + " - Not enough memory allocated" );
+            std::lock_guard< RecursiveMutex > l( this->_rmtx );
+            
+            if( this->_mapped( address, size ) == false )
+            {
+                throw std::runtime_error( "Cannot write to address " + String::toHex( address ) + " - Not enough memory allocated" );
+            }
+            
+            if( ( e = uc_mem_write( this->_uc, address, bytes, size ) ) != UC_ERR_OK )
+            {
+                throw std::runtime_error( uc_strerror( e ) );
+            }
+            
+            /* uc_mem_write doesn't trigger hooks, so code loaded by the BIOS is invalidated here */
+            pages    = this->_invalidate( address, size );
+            handlers = this->_codeWriteHandlers;
         }
         
-        if( ( e = uc_mem_write( this->_uc, address, bytes, size ) ) != UC_ERR_OK )
+        for( uint64_t page: pages )
         {
-            throw std::runtime_error( uc_strerror( e ) );
+            for( const auto & f: handlers )
+            {
+                f( page );
+            }
         }
     }
     
-    void Engine::IMPL::_switchMode( Mode mode )
+    void Engine::IMPL::_map( uint64_t begin, uint64_t end )
     {
-        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
-        uc_mode                                 m;
-        uc_engine *                             uc;
-        uc_err                                  e;
+        uint64_t base( begin & ~0xFFFULL );
+        uint64_t size( ( ( end | 0xFFFULL ) + 1 ) - base );
+        void   * p;
+        uc_err   e;
         
-        if( mode == Mode::Real )
-        {
-            m = UC_MODE_16;
-        }
-        else if( mode == Mode::Protected )
-        {
-            m = UC_MODE_32;
-        }
-        else if( mode == Mode::Long )
+        for( const auto & region: this->_regions )
         {
-            m = UC_MODE_64;
+            if( base < region.first + region.second && region.first < base + size )
+            {
+                throw std::runtime_error( "Device range " + String::toHex( begin ) + "-" + String::toHex( end ) + " partially overlaps guest memory" );
+            }
         }
-        else
+        
+        if( ( p = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0 ) ) == MAP_FAILED )
         {
-            throw std::runtime_error( "Unsupported CPU mode" );
+            throw std::runtime_error( "Cannot allocate " + std::to_string( size ) + " bytes of device memory at " + String::toHex( base ) );
         }
         
-        if( ( e = uc_open( UC_ARCH_X86, m, &uc ) ) != UC_ERR_OK )
+        if( ( e = uc_mem_map_ptr( this->_uc, base, size, UC_PROT_ALL, p ) ) != UC_ERR_OK )
         {
+            munmap( p, size );
+            
             throw std::runtime_error( uc_strerror( e ) );
         }
         
-        if( this->_memory > 0 )
+        /* Device pages aren't guest RAM, so they don't count in memory() */
+        this->_regions.push_back( { base, size } );
+        this->_backing.push_back( p );
+        this->_executedPages.push_back( std::vector< bool >( size / 0x1000, false ) );
+        this->_codePages.push_back( std::vector< bool >( size / 0x1000, false ) );
+    }
+    
+    void Engine::IMPL::_executed( uint64_t address, size_t size )
+    {
+        for( size_t i = 0; i < this->_regions.size(); i++ )
         {
-            if( ( e = uc_mem_map( uc, 0, this->_memory, UC_PROT_ALL ) ) != UC_ERR_OK )
+            uint64_t begin( this->_regions[ i ].first );
+            uint64_t end( begin + this->_regions[ i ].second );
+            
+            if( address < begin || address >= end )
             {
-                throw std::runtime_error( uc_strerror( e ) );
+                continue;
             }
+            
+            for( uint64_t page = ( address - begin ) / 0x1000; page <= ( std::min( address + std::max< size_t >( size, 1 ), end ) - 1 - begin ) / 0x1000; page++ )
+            {
+                this->_executedPages[ i ][ page ] = true;
+                
+                if( this->_codePages[ i ][ page ] )
+                {
+                    continue;
+                }
+                
+                this->_codePages[ i ][ page ] = true;
+                
+                if( this->_codeWriteHandlers.size() > 0 )
+                {
+                    this->_track( begin + ( page * 0x1000 ) );
+                }
+            }
+            
+            return;
         }
+    }
+    
+    bool Engine::IMPL::_hasExecuted( size_t region, uint64_t address, size_t size ) const
+    {
+        uint64_t begin( this->_regions[ region ].first );
         
-        if( this->_uc != nullptr )
+        for( uint64_t page = ( address - begin ) / 0x1000; page <= ( address + size - 1 - begin ) / 0x1000; page++ )
         {
-            if( this->_memory > 0 )
+            if( this->_executedPages[ region ][ page ] )
             {
-                std::vector< uint8_t > memory( this->_read( 0, this->_memory ) );
-                
-                uc_mem_write( uc, 0, &( memory[ 0 ] ), this->_memory );
+                return true;
             }
+        }
+        
+        return false;
+    }
+    
+    bool Engine::IMPL::_updateMode( uc_engine * uc, Mode & previous )
+    {
+        uint64_t     cr0( 0 );
+        uint16_t     cs( 0 );
+        Mode         mode( Mode::Real );
+        unsigned int bits( 16 );
+        bool         reloaded;
+        
+        previous = this->_mode;
+        
+        /*
+         * Every mode change writes CR0 (PE, or PG which sets EFER.LMA) or
+         * reloads CS (entering 64-bit code), so the rest is only looked
+         * at when one of those two changed since the last block.
+         */
+        if( uc_reg_read( uc, UC_X86_REG_CR0, &cr0 ) != UC_ERR_OK || uc_reg_read( uc, UC_X86_REG_CS, &cs ) != UC_ERR_OK )
+        {
+            return false;
+        }
+        
+        if( cr0 == this->_cr0 && cs == this->_cs )
+        {
+            return false;
+        }
+        
+        reloaded   = cs != this->_cs;
+        this->_cr0 = cr0;
+        this->_cs  = cs;
+        
+        if( ( cr0 & 0x01 ) != 0 )
+        {
+            uc_x86_msr efer;
+            uc_x86_mmr gdtr;
+            uint8_t    descriptor[ 8 ];
+            bool       found;
             
+            efer.rid   = 0xC0000080;
+            efer.value = 0;
+            mode       = Mode::Protected;
+            
+            /*
+             * The code size comes from the cached CS descriptor, which only
+             * changes when CS is reloaded: right after PE is set, the real-mode
+             * segment keeps running 16-bit code until the far jump.
+             */
+            if( reloaded == false )
+            {
+                bits = this->_bits.load( std::memory_order_relaxed );
+                mode = ( bits == 64 ) ? Mode::Long : Mode::Protected;
+            }
+            else
             {
-                uc_context * ctx;
+                /* LDT selectors aren't looked up, their code is taken as 32-bit */
+                found = ( cs & 0x04 ) == 0 && uc_reg_read( uc, UC_X86_REG_GDTR, &gdtr ) == UC_ERR_OK && uc_mem_read( uc, gdtr.base + ( cs & ~0x07u ), descriptor, sizeof( descriptor ) ) == UC_ERR_OK;
                 
-                if( ( e = uc_context_alloc( this->_uc, &ctx ) ) != UC_ERR_OK )
+                /* EFER.LMA with CS.L set runs 64-bit code, otherwise CS.D picks 32 or 16-bit code, in compatibility mode as well */
+                if( found && uc_reg_read( uc, UC_X86_REG_MSR, &efer ) == UC_ERR_OK && ( efer.value & 0x400 ) != 0 && ( descriptor[ 6 ] & 0x20 ) != 0 )
                 {
-                    throw std::runtime_error( uc_strerror( e ) );
+                    mode = Mode::Long;
+                    bits = 64;
                 }
-                
-                if( ( e = uc_context_save( this->_uc, ctx ) ) != UC_ERR_OK )
+                else
                 {
-                    throw std::runtime_error( uc_strerror( e ) );
+                    bits = ( found == false || ( descriptor[ 6 ] & 0x40 ) != 0 ) ? 32 : 16;
                 }
-                
-                if( ( e = uc_context_restore( uc, ctx ) ) != UC_ERR_OK )
+            }
+        }
+        
+        this->_mode = mode;
+        
+        this->_bits.store( bits, std::memory_order_relaxed );
+        
+        return mode != previous;
+    }
+    
+    void Engine::IMPL::_track( uint64_t address )
+    {
+        uint64_t chunk( address & ~static_cast< uint64_t >( 0xFFFF ) );
+        uc_hook  h;
+        uc_err   e;
+        
+        /*
+         * Unicorn walks every write hook whose range matches, so one hook
+         * per 64 KiB of code keeps the hook list short while leaving data
+         * elsewhere unhooked. The bitmap filters writes to data pages that
+         * happen to share a chunk with code.
+         */
+        if( this->_trackedChunks.insert( chunk ).second == false )
+        {
+            return;
+        }
+        
+        if( ( e = uc_hook_add( this->_uc, &h, UC_HOOK_MEM_WRITE, reinterpret_cast< void * >( &IMPL::_handleCodeWrite ), this, chunk, chunk + 0xFFFF ) ) != UC_ERR_OK )
+        {
+            throw std::runtime_error( uc_strerror( e ) );
+        }
+    }
+    
+    std::vector< uint64_t > Engine::IMPL::_invalidate( uint64_t address, size_t size )
+    {
+        std::vector< uint64_t > pages;
+        
+        for( size_t i = 0; i < this->_regions.size(); i++ )
+        {
+            uint64_t begin( this->_regions[ i ].first );
+            uint64_t end( begin + this->_regions[ i ].second );
+            
+            if( address < begin || address >= end )
+            {
+                continue;
+            }
+            
+            /* A page stays clean until it runs again, so consumers hear about it once per change */
+            for( uint64_t page = ( address - begin ) / 0x1000; page <= ( std::min( address + std::max< size_t >( size, 1 ), end ) - 1 - begin ) / 0x1000; page++ )
+            {
+                if( this->_codePages[ i ][ page ] )
                 {
-                    throw std::runtime_error( uc_strerror( e ) );
+                    this->_codePages[ i ][ page ] = false;
+                    
+                    pages.push_back( begin + ( page * 0x1000 ) );
                 }
             }
             
-            uc_close( this->_uc );
+            break;
         }
         
-        this->_uc = uc;
+        return pages;
+    }
+    
+    bool Engine::IMPL::_mapped( size_t address, size_t size ) const
+    {
+        for( const auto & region: this->_regions )
+        {
+            if( address >= region.first && address + size <= region.first + region.second )
+            {
+                return true;
+            }
+        }
+        
+        return false;
+    }
+    
+    bool Engine::IMPL::_special( size_t address, size_t size ) const
+    {
+        for( const auto & range: this->_specialRanges )
+        {
+            if( address <= range.second && range.first < address + size )
+            {
+                return true;
+            }
+        }
+        
+        return false;
     }
 }
@@ -29,11 +29,14 @@
 #include <algorithm>
 #include <cstdint>
 #include <vector>
+#include <utility>
 #include <functional>
 #include "UB/Registers.hpp"
 
 namespace UB
 {
+    class FlightRecorder;
+    
     class Engine
     {
         public:
@@ -45,9 +48,17 @@ namespace UB
                 Long
             };
             
+            enum class MemoryAccess
+            {
+                Read,
+                Write,
+                Fetch
+            };
+            
             static uint64_t getAddress( uint16_t segment, uint16_t offset );
             
             Engine( size_t memory );
+            Engine( const std::vector< std::pair< uint64_t, uint64_t > > & regions );
             ~Engine( void );
             
             Engine( const Engine & o )              = delete;
@@ -55,12 +66,15 @@ namespace UB
             Engine & operator =( const Engine & o ) = delete;
             Engine & operator =( Engine && o )      = delete;
             
-            size_t memory( void ) const;
+            size_t                                         memory( void )  const;
+            std::vector< std::pair< uint64_t, uint64_t > > regions( void ) const;
             
-            Mode mode( void ) const;
-            void mode( Mode mode );
+            Mode         mode( void ) const;
+            unsigned int bits( void ) const;
+            uint64_t     pc( void )   const;
             
             bool cf( void ) const;
+            bool zf( void ) const;
             
             uint8_t  ah(  void ) const;
             uint8_t  al(  void ) const;
@@ -160,6 +174,7 @@ namespace UB
             uint64_t r15(  void ) const;
             
             void cf( bool value );
+            void zf( bool value );
             
             void ah(  uint8_t value );
             void al(  uint8_t value );
@@ -260,7 +275,14 @@ namespace UB
             
             Registers registers( void ) const;
             
-            bool running( void ) const;
+            bool     running( void )      const;
+            uint64_t instructions( void ) const;
+            
+            /*
+             * Taken branches are recorded straight from the block hook,
+             * without the lock or handler copies of onBlock().
+             */
+            void flightRecorder( FlightRecorder * recorder );
             
             void onStart(               const std::function< void( void ) > f );
             void onStop(                const std::function< void( void ) > f );
@@ -270,12 +292,22 @@ namespace UB
             void onValidMemoryAccess(   const std::function< void( uint64_t, size_t ) > handler );
             void beforeInstruction(     const std::function< void( uint64_t, const std::vector< uint8_t > & ) > handler );
             void afterInstruction(      const std::function< void( uint64_t, const Registers &, const std::vector< uint8_t > & ) > handler );
+            void onPortOutput(          const std::function< void( uint16_t, size_t, uint32_t ) > handler );
+            void onBlock(               const std::function< void( uint64_t, size_t ) > handler );
+            void onMemoryAccess(        uint64_t begin, uint64_t end, const std::function< void( MemoryAccess, uint64_t, size_t ) > handler );
+            void onDeviceAccess(        uint64_t begin, uint64_t end, const std::function< uint64_t( MemoryAccess, uint64_t, size_t, uint64_t ) > handler );
+            void onCodeWrite(           const std::function< void( uint64_t ) > handler );
+            void onModeChange(          const std::function< void( Mode, Mode ) > handler );
             
             std::vector< uint8_t > read( size_t address, size_t size );
             void                   write( size_t address, const std::vector< uint8_t > & bytes );
             void                   write( size_t address, const uint8_t * bytes, size_t size );
+            void                   fill( size_t address, size_t size, const std::function< void( uint8_t * ) > & filler );
+            void                   share( size_t address, size_t size, int fd, int64_t offset );
             
             bool start( size_t address );
+            bool execute( size_t instructions );
+            bool execute( size_t instructions, uint64_t until );
             void stop( void );
             void waitUntilFinished( void ) const;
             
@@ -0,0 +1,129 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/ChunkBackend.hpp"
+#include "UB/SHA256.hpp"
+#include "UB/Casts.hpp"
+
+namespace UB
+{
+    namespace FAT
+    {
+        class ChunkBackend::IMPL
+        {
+            public:
+                
+                IMPL( const std::string & manifest );
+                ~IMPL( void );
+                
+                ChunkStore::Manifest _manifest;
+                ChunkStore           _store;
+                std::string          _hash;
+        };
+        
+        ChunkBackend::ChunkBackend( const std::string & manifest ):
+            impl( std::make_unique< IMPL >( manifest ) )
+        {}
+        
+        ChunkBackend::~ChunkBackend( void )
+        {}
+        
+        std::string ChunkBackend::format( void ) const
+        {
+            return "chunks";
+        }
+        
+        uint64_t ChunkBackend::size( void ) const
+        {
+            return this->impl->_manifest.imageSize();
+        }
+        
+        std::string ChunkBackend::hash( void ) const
+        {
+            return this->impl->_hash;
+        }
+        
+        /* The manifest hash already identifies the content, at no cost */
+        std::string ChunkBackend::identity( void ) const
+        {
+            return this->impl->_hash;
+        }
+        
+        void ChunkBackend::read( uint64_t offset, uint8_t * buf, size_t size )
+        {
+            uint64_t chunkSize( this->impl->_manifest.chunkSize() );
+            
+            if( offset > this->size() || size > this->size() - offset )
+            {
+                throw std::runtime_error( "Invalid read - Not enough data available" );
+            }
+            
+            while( size > 0 )
+            {
+                size_t index( numeric_cast< size_t >( offset / chunkSize ) );
+                size_t start( numeric_cast< size_t >( offset % chunkSize ) );
+                auto   chunk( this->impl->_store.chunk( this->impl->_manifest.chunk( index ) ) );
+                size_t n;
+                
+                if( start >= chunk->size() )
+                {
+                    throw std::runtime_error( "Invalid chunk size: " + this->impl->_manifest.chunk( index ) );
+                }
+                
+                n = std::min( size, chunk->size() - start );
+                
+                memcpy( buf, chunk->data() + start, n );
+                
+                buf    += n;
+                offset += n;
+                size   -= n;
+            }
+        }
+        
+        ChunkStore::Manifest ChunkBackend::manifest( void ) const
+        {
+            return this->impl->_manifest;
+        }
+        
+        ChunkBackend::IMPL::IMPL( const std::string & manifest ):
+            _manifest( manifest ),
+            _store(    _manifest.store() )
+        {
+            SHA256 sha;
+            
+            /* The manifest never changes, so hash() and identity() return this instead of rehashing each call */
+            for( size_t i = 0; i < this->_manifest.numberOfChunks(); i++ )
+            {
+                std::string chunk( this->_manifest.chunk( i ) );
+                
+                sha.update( reinterpret_cast< const uint8_t * >( chunk.data() ), chunk.size() );
+            }
+            
+            this->_hash = sha.hexDigest();
+        }
+        
+        ChunkBackend::IMPL::~IMPL( void )
+        {}
+    }
+}
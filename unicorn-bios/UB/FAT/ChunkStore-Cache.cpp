@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/ChunkStore.hpp"
+#include <mutex>
+#include <list>
+#include <map>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class ChunkStore::Cache::IMPL
+        {
+            public:
+                
+                IMPL( void );
+                ~IMPL( void );
+                
+                void _evict( void );
+                
+                typedef std::pair< std::string, std::shared_ptr< const std::vector< uint8_t > > > Item;
+                
+                mutable std::mutex                                 _mtx;
+                size_t                                             _capacity;
+                size_t                                             _size;
+                uint64_t                                           _hits;
+                uint64_t                                           _misses;
+                std::list< Item >                                  _items;
+                std::map< std::string, std::list< Item >::iterator > _index;
+        };
+        
+        ChunkStore::Cache & ChunkStore::Cache::shared( void )
+        {
+            static Cache         * instance;
+            static std::once_flag once;
+            
+            std::call_once
+            (
+                once,
+                [ & ]
+                {
+                    instance = new Cache();
+                }
+            );
+            
+            return *( instance );
+        }
+        
+        ChunkStore::Cache::Cache( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        size_t ChunkStore::Cache::capacity( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_capacity;
+        }
+        
+        size_t ChunkStore::Cache::size( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_size;
+        }
+        
+        uint64_t ChunkStore::Cache::hits( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_hits;
+        }
+        
+        uint64_t ChunkStore::Cache::misses( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_misses;
+        }
+        
+        void ChunkStore::Cache::capacity( size_t bytes )
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            this->impl->_capacity = bytes;
+            
+            this->impl->_evict();
+        }
+        
+        std::shared_ptr< const std::vector< uint8_t > > ChunkStore::Cache::get( const std::string & hash )
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            auto                          it( this->impl->_index.find( hash ) );
+            
+            if( it == this->impl->_index.end() )
+            {
+                this->impl->_misses++;
+                
+                return nullptr;
+            }
+            
+            this->impl->_hits++;
+            this->impl->_items.splice( this->impl->_items.begin(), this->impl->_items, it->second );
+            
+            return it->second->second;
+        }
+        
+        void ChunkStore::Cache::put( const std::string & hash, const std::shared_ptr< const std::vector< uint8_t > > & data )
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            auto                          it( this->impl->_index.find( hash ) );
+            
+            if( data == nullptr )
+            {
+                return;
+            }
+            
+            if( it != this->impl->_index.end() )
+            {
+                this->impl->_items.splice( this->impl->_items.begin(), this->impl->_items, it->second );
+                
+                return;
+            }
+            
+            this->impl->_items.push_front( { hash, data } );
+            
+            this->impl->_index[ hash ] = this->impl->_items.begin();
+            this->impl->_size         += data->size();
+            
+            this->impl->_evict();
+        }
+        
+        ChunkStore::Cache::IMPL::IMPL( void ):
+            _capacity( 64 * 1024 * 1024 ),
+            _size(     0 ),
+            _hits(     0 ),
+            _misses(   0 )
+        {}
+        
+        ChunkStore::Cache::IMPL::~IMPL( void )
+        {}
+        
+        void ChunkStore::Cache::IMPL::_evict( void )
+        {
+            while( this->_size > this->_capacity && this->_items.size() > 1 )
+            {
+                const Item & item( this->_items.back() );
+                
+                this->_size -= item.second->size();
+                
+                this->_index.erase( item.first );
+                this->_items.pop_back();
+            }
+        }
+    }
+}
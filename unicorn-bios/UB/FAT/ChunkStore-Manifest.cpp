@@ -0,0 +1,246 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/ChunkStore.hpp"
+#include "UB/BinaryFileStream.hpp"
+#include "UB/Casts.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class ChunkStore::Manifest::IMPL
+        {
+            public:
+                
+                IMPL( const std::string & path );
+                IMPL( const std::string & store, uint32_t chunkSize, uint64_t imageSize, const std::vector< std::string > & chunks );
+                IMPL( const IMPL & o );
+                ~IMPL( void );
+                
+                static const std::string & _magic( void );
+                
+                std::string                _store;
+                uint32_t                   _chunkSize;
+                uint64_t                   _imageSize;
+                std::vector< std::string > _chunks;
+        };
+        
+        bool ChunkStore::Manifest::isManifest( const std::string & path )
+        {
+            try
+            {
+                BinaryFileStream stream( path );
+                
+                if( stream.availableBytes() < IMPL::_magic().length() )
+                {
+                    return false;
+                }
+                
+                return stream.readString( IMPL::_magic().length() ) == IMPL::_magic();
+            }
+            catch( ... )
+            {
+                return false;
+            }
+        }
+        
+        ChunkStore::Manifest::Manifest( const std::string & path ):
+            impl( std::make_unique< IMPL >( path ) )
+        {}
+        
+        ChunkStore::Manifest::Manifest( const std::string & store, uint32_t chunkSize, uint64_t imageSize, const std::vector< std::string > & chunks ):
+            impl( std::make_unique< IMPL >( store, chunkSize, imageSize, chunks ) )
+        {}
+        
+        ChunkStore::Manifest::Manifest( const Manifest & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        ChunkStore::Manifest::Manifest( Manifest && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        ChunkStore::Manifest::~Manifest( void )
+        {}
+        
+        ChunkStore::Manifest & ChunkStore::Manifest::operator =( Manifest o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        std::string ChunkStore::Manifest::store( void ) const
+        {
+            return this->impl->_store;
+        }
+        
+        uint32_t ChunkStore::Manifest::chunkSize( void ) const
+        {
+            return this->impl->_chunkSize;
+        }
+        
+        uint64_t ChunkStore::Manifest::imageSize( void ) const
+        {
+            return this->impl->_imageSize;
+        }
+        
+        size_t ChunkStore::Manifest::numberOfChunks( void ) const
+        {
+            return this->impl->_chunks.size();
+        }
+        
+        std::string ChunkStore::Manifest::chunk( size_t index ) const
+        {
+            if( index >= this->impl->_chunks.size() )
+            {
+                throw std::runtime_error( "Invalid chunk index: " + std::to_string( index ) );
+            }
+            
+            return this->impl->_chunks[ index ];
+        }
+        
+        void ChunkStore::Manifest::write( const std::string & path ) const
+        {
+            std::ofstream stream( path, std::ios::binary | std::ios::out | std::ios::trunc );
+            
+            auto writeInteger = [ & ]( uint64_t value, size_t size )
+            {
+                for( size_t i = 0; i < size; i++ )
+                {
+                    stream.put( static_cast< char >( ( value >> ( i * 8 ) ) & 0xFF ) );
+                }
+            };
+            
+            stream << IMPL::_magic();
+            
+            writeInteger( 1,                           4 );
+            writeInteger( this->impl->_chunkSize,      4 );
+            writeInteger( this->impl->_imageSize,      8 );
+            writeInteger( this->impl->_chunks.size(),  8 );
+            writeInteger( this->impl->_store.length(), 2 );
+            
+            stream << this->impl->_store;
+            
+            for( const auto & hash: this->impl->_chunks )
+            {
+                if( hash.length() != 64 )
+                {
+                    throw std::runtime_error( "Invalid chunk hash: " + hash );
+                }
+                
+                for( size_t i = 0; i < hash.length(); i += 2 )
+                {
+                    stream.put( static_cast< char >( std::stoul( hash.substr( i, 2 ), nullptr, 16 ) ) );
+                }
+            }
+            
+            if( stream.good() == false )
+            {
+                throw std::runtime_error( "Cannot write manifest: " + path );
+            }
+        }
+        
+        void swap( ChunkStore::Manifest & o1, ChunkStore::Manifest & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        ChunkStore::Manifest::IMPL::IMPL( const std::string & path ):
+            _chunkSize( 0 ),
+            _imageSize( 0 )
+        {
+            BinaryFileStream stream( path );
+            uint64_t         count;
+            
+            if( stream.readString( _magic().length() ) != _magic() )
+            {
+                throw std::runtime_error( "Not a chunk manifest: " + path );
+            }
+            
+            if( stream.readLittleEndianUInt32() != 1 )
+            {
+                throw std::runtime_error( "Unsupported chunk manifest version: " + path );
+            }
+            
+            this->_chunkSize = stream.readLittleEndianUInt32();
+            this->_imageSize = stream.readLittleEndianUInt64();
+            count            = stream.readLittleEndianUInt64();
+            this->_store     = stream.readString( stream.readLittleEndianUInt16() );
+            
+            if( this->_chunkSize == 0 || count != ( this->_imageSize + this->_chunkSize - 1 ) / this->_chunkSize )
+            {
+                throw std::runtime_error( "Invalid chunk manifest: " + path );
+            }
+            
+            if( this->_store.length() > 0 && this->_store[ 0 ] != '/' && path.find( '/' ) != std::string::npos )
+            {
+                this->_store = path.substr( 0, path.rfind( '/' ) + 1 ) + this->_store;
+            }
+            
+            for( uint64_t i = 0; i < count; i++ )
+            {
+                std::vector< uint8_t > digest( stream.read( 32 ) );
+                std::stringstream      ss;
+                
+                for( uint8_t b: digest )
+                {
+                    ss << std::hex << std::setfill( '0' ) << std::setw( 2 ) << static_cast< unsigned int >( b );
+                }
+                
+                this->_chunks.push_back( ss.str() );
+            }
+        }
+        
+        ChunkStore::Manifest::IMPL::IMPL( const std::string & store, uint32_t chunkSize, uint64_t imageSize, const std::vector< std::string > & chunks ):
+            _store(     store ),
+            _chunkSize( chunkSize ),
+            _imageSize( imageSize ),
+            _chunks(    chunks )
+        {}
+        
+        ChunkStore::Manifest::IMPL::IMPL( const IMPL & o ):
+            _store(     o._store ),
+            _chunkSize( o._chunkSize ),
+            _imageSize( o._imageSize ),
+            _chunks(    o._chunks )
+        {}
+        
+        ChunkStore::Manifest::IMPL::~IMPL( void )
+        {}
+        
+        const std::string & ChunkStore::Manifest::IMPL::_magic( void )
+        {
+            static const std::string magic( "UBCHUNKS" );
+            
+            return magic;
+        }
+    }
+}
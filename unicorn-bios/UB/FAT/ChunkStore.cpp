@@ -0,0 +1,236 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/ChunkStore.hpp"
+#include "UB/BinaryFileStream.hpp"
+#include "UB/SHA256.hpp"
+#include "UB/Casts.hpp"
+#include <fstream>
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class ChunkStore::IMPL
+        {
+            public:
+                
+                IMPL( const std::string & directory );
+                IMPL( const IMPL & o );
+                ~IMPL( void );
+                
+                static void _createDirectory( const std::string & path );
+                
+                std::string _directory;
+        };
+        
+        uint32_t ChunkStore::DefaultChunkSize( void )
+        {
+            return 64 * 1024;
+        }
+        
+        ChunkStore::ChunkStore( const std::string & directory ):
+            impl( std::make_unique< IMPL >( directory ) )
+        {}
+        
+        ChunkStore::ChunkStore( const ChunkStore & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        ChunkStore::ChunkStore( ChunkStore && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        ChunkStore::~ChunkStore( void )
+        {}
+        
+        ChunkStore & ChunkStore::operator =( ChunkStore o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        std::string ChunkStore::directory( void ) const
+        {
+            return this->impl->_directory;
+        }
+        
+        std::string ChunkStore::path( const std::string & hash ) const
+        {
+            if( hash.length() < 2 )
+            {
+                throw std::runtime_error( "Invalid chunk hash: " + hash );
+            }
+            
+            return this->impl->_directory + "/" + hash.substr( 0, 2 ) + "/" + hash;
+        }
+        
+        bool ChunkStore::contains( const std::string & hash ) const
+        {
+            struct stat s;
+            
+            return stat( this->path( hash ).c_str(), &s ) == 0;
+        }
+        
+        std::string ChunkStore::add( const std::vector< uint8_t > & chunk )
+        {
+            std::string hash( SHA256::hash( chunk ) );
+            std::string path( this->path( hash ) );
+            std::string tmp( path + ".tmp." + std::to_string( getpid() ) );
+            
+            if( this->contains( hash ) )
+            {
+                return hash;
+            }
+            
+            IMPL::_createDirectory( this->impl->_directory + "/" + hash.substr( 0, 2 ) );
+            
+            {
+                std::ofstream stream( tmp, std::ios::binary | std::ios::out | std::ios::trunc );
+                
+                stream.write( reinterpret_cast< const char * >( chunk.data() ), numeric_cast< std::streamsize >( chunk.size() ) );
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write chunk: " + tmp );
+                }
+            }
+            
+            if( rename( tmp.c_str(), path.c_str() ) != 0 )
+            {
+                unlink( tmp.c_str() );
+                
+                throw std::runtime_error( "Cannot store chunk: " + path );
+            }
+            
+            return hash;
+        }
+        
+        std::shared_ptr< const std::vector< uint8_t > > ChunkStore::chunk( const std::string & hash ) const
+        {
+            std::shared_ptr< const std::vector< uint8_t > > data( Cache::shared().get( hash ) );
+            
+            if( data != nullptr )
+            {
+                return data;
+            }
+            
+            {
+                BinaryFileStream stream( this->path( hash ) );
+                
+                data = std::make_shared< const std::vector< uint8_t > >( stream.readAll() );
+            }
+            
+            if( SHA256::hash( *( data ) ) != hash )
+            {
+                throw std::runtime_error( "Corrupted chunk: " + this->path( hash ) );
+            }
+            
+            Cache::shared().put( hash, data );
+            
+            return data;
+        }
+        
+        ChunkStore::Manifest ChunkStore::import( const std::string & image, uint32_t chunkSize )
+        {
+            BinaryFileStream           stream( image );
+            uint64_t                   size( stream.availableBytes() );
+            std::vector< std::string > chunks;
+            
+            if( chunkSize == 0 || chunkSize % 512 != 0 )
+            {
+                throw std::runtime_error( "Chunk size must be a non-zero multiple of 512 bytes" );
+            }
+            
+            IMPL::_createDirectory( this->impl->_directory );
+            
+            while( stream.hasBytesAvailable() )
+            {
+                size_t n( std::min( static_cast< size_t >( chunkSize ), stream.availableBytes() ) );
+                
+                chunks.push_back( this->add( stream.read( n ) ) );
+            }
+            
+            return Manifest( this->impl->_directory, chunkSize, size, chunks );
+        }
+        
+        void swap( ChunkStore & o1, ChunkStore & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        ChunkStore::IMPL::IMPL( const std::string & directory ):
+            _directory( directory )
+        {
+            while( this->_directory.length() > 1 && this->_directory.back() == '/' )
+            {
+                this->_directory.pop_back();
+            }
+            
+            if( this->_directory.length() == 0 )
+            {
+                throw std::runtime_error( "Invalid chunk store directory" );
+            }
+            
+            if( this->_directory[ 0 ] != '/' )
+            {
+                char cwd[ 4096 ];
+                
+                if( getcwd( cwd, sizeof( cwd ) ) != nullptr )
+                {
+                    this->_directory = std::string( cwd ) + "/" + this->_directory;
+                }
+            }
+        }
+        
+        ChunkStore::IMPL::IMPL( const IMPL & o ):
+            _directory( o._directory )
+        {}
+        
+        ChunkStore::IMPL::~IMPL( void )
+        {}
+        
+        void ChunkStore::IMPL::_createDirectory( const std::string & path )
+        {
+            for( size_t i = 1; i <= path.length(); i++ )
+            {
+                if( i == path.length() || path[ i ] == '/' )
+                {
+                    std::string dir( path.substr( 0, i ) );
+                    
+                    if( mkdir( dir.c_str(), 0755 ) != 0 && errno != EEXIST )
+                    {
+                        throw std::runtime_error( "Cannot create directory: " + dir );
+                    }
+                }
+            }
+        }
+    }
+}
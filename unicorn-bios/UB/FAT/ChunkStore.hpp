@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_FAT_CHUNK_STORE_HPP
+#define UB_FAT_CHUNK_STORE_HPP
+
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class ChunkStore
+        {
+            public:
+                
+                class Manifest
+                {
+                    public:
+                        
+                        static bool isManifest( const std::string & path );
+                        
+                        Manifest( const std::string & path );
+                        Manifest( const std::string & store, uint32_t chunkSize, uint64_t imageSize, const std::vector< std::string > & chunks );
+                        Manifest( const Manifest & o );
+                        Manifest( Manifest && o ) noexcept;
+                        ~Manifest( void );
+                        
+                        Manifest & operator =( Manifest o );
+                        
+                        std::string store( void )                const;
+                        uint32_t    chunkSize( void )            const;
+                        uint64_t    imageSize( void )            const;
+                        size_t      numberOfChunks( void )       const;
+                        std::string chunk( size_t index )        const;
+                        
+                        void write( const std::string & path ) const;
+                        
+                        friend void swap( Manifest & o1, Manifest & o2 );
+                    
+                    private:
+                        
+                        class IMPL;
+                        std::unique_ptr< IMPL > impl;
+                };
+                
+                class Cache
+                {
+                    public:
+                        
+                        static Cache & shared( void );
+                        
+                        Cache( const Cache & o )      = delete;
+                        Cache( Cache && o ) noexcept  = delete;
+                        Cache & operator =( Cache o ) = delete;
+                        
+                        size_t   capacity( void ) const;
+                        size_t   size( void )     const;
+                        uint64_t hits( void )     const;
+                        uint64_t misses( void )   const;
+                        
+                        void capacity( size_t bytes );
+                        
+                        std::shared_ptr< const std::vector< uint8_t > > get( const std::string & hash );
+                        void                                            put( const std::string & hash, const std::shared_ptr< const std::vector< uint8_t > > & data );
+                    
+                    private:
+                        
+                        Cache( void );
+                        
+                        class IMPL;
+                        std::unique_ptr< IMPL > impl;
+                };
+                
+                static uint32_t DefaultChunkSize( void );
+                
+                ChunkStore( const std::string & directory );
+                ChunkStore( const ChunkStore & o );
+                ChunkStore( ChunkStore && o ) noexcept;
+                ~ChunkStore( void );
+                
+                ChunkStore & operator =( ChunkStore o );
+                
+                std::string directory( void )                   const;
+                std::string path( const std::string & hash )     const;
+                bool        contains( const std::string & hash ) const;
+                
+                std::string                                     add( const std::vector< uint8_t > & chunk );
+                std::shared_ptr< const std::vector< uint8_t > > chunk( const std::string & hash ) const;
+                Manifest                                        import( const std::string & image, uint32_t chunkSize = DefaultChunkSize() );
+                
+                friend void swap( ChunkStore & o1, ChunkStore & o2 );
+            
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_FAT_CHUNK_STORE_HPP */
@@ -44,6 +44,8 @@ namespace UB
                 uint16_t _destinationOffset;
                 uint16_t _destinationSegment;
                 uint64_t _logicalBlockAddress;
+                uint64_t _flatDestination;
+                uint64_t _largeNumberOfSectors;
         };
         
         size_t DAP::DataSize( void )
@@ -51,6 +53,11 @@ namespace UB
             return 16;
         }
         
+        size_t DAP::MaxDataSize( void )
+        {
+            return 32;
+        }
+        
         DAP::DAP( void ):
             impl( std::make_unique< IMPL >() )
         {}
@@ -107,6 +114,38 @@ namespace UB
             return this->impl->_logicalBlockAddress;
         }
         
+        uint64_t DAP::flatDestination( void ) const
+        {
+            return this->impl->_flatDestination;
+        }
+        
+        uint64_t DAP::largeNumberOfSectors( void ) const
+        {
+            return this->impl->_largeNumberOfSectors;
+        }
+        
+        uint64_t DAP::destination( void ) const
+        {
+            /* EDD 3.0: a FFFF:FFFF buffer in a 24-byte packet selects the 64-bit flat address */
+            if( this->impl->_size >= 0x18 && this->impl->_destinationSegment == 0xFFFF && this->impl->_destinationOffset == 0xFFFF )
+            {
+                return this->impl->_flatDestination;
+            }
+            
+            return ( static_cast< uint64_t >( this->impl->_destinationSegment ) << 4 ) + this->impl->_destinationOffset;
+        }
+        
+        uint64_t DAP::sectors( void ) const
+        {
+            /* EDD 3.0: a count of FFh in a 32-byte packet selects the 64-bit count */
+            if( this->impl->_size >= 0x20 && this->impl->_numberOfSectors == 0xFF )
+            {
+                return this->impl->_largeNumberOfSectors;
+            }
+            
+            return this->impl->_numberOfSectors;
+        }
+        
         void swap( DAP & o1, DAP & o2 )
         {
             using std::swap;
@@ -115,30 +154,46 @@ namespace UB
         }
         
         DAP::IMPL::IMPL( void ):
-            _size(                0 ),
-            _zero(                0 ),
-            _numberOfSectors(     0 ),
-            _destinationOffset(   0 ),
-            _destinationSegment(  0 ),
-            _logicalBlockAddress( 0 )
+            _size(                 0 ),
+            _zero(                 0 ),
+            _numberOfSectors(      0 ),
+            _destinationOffset(    0 ),
+            _destinationSegment(   0 ),
+            _logicalBlockAddress(  0 ),
+            _flatDestination(      0 ),
+            _largeNumberOfSectors( 0 )
         {}
         
         DAP::IMPL::IMPL( BinaryStream & stream ):
-            _size(                stream.readUInt8() ),
-            _zero(                stream.readUInt8() ),
-            _numberOfSectors(     stream.readLittleEndianUInt16() ),
-            _destinationOffset(   stream.readLittleEndianUInt16() ),
-            _destinationSegment(  stream.readLittleEndianUInt16() ),
-            _logicalBlockAddress( stream.readLittleEndianUInt16() )
-        {}
+            _size(                 stream.readUInt8() ),
+            _zero(                 stream.readUInt8() ),
+            _numberOfSectors(      stream.readLittleEndianUInt16() ),
+            _destinationOffset(    stream.readLittleEndianUInt16() ),
+            _destinationSegment(   stream.readLittleEndianUInt16() ),
+            _logicalBlockAddress(  stream.readLittleEndianUInt64() ),
+            _flatDestination(      0 ),
+            _largeNumberOfSectors( 0 )
+        {
+            if( this->_size >= 0x18 && stream.availableBytes() >= 8 )
+            {
+                this->_flatDestination = stream.readLittleEndianUInt64();
+            }
+            
+            if( this->_size >= 0x20 && stream.availableBytes() >= 8 )
+            {
+                this->_largeNumberOfSectors = stream.readLittleEndianUInt64();
+            }
+        }
         
         DAP::IMPL::IMPL( const IMPL & o ):
-            _size(                o._size ),
-            _zero(                o._zero ),
-            _numberOfSectors(     o._numberOfSectors ),
-            _destinationOffset(   o._destinationOffset ),
-            _destinationSegment(  o._destinationSegment ),
-            _logicalBlockAddress( o._logicalBlockAddress )
+            _size(                 o._size ),
+            _zero(                 o._zero ),
+            _numberOfSectors(      o._numberOfSectors ),
+            _destinationOffset(    o._destinationOffset ),
+            _destinationSegment(   o._destinationSegment ),
+            _logicalBlockAddress(  o._logicalBlockAddress ),
+            _flatDestination(      o._flatDestination ),
+            _largeNumberOfSectors( o._largeNumberOfSectors )
         {}
         
         DAP::IMPL::~IMPL( void )
@@ -39,6 +39,7 @@ namespace UB
             public:
                 
                 static size_t DataSize( void );
+                static size_t MaxDataSize( void );
                 
                 DAP( void );
                 DAP( BinaryStream & stream );
@@ -48,12 +49,17 @@ namespace UB
                 
                 DAP & operator =( DAP o );
                 
-                uint8_t  size( void )                const;
-                uint8_t  zero( void )                const;
-                uint16_t numberOfSectors( void )     const;
-                uint16_t destinationOffset( void )   const;
-                uint16_t destinationSegment( void )  const;
-                uint64_t logicalBlockAddress( void ) const;
+                uint8_t  size( void )                 const;
+                uint8_t  zero( void )                 const;
+                uint16_t numberOfSectors( void )      const;
+                uint16_t destinationOffset( void )    const;
+                uint16_t destinationSegment( void )   const;
+                uint64_t logicalBlockAddress( void )  const;
+                uint64_t flatDestination( void )      const;
+                uint64_t largeNumberOfSectors( void ) const;
+                
+                uint64_t destination( void ) const;
+                uint64_t sectors( void )     const;
                 
                 friend void swap( DAP & o1, DAP & o2 );
                 
@@ -0,0 +1,513 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/FileMap.hpp"
+#include "UB/FAT/MBR.hpp"
+#include <set>
+#include <stdexcept>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class FileMap::IMPL
+        {
+            public:
+                
+                class Object
+                {
+                    public:
+                        
+                        std::string _name;
+                        Kind        _kind;
+                        uint64_t    _size;
+                };
+                
+                class Extent
+                {
+                    public:
+                        
+                        uint64_t _lba;
+                        uint64_t _sectors;
+                        size_t   _object;
+                };
+                
+                IMPL( const Image & image );
+                IMPL( const IMPL & o );
+                ~IMPL( void );
+                
+                uint32_t _next( uint32_t cluster ) const;
+                bool     _isEnd( uint32_t cluster ) const;
+                uint64_t _lba( uint32_t cluster )  const;
+                
+                size_t                 _add( const std::string & name, Kind kind, uint64_t size );
+                void                   _addExtent( uint64_t lba, uint64_t sectors, size_t object );
+                uint64_t               _addChain( uint32_t cluster, size_t object );
+                std::vector< uint8_t > _readChain( uint32_t cluster );
+                void                   _walk( const std::vector< uint8_t > & entries, const std::string & path, unsigned int depth );
+                
+                Image                  _image;
+                std::string            _type;
+                uint64_t               _bytesPerSector;
+                uint64_t               _sectorsPerCluster;
+                uint64_t               _firstDataSector;
+                uint64_t               _totalSectors;
+                uint32_t               _clusters;
+                std::vector< uint8_t > _fat;
+                std::set< uint32_t >   _visited;
+                std::vector< Object >  _objects;
+                std::vector< Extent >  _extents;
+                size_t                 _unallocated;
+        };
+        
+        FileMap::FileMap( const Image & image ):
+            impl( std::make_unique< IMPL >( image ) )
+        {}
+        
+        FileMap::FileMap( const FileMap & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        FileMap::FileMap( FileMap && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        FileMap::~FileMap( void )
+        {}
+        
+        FileMap & FileMap::operator =( FileMap o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        std::string FileMap::type( void ) const
+        {
+            return this->impl->_type;
+        }
+        
+        size_t FileMap::count( void ) const
+        {
+            return this->impl->_objects.size();
+        }
+        
+        std::string FileMap::name( size_t object ) const
+        {
+            return this->impl->_objects.at( object )._name;
+        }
+        
+        FileMap::Kind FileMap::kind( size_t object ) const
+        {
+            return this->impl->_objects.at( object )._kind;
+        }
+        
+        uint64_t FileMap::size( size_t object ) const
+        {
+            return this->impl->_objects.at( object )._size;
+        }
+        
+        std::vector< std::tuple< size_t, uint64_t, uint64_t > > FileMap::find( uint64_t lba, uint64_t sectors ) const
+        {
+            std::vector< std::tuple< size_t, uint64_t, uint64_t > > pieces;
+            const auto                                            & extents( this->impl->_extents );
+            uint64_t                                                end( lba + sectors );
+            auto                                                    it
+            (
+                std::upper_bound
+                (
+                    extents.begin(),
+                    extents.end(),
+                    lba,
+                    []( uint64_t l, const IMPL::Extent & e ) -> bool
+                    {
+                        return l < e._lba;
+                    }
+                )
+            );
+            
+            if( it != extents.begin() && ( it - 1 )->_lba + ( it - 1 )->_sectors > lba )
+            {
+                --it;
+            }
+            
+            /* Gaps between extents belong to no object */
+            while( lba < end )
+            {
+                if( it == extents.end() || it->_lba >= end )
+                {
+                    pieces.push_back( { this->impl->_unallocated, lba, end - lba } );
+                    
+                    break;
+                }
+                
+                if( it->_lba > lba )
+                {
+                    pieces.push_back( { this->impl->_unallocated, lba, it->_lba - lba } );
+                    
+                    lba = it->_lba;
+                }
+                
+                {
+                    uint64_t n( std::min( end, it->_lba + it->_sectors ) - lba );
+                    
+                    pieces.push_back( { it->_object, lba, n } );
+                    
+                    lba += n;
+                    
+                    ++it;
+                }
+            }
+            
+            return pieces;
+        }
+        
+        void swap( FileMap & o1, FileMap & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        FileMap::IMPL::IMPL( const Image & image ):
+            _image(             image ),
+            _bytesPerSector(    0 ),
+            _sectorsPerCluster( 0 ),
+            _firstDataSector(   0 ),
+            _totalSectors(      0 ),
+            _clusters(          0 ),
+            _unallocated(       0 )
+        {
+            MBR                    mbr( image.mbr() );
+            std::vector< uint8_t > boot( this->_image.read( 0, 512 ) );
+            uint64_t               fatSize( mbr.sectorsPerFAT() );
+            uint64_t               rootSectors;
+            uint64_t               rootLBA;
+            uint32_t               rootCluster( 0 );
+            
+            if( mbr.bytesPerSector() == 0 || mbr.sectorsPerCluster() == 0 || mbr.numberOfFATs() == 0 || boot.size() < 512 )
+            {
+                throw std::runtime_error( "Not a FAT volume: " + image.path() );
+            }
+            
+            /* FAT32 keeps its FAT size and root cluster in the extended BPB, which MBR doesn't decode */
+            if( fatSize == 0 )
+            {
+                fatSize     = static_cast< uint64_t >( boot[ 36 ] ) | ( static_cast< uint64_t >( boot[ 37 ] ) << 8 ) | ( static_cast< uint64_t >( boot[ 38 ] ) << 16 ) | ( static_cast< uint64_t >( boot[ 39 ] ) << 24 );
+                rootCluster = static_cast< uint32_t >( boot[ 44 ] ) | ( static_cast< uint32_t >( boot[ 45 ] ) << 8 ) | ( static_cast< uint32_t >( boot[ 46 ] ) << 16 ) | ( static_cast< uint32_t >( boot[ 47 ] ) << 24 );
+            }
+            
+            this->_bytesPerSector    = mbr.bytesPerSector();
+            this->_sectorsPerCluster = mbr.sectorsPerCluster();
+            this->_totalSectors      = ( mbr.totalSectors() != 0 ) ? mbr.totalSectors() : mbr.lbaSectors();
+            rootSectors              = ( ( static_cast< uint64_t >( mbr.maxRootDirEntries() ) * 32 ) + this->_bytesPerSector - 1 ) / this->_bytesPerSector;
+            rootLBA                  = mbr.reservedSectors() + ( mbr.numberOfFATs() * fatSize );
+            this->_firstDataSector   = rootLBA + rootSectors;
+            
+            if( fatSize == 0 || this->_firstDataSector >= this->_totalSectors )
+            {
+                throw std::runtime_error( "Not a FAT volume: " + image.path() );
+            }
+            
+            this->_clusters = static_cast< uint32_t >( ( this->_totalSectors - this->_firstDataSector ) / this->_sectorsPerCluster );
+            this->_type     = ( this->_clusters < 4085 ) ? "FAT12" : ( ( this->_clusters < 65525 ) ? "FAT16" : "FAT32" );
+            this->_fat      = this->_image.read( mbr.reservedSectors() * this->_bytesPerSector, fatSize * this->_bytesPerSector );
+            
+            this->_addExtent( 0, 1, this->_add( "(boot sector)", Kind::BootSector, this->_bytesPerSector ) );
+            
+            if( mbr.reservedSectors() > 1 )
+            {
+                this->_addExtent( 1, mbr.reservedSectors() - 1u, this->_add( "(reserved sectors)", Kind::Reserved, ( mbr.reservedSectors() - 1u ) * this->_bytesPerSector ) );
+            }
+            
+            for( uint64_t i = 0; i < mbr.numberOfFATs(); i++ )
+            {
+                this->_addExtent( mbr.reservedSectors() + ( i * fatSize ), fatSize, this->_add( "(FAT #" + std::to_string( i + 1 ) + ")", Kind::FAT, fatSize * this->_bytesPerSector ) );
+            }
+            
+            if( this->_type == "FAT32" )
+            {
+                size_t root( this->_add( "/", Kind::RootDirectory, 0 ) );
+                
+                this->_objects[ root ]._size = this->_addChain( rootCluster, root );
+                this->_walk( this->_readChain( rootCluster ), "/", 0 );
+            }
+            else
+            {
+                this->_addExtent( rootLBA, rootSectors, this->_add( "/", Kind::RootDirectory, rootSectors * this->_bytesPerSector ) );
+                this->_walk( this->_image.read( rootLBA * this->_bytesPerSector, rootSectors * this->_bytesPerSector ), "/", 0 );
+            }
+            
+            this->_unallocated = this->_add( "(unallocated)", Kind::Unallocated, 0 );
+            
+            std::sort
+            (
+                this->_extents.begin(),
+                this->_extents.end(),
+                []( const Extent & e1, const Extent & e2 ) -> bool
+                {
+                    return e1._lba < e2._lba;
+                }
+            );
+            
+            /* The chain cache is only needed while walking */
+            this->_fat.clear();
+            this->_fat.shrink_to_fit();
+            this->_visited.clear();
+        }
+        
+        FileMap::IMPL::IMPL( const IMPL & o ):
+            _image(             o._image ),
+            _type(              o._type ),
+            _bytesPerSector(    o._bytesPerSector ),
+            _sectorsPerCluster( o._sectorsPerCluster ),
+            _firstDataSector(   o._firstDataSector ),
+            _totalSectors(      o._totalSectors ),
+            _clusters(          o._clusters ),
+            _objects(           o._objects ),
+            _extents(           o._extents ),
+            _unallocated(       o._unallocated )
+        {}
+        
+        FileMap::IMPL::~IMPL( void )
+        {}
+        
+        uint32_t FileMap::IMPL::_next( uint32_t cluster ) const
+        {
+            if( this->_type == "FAT12" )
+            {
+                size_t offset( cluster + ( cluster / 2 ) );
+                
+                if( offset + 1 >= this->_fat.size() )
+                {
+                    return 0xFFF;
+                }
+                
+                uint32_t v( static_cast< uint32_t >( this->_fat[ offset ] ) | ( static_cast< uint32_t >( this->_fat[ offset + 1 ] ) << 8 ) );
+                
+                return ( cluster & 1 ) ? v >> 4 : v & 0xFFF;
+            }
+            else if( this->_type == "FAT16" )
+            {
+                size_t offset( static_cast< size_t >( cluster ) * 2 );
+                
+                if( offset + 1 >= this->_fat.size() )
+                {
+                    return 0xFFFF;
+                }
+                
+                return static_cast< uint32_t >( this->_fat[ offset ] ) | ( static_cast< uint32_t >( this->_fat[ offset + 1 ] ) << 8 );
+            }
+            else
+            {
+                size_t offset( static_cast< size_t >( cluster ) * 4 );
+                
+                if( offset + 3 >= this->_fat.size() )
+                {
+                    return 0x0FFFFFFF;
+                }
+                
+                return
+                (
+                       static_cast< uint32_t >( this->_fat[ offset ] )
+                    | ( static_cast< uint32_t >( this->_fat[ offset + 1 ] ) << 8 )
+                    | ( static_cast< uint32_t >( this->_fat[ offset + 2 ] ) << 16 )
+                    | ( static_cast< uint32_t >( this->_fat[ offset + 3 ] ) << 24 )
+                )
+                & 0x0FFFFFFF;
+            }
+        }
+        
+        bool FileMap::IMPL::_isEnd( uint32_t cluster ) const
+        {
+            /* Free, reserved, bad and end-of-chain markers all end a chain */
+            return cluster < 2 || cluster >= this->_clusters + 2;
+        }
+        
+        uint64_t FileMap::IMPL::_lba( uint32_t cluster ) const
+        {
+            return this->_firstDataSector + ( static_cast< uint64_t >( cluster - 2 ) * this->_sectorsPerCluster );
+        }
+        
+        size_t FileMap::IMPL::_add( const std::string & name, Kind kind, uint64_t size )
+        {
+            this->_objects.push_back( { name, kind, size } );
+            
+            return this->_objects.size() - 1;
+        }
+        
+        void FileMap::IMPL::_addExtent( uint64_t lba, uint64_t sectors, size_t object )
+        {
+            if( sectors == 0 )
+            {
+                return;
+            }
+            
+            if( this->_extents.size() > 0 && this->_extents.back()._object == object && this->_extents.back()._lba + this->_extents.back()._sectors == lba )
+            {
+                this->_extents.back()._sectors += sectors;
+                
+                return;
+            }
+            
+            this->_extents.push_back( { lba, sectors, object } );
+        }
+        
+        uint64_t FileMap::IMPL::_addChain( uint32_t cluster, size_t object )
+        {
+            uint64_t bytes( 0 );
+            
+            /* Each cluster belongs to one object, which also breaks loops in damaged chains */
+            while( this->_isEnd( cluster ) == false && this->_visited.insert( cluster ).second )
+            {
+                this->_addExtent( this->_lba( cluster ), this->_sectorsPerCluster, object );
+                
+                bytes  += this->_sectorsPerCluster * this->_bytesPerSector;
+                cluster = this->_next( cluster );
+            }
+            
+            return bytes;
+        }
+        
+        std::vector< uint8_t > FileMap::IMPL::_readChain( uint32_t cluster )
+        {
+            std::vector< uint8_t > data;
+            std::set< uint32_t >   seen;
+            
+            while( this->_isEnd( cluster ) == false && seen.insert( cluster ).second )
+            {
+                std::vector< uint8_t > bytes( this->_image.read( this->_lba( cluster ) * this->_bytesPerSector, this->_sectorsPerCluster * this->_bytesPerSector ) );
+                
+                data.insert( data.end(), bytes.begin(), bytes.end() );
+                
+                cluster = this->_next( cluster );
+            }
+            
+            return data;
+        }
+        
+        void FileMap::IMPL::_walk( const std::vector< uint8_t > & entries, const std::string & path, unsigned int depth )
+        {
+            std::string longName;
+            
+            if( depth > 32 )
+            {
+                return;
+            }
+            
+            for( size_t i = 0; i + 32 <= entries.size(); i += 32 )
+            {
+                const uint8_t * e( &( entries[ i ] ) );
+                uint8_t         attributes( e[ 11 ] );
+                std::string     name;
+                uint32_t        cluster;
+                uint32_t        size;
+                
+                if( e[ 0 ] == 0x00 )
+                {
+                    break;
+                }
+                
+                if( e[ 0 ] == 0xE5 )
+                {
+                    longName = "";
+                    
+                    continue;
+                }
+                
+                /* Long name entries come in reverse order before their short entry, 13 UCS-2 characters each */
+                if( ( attributes & 0x3F ) == 0x0F )
+                {
+                    static const size_t offsets[] = { 1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30 };
+                    std::string         part;
+                    
+                    for( size_t offset: offsets )
+                    {
+                        uint16_t c( static_cast< uint16_t >( e[ offset ] | ( e[ offset + 1 ] << 8 ) ) );
+                        
+                        if( c == 0x0000 || c == 0xFFFF )
+                        {
+                            break;
+                        }
+                        
+                        part += ( c < 0x80 ) ? static_cast< char >( c ) : '?';
+                    }
+                    
+                    longName = part + longName;
+                    
+                    continue;
+                }
+                
+                if( ( attributes & 0x08 ) != 0 || e[ 0 ] == '.' )
+                {
+                    longName = "";
+                    
+                    continue;
+                }
+                
+                if( longName.length() > 0 )
+                {
+                    name = longName;
+                }
+                else
+                {
+                    std::string base( reinterpret_cast< const char * >( e ), 8 );
+                    std::string extension( reinterpret_cast< const char * >( e ) + 8, 3 );
+                    
+                    base.erase( base.find_last_not_of( ' ' ) + 1 );
+                    extension.erase( extension.find_last_not_of( ' ' ) + 1 );
+                    
+                    name = ( extension.length() > 0 ) ? base + "." + extension : base;
+                }
+                
+                longName = "";
+                cluster  = static_cast< uint32_t >( e[ 26 ] | ( e[ 27 ] << 8 ) );
+                size     = static_cast< uint32_t >( e[ 28 ] | ( e[ 29 ] << 8 ) | ( e[ 30 ] << 16 ) ) | ( static_cast< uint32_t >( e[ 31 ] ) << 24 );
+                
+                if( this->_type == "FAT32" )
+                {
+                    cluster |= static_cast< uint32_t >( e[ 20 ] | ( e[ 21 ] << 8 ) ) << 16;
+                }
+                
+                if( ( attributes & 0x10 ) != 0 )
+                {
+                    if( this->_visited.count( cluster ) != 0 )
+                    {
+                        continue;
+                    }
+                    
+                    size_t directory( this->_add( path + name + "/", Kind::Directory, 0 ) );
+                    
+                    this->_objects[ directory ]._size = this->_addChain( cluster, directory );
+                    
+                    this->_walk( this->_readChain( cluster ), path + name + "/", depth + 1 );
+                }
+                else
+                {
+                    this->_addChain( cluster, this->_add( path + name, Kind::File, size ) );
+                }
+            }
+        }
+    }
+}
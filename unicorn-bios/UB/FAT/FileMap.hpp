@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_FAT_FILE_MAP_HPP
+#define UB_FAT_FILE_MAP_HPP
+
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <tuple>
+#include "UB/FAT/Image.hpp"
+
+namespace UB
+{
+    namespace FAT
+    {
+        /*!
+         * Maps sectors of a FAT12/16/32 volume to what they hold.
+         * 
+         * The directory tree is walked once, following cluster chains from
+         * an in-memory copy of the first FAT, and every object (boot sector,
+         * FATs, directories, files) is stored as a list of contiguous
+         * extents in a table sorted by LBA. Looking up a request is then a
+         * binary search, plus one step per extent it spans. Sectors owned
+         * by nothing are reported as unallocated.
+         */
+        class FileMap
+        {
+            public:
+                
+                enum class Kind
+                {
+                    BootSector,
+                    Reserved,
+                    FAT,
+                    RootDirectory,
+                    Directory,
+                    File,
+                    Unallocated
+                };
+                
+                FileMap( const Image & image );
+                FileMap( const FileMap & o );
+                FileMap( FileMap && o ) noexcept;
+                ~FileMap( void );
+                
+                FileMap & operator =( FileMap o );
+                
+                std::string type( void )          const;
+                size_t      count( void )         const;
+                std::string name( size_t object ) const;
+                Kind        kind( size_t object ) const;
+                uint64_t    size( size_t object ) const;
+                
+                /* Object, first LBA and sector count of each piece of a request */
+                std::vector< std::tuple< size_t, uint64_t, uint64_t > > find( uint64_t lba, uint64_t sectors ) const;
+                
+                friend void swap( FileMap & o1, FileMap & o2 );
+            
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_FAT_FILE_MAP_HPP */
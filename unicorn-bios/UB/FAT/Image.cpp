@@ -24,7 +24,10 @@
 
 #include "UB/FAT/Image.hpp"
 #include "UB/FAT/Functions.hpp"
-#include "UB/BinaryFileStream.hpp"
+#include "UB/FAT/RawBackend.hpp"
+#include "UB/FAT/ChunkBackend.hpp"
+#include "UB/FAT/QCOW2Backend.hpp"
+#include "UB/FAT/VHDBackend.hpp"
 #include "UB/BinaryDataStream.hpp"
 #include "UB/Casts.hpp"
 
@@ -39,9 +42,9 @@ namespace UB
                 IMPL( const std::string & path );
                 IMPL( const IMPL & o );
                 
-                std::string      _path;
-                BinaryDataStream _stream;
-                MBR              _mbr;
+                std::string                _path;
+                std::shared_ptr< Backend > _backend;
+                MBR                        _mbr;
         };
         
         Image::Image( const std::string & path ):
@@ -76,6 +79,26 @@ namespace UB
             return this->impl->_mbr;
         }
         
+        std::string Image::format( void ) const
+        {
+            return this->impl->_backend->format();
+        }
+        
+        uint64_t Image::size( void ) const
+        {
+            return this->impl->_backend->size();
+        }
+        
+        std::string Image::hash( void ) const
+        {
+            return this->impl->_backend->hash();
+        }
+        
+        std::string Image::identity( void ) const
+        {
+            return this->impl->_backend->identity();
+        }
+        
         std::vector< uint8_t > Image::read( uint8_t cylinder, uint8_t head, uint8_t sector, uint8_t sectors )
         {
             uint64_t lba( chsToLBA( this->impl->_mbr, cylinder, sector, head ) );
@@ -85,9 +108,17 @@ namespace UB
         
         std::vector< uint8_t > Image::read( uint64_t offset, uint64_t size )
         {
-            this->impl->_stream.seek( numeric_cast< ssize_t >( offset ), BinaryStream::SeekDirection::Begin );
-            
-            return this->impl->_stream.read( size );
+            return this->impl->_backend->read( offset, numeric_cast< size_t >( size ) );
+        }
+        
+        void Image::read( uint64_t offset, uint8_t * buf, uint64_t size )
+        {
+            this->impl->_backend->read( offset, buf, numeric_cast< size_t >( size ) );
+        }
+        
+        void Image::prefetch( uint64_t offset, uint64_t size ) const
+        {
+            this->impl->_backend->prefetch( offset, numeric_cast< size_t >( size ) );
         }
         
         void swap( Image & o1, Image & o2 )
@@ -100,19 +131,34 @@ namespace UB
         Image::IMPL::IMPL( const std::string & path ):
             _path( path )
         {
-            BinaryFileStream stream( path );
-            
-            this->_stream = stream.readAll();
+            if( ChunkStore::Manifest::isManifest( path ) )
+            {
+                this->_backend = std::make_shared< ChunkBackend >( path );
+            }
+            else if( QCOW2Backend::isQCOW2( path ) )
+            {
+                this->_backend = std::make_shared< QCOW2Backend >( path );
+            }
+            else if( VHDBackend::isVHD( path ) )
+            {
+                this->_backend = std::make_shared< VHDBackend >( path );
+            }
+            else
+            {
+                this->_backend = std::make_shared< RawBackend >( path );
+            }
             
-            stream.seek( 0, BinaryStream::SeekDirection::Begin );
-            
-            this->_mbr = MBR( stream );
+            {
+                BinaryDataStream stream( this->_backend->read( 0, 512 ) );
+                
+                this->_mbr = MBR( stream );
+            }
         }
         
         Image::IMPL::IMPL( const IMPL & o ):
-            _path(   o._path ),
-            _stream( o._stream ),
-            _mbr(    o._mbr )
+            _path(    o._path ),
+            _backend( o._backend ),
+            _mbr(     o._mbr )
         {}
     }
 }
@@ -47,11 +47,17 @@ namespace UB
                 
                 Image & operator =( Image o );
                 
-                std::string path( void ) const;
-                MBR         mbr( void )  const;
+                std::string path( void )     const;
+                MBR         mbr( void )      const;
+                std::string format( void )   const;
+                uint64_t    size( void )     const;
+                std::string hash( void )     const;
+                std::string identity( void ) const;
                 
                 std::vector< uint8_t > read( uint8_t cylinder, uint8_t head, uint8_t sector, uint8_t sectors = 1 );
                 std::vector< uint8_t > read( uint64_t offset, uint64_t size );
+                void                   read( uint64_t offset, uint8_t * buf, uint64_t size );
+                void                   prefetch( uint64_t offset, uint64_t size ) const;
                 
                 friend void swap( Image & o1, Image & o2 );
                 
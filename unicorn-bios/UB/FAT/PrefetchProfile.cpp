@@ -0,0 +1,312 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/PrefetchProfile.hpp"
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <condition_variable>
+#include <cerrno>
+#include <sys/stat.h>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class PrefetchProfile::IMPL
+        {
+            public:
+                
+                IMPL( const std::string & directory, const Image & image );
+                ~IMPL( void );
+                
+                static constexpr size_t MaxWorkers    = 4;
+                static constexpr size_t QueueCapacity = 16;
+                
+                void _load( void );
+                void _produce( const std::vector< std::pair< uint64_t, uint64_t > > & extents );
+                void _consume( void );
+                
+                Image                                          _image;
+                std::string                                    _directory;
+                std::string                                    _path;
+                mutable std::mutex                             _mtx;
+                std::vector< std::pair< uint64_t, uint64_t > > _extents;
+                std::set< std::pair< uint64_t, uint64_t > >    _seen;
+                std::vector< std::thread >                     _threads;
+                std::mutex                                     _queueMtx;
+                std::condition_variable                        _queueCV;
+                std::deque< std::pair< uint64_t, uint64_t > >  _queue;
+                bool                                           _produced;
+                bool                                           _stop;
+        };
+        
+        PrefetchProfile::PrefetchProfile( const std::string & directory, const Image & image ):
+            impl( std::make_unique< IMPL >( directory, image ) )
+        {}
+        
+        PrefetchProfile::~PrefetchProfile( void )
+        {
+            this->stop();
+        }
+        
+        std::string PrefetchProfile::path( void ) const
+        {
+            return this->impl->_path;
+        }
+        
+        bool PrefetchProfile::isEmpty( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_extents.size() == 0;
+        }
+        
+        std::vector< std::pair< uint64_t, uint64_t > > PrefetchProfile::extents( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_extents;
+        }
+        
+        void PrefetchProfile::record( uint64_t offset, uint64_t size )
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            if( this->impl->_seen.insert( { offset, size } ).second )
+            {
+                this->impl->_extents.push_back( { offset, size } );
+            }
+        }
+        
+        void PrefetchProfile::save( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            std::string                   tmp( this->impl->_path + ".tmp" );
+            
+            if( mkdir( this->impl->_directory.c_str(), 0755 ) != 0 && errno != EEXIST )
+            {
+                throw std::runtime_error( "Cannot create directory: " + this->impl->_directory );
+            }
+            
+            {
+                std::ofstream stream( tmp, std::ios::out | std::ios::trunc );
+                
+                stream << "UBPF 1" << std::endl;
+                
+                for( const auto & extent: this->impl->_extents )
+                {
+                    stream << std::hex << extent.first << " " << extent.second << std::endl;
+                }
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write prefetch profile: " + tmp );
+                }
+            }
+            
+            if( rename( tmp.c_str(), this->impl->_path.c_str() ) != 0 )
+            {
+                throw std::runtime_error( "Cannot write prefetch profile: " + this->impl->_path );
+            }
+        }
+        
+        void PrefetchProfile::prefetch( void )
+        {
+            size_t workers( std::min< size_t >( std::max< unsigned int >( std::thread::hardware_concurrency(), 1 ), IMPL::MaxWorkers ) );
+            
+            if( this->impl->_threads.size() > 0 )
+            {
+                return;
+            }
+            
+            {
+                std::lock_guard< std::mutex > l( this->impl->_queueMtx );
+                
+                this->impl->_queue.clear();
+                
+                this->impl->_produced = false;
+                this->impl->_stop     = false;
+            }
+            
+            this->impl->_threads.push_back
+            (
+                std::thread
+                (
+                    [ this, extents = this->extents() ]
+                    {
+                        this->impl->_produce( extents );
+                    }
+                )
+            );
+            
+            for( size_t i = 0; i < workers; i++ )
+            {
+                this->impl->_threads.push_back
+                (
+                    std::thread
+                    (
+                        [ this ]
+                        {
+                            this->impl->_consume();
+                        }
+                    )
+                );
+            }
+        }
+        
+        void PrefetchProfile::stop( void )
+        {
+            {
+                std::lock_guard< std::mutex > l( this->impl->_queueMtx );
+                
+                this->impl->_stop = true;
+            }
+            
+            this->impl->_queueCV.notify_all();
+            
+            for( auto & thread: this->impl->_threads )
+            {
+                thread.join();
+            }
+            
+            this->impl->_threads.clear();
+        }
+        
+        PrefetchProfile::IMPL::IMPL( const std::string & directory, const Image & image ):
+            _image(     image ),
+            _directory( directory ),
+            _path(      directory + "/" + image.identity() + ".prefetch" ),
+            _produced(  false ),
+            _stop(      false )
+        {
+            this->_load();
+        }
+        
+        PrefetchProfile::IMPL::~IMPL( void )
+        {}
+        
+        void PrefetchProfile::IMPL::_load( void )
+        {
+            std::ifstream stream( this->_path );
+            std::string   line;
+            
+            if( stream.good() == false || std::getline( stream, line ).fail() || line != "UBPF 1" )
+            {
+                return;
+            }
+            
+            while( std::getline( stream, line ) )
+            {
+                std::stringstream ss( line );
+                uint64_t          offset;
+                uint64_t          size;
+                
+                if( ss >> std::hex >> offset >> size )
+                {
+                    if( this->_seen.insert( { offset, size } ).second )
+                    {
+                        this->_extents.push_back( { offset, size } );
+                    }
+                }
+            }
+        }
+        
+        /* Feeds extents in profile order, never holding more than QueueCapacity unread */
+        void PrefetchProfile::IMPL::_produce( const std::vector< std::pair< uint64_t, uint64_t > > & extents )
+        {
+            for( const auto & extent: extents )
+            {
+                std::unique_lock< std::mutex > l( this->_queueMtx );
+                
+                this->_queueCV.wait
+                (
+                    l,
+                    [ & ]( void ) -> bool
+                    {
+                        return this->_stop || this->_queue.size() < QueueCapacity;
+                    }
+                );
+                
+                if( this->_stop )
+                {
+                    return;
+                }
+                
+                this->_queue.push_back( extent );
+                this->_queueCV.notify_all();
+            }
+            
+            {
+                std::lock_guard< std::mutex > l( this->_queueMtx );
+                
+                this->_produced = true;
+            }
+            
+            this->_queueCV.notify_all();
+        }
+        
+        void PrefetchProfile::IMPL::_consume( void )
+        {
+            while( true )
+            {
+                std::pair< uint64_t, uint64_t > extent;
+                
+                {
+                    std::unique_lock< std::mutex > l( this->_queueMtx );
+                    
+                    this->_queueCV.wait
+                    (
+                        l,
+                        [ & ]( void ) -> bool
+                        {
+                            return this->_stop || this->_produced || this->_queue.size() > 0;
+                        }
+                    );
+                    
+                    if( this->_stop || this->_queue.size() == 0 )
+                    {
+                        return;
+                    }
+                    
+                    extent = this->_queue.front();
+                    
+                    this->_queue.pop_front();
+                    this->_queueCV.notify_all();
+                }
+                
+                try
+                {
+                    this->_image.prefetch( extent.first, extent.second );
+                }
+                catch( ... )
+                {}
+            }
+        }
+    }
+}
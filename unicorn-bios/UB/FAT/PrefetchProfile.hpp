@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_FAT_PREFETCH_PROFILE_HPP
+#define UB_FAT_PREFETCH_PROFILE_HPP
+
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include "UB/FAT/Image.hpp"
+
+namespace UB
+{
+    namespace FAT
+    {
+        class PrefetchProfile
+        {
+            public:
+                
+                PrefetchProfile( const std::string & directory, const Image & image );
+                ~PrefetchProfile( void );
+                
+                PrefetchProfile( const PrefetchProfile & o )              = delete;
+                PrefetchProfile( PrefetchProfile && o )                   = delete;
+                PrefetchProfile & operator =( const PrefetchProfile & o ) = delete;
+                PrefetchProfile & operator =( PrefetchProfile && o )      = delete;
+                
+                std::string                                     path( void )    const;
+                bool                                            isEmpty( void ) const;
+                std::vector< std::pair< uint64_t, uint64_t > > extents( void ) const;
+                
+                void record( uint64_t offset, uint64_t size );
+                void save( void ) const;
+                void prefetch( void );
+                void stop( void );
+            
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_FAT_PREFETCH_PROFILE_HPP */
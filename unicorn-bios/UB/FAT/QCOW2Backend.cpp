@@ -0,0 +1,357 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/QCOW2Backend.hpp"
+#include "UB/FAT/TableCache.hpp"
+#include "UB/BinaryDataStream.hpp"
+#include "UB/SHA256.hpp"
+#include "UB/Casts.hpp"
+#include <mutex>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class QCOW2Backend::IMPL
+        {
+            public:
+                
+                IMPL( const std::string & path );
+                ~IMPL( void );
+                
+                static constexpr uint64_t OffsetMask     = 0x00FFFFFFFFFFFE00ULL;
+                static constexpr uint64_t CompressedFlag = 1ULL << 62;
+                static constexpr uint64_t ZeroFlag       = 1ULL;
+                
+                void     _read( uint64_t offset, uint8_t * buf, size_t size ) const;
+                uint64_t _resolve( uint64_t offset );
+                
+                std::string             _path;
+                int                     _fd;
+                uint64_t                _size;
+                uint32_t                _clusterBits;
+                uint64_t                _clusterSize;
+                uint64_t                _l2Entries;
+                std::vector< uint64_t > _l1;
+                TableCache              _l2;
+                mutable std::once_flag  _hashOnce;
+                mutable std::string     _hash;
+        };
+        
+        bool QCOW2Backend::isQCOW2( const std::string & path )
+        {
+            uint8_t magic[ 4 ] = { 0, 0, 0, 0 };
+            int     fd( open( path.c_str(), O_RDONLY ) );
+            
+            if( fd < 0 )
+            {
+                return false;
+            }
+            
+            if( pread( fd, magic, sizeof( magic ), 0 ) != sizeof( magic ) )
+            {
+                magic[ 0 ] = 0;
+            }
+            
+            close( fd );
+            
+            return magic[ 0 ] == 'Q' && magic[ 1 ] == 'F' && magic[ 2 ] == 'I' && magic[ 3 ] == 0xFB;
+        }
+        
+        QCOW2Backend::QCOW2Backend( const std::string & path ):
+            impl( std::make_unique< IMPL >( path ) )
+        {}
+        
+        QCOW2Backend::~QCOW2Backend( void )
+        {}
+        
+        std::string QCOW2Backend::format( void ) const
+        {
+            return "qcow2";
+        }
+        
+        uint64_t QCOW2Backend::size( void ) const
+        {
+            return this->impl->_size;
+        }
+        
+        std::string QCOW2Backend::hash( void ) const
+        {
+            std::call_once
+            (
+                this->impl->_hashOnce,
+                [ & ]
+                {
+                    SHA256                 sha;
+                    std::vector< uint8_t > buf( 1024 * 1024 );
+                    ssize_t                n;
+                    uint64_t               offset( 0 );
+                    
+                    while( ( n = pread( this->impl->_fd, buf.data(), buf.size(), numeric_cast< off_t >( offset ) ) ) > 0 )
+                    {
+                        sha.update( buf.data(), static_cast< size_t >( n ) );
+                        
+                        offset += static_cast< uint64_t >( n );
+                    }
+                    
+                    this->impl->_hash = sha.hexDigest();
+                }
+            );
+            
+            return this->impl->_hash;
+        }
+        
+        /*
+         * The header and the L1 table, already in memory: they carry the
+         * virtual size and where every cluster lives, without reading any
+         * guest data. Cheap, unlike hash(), which covers the whole file.
+         */
+        std::string QCOW2Backend::identity( void ) const
+        {
+            SHA256                 sha;
+            std::vector< uint8_t > header( 72, 0 );
+            
+            this->impl->_read( 0, header.data(), header.size() );
+            
+            sha.update( header.data(), header.size() );
+            sha.update( reinterpret_cast< const uint8_t * >( this->impl->_l1.data() ), this->impl->_l1.size() * sizeof( uint64_t ) );
+            
+            return sha.hexDigest();
+        }
+        
+        void QCOW2Backend::read( uint64_t offset, uint8_t * buf, size_t size )
+        {
+            if( offset > this->impl->_size || size > this->impl->_size - offset )
+            {
+                throw std::runtime_error( "Invalid read - Not enough data available" );
+            }
+            
+            while( size > 0 )
+            {
+                uint64_t start( offset & ( this->impl->_clusterSize - 1 ) );
+                size_t   n( numeric_cast< size_t >( std::min< uint64_t >( size, this->impl->_clusterSize - start ) ) );
+                uint64_t host( this->impl->_resolve( offset ) );
+                
+                if( host == 0 )
+                {
+                    memset( buf, 0, n );
+                }
+                else
+                {
+                    this->impl->_read( host + start, buf, n );
+                }
+                
+                buf    += n;
+                offset += n;
+                size   -= n;
+            }
+        }
+        
+        QCOW2Backend::IMPL::IMPL( const std::string & path ):
+            _path(        path ),
+            _fd(          open( path.c_str(), O_RDONLY ) ),
+            _size(        0 ),
+            _clusterBits( 0 ),
+            _clusterSize( 0 ),
+            _l2Entries(   0 )
+        {
+            if( this->_fd < 0 )
+            {
+                throw std::runtime_error( "Cannot open image: " + path );
+            }
+            
+            try
+            {
+                std::vector< uint8_t > header( 104, 0 );
+                uint32_t               version;
+                uint64_t               backingFile;
+                uint32_t               cryptMethod;
+                uint32_t               l1Size;
+                uint64_t               l1Offset;
+                
+                this->_read( 0, header.data(), 72 );
+                
+                {
+                    BinaryDataStream stream( header );
+                    
+                    stream.seek( 4, BinaryStream::SeekDirection::Current );
+                    
+                    version            = stream.readBigEndianUInt32();
+                    backingFile        = stream.readBigEndianUInt64();
+                    stream.seek( 4, BinaryStream::SeekDirection::Current );
+                    this->_clusterBits = stream.readBigEndianUInt32();
+                    this->_size        = stream.readBigEndianUInt64();
+                    cryptMethod        = stream.readBigEndianUInt32();
+                    l1Size             = stream.readBigEndianUInt32();
+                    l1Offset           = stream.readBigEndianUInt64();
+                }
+                
+                if( version != 2 && version != 3 )
+                {
+                    throw std::runtime_error( "Unsupported qcow2 version: " + std::to_string( version ) );
+                }
+                
+                if( version == 3 )
+                {
+                    uint64_t incompatible;
+                    
+                    this->_read( 72, header.data() + 72, 8 );
+                    
+                    {
+                        BinaryDataStream stream( header );
+                        
+                        stream.seek( 72, BinaryStream::SeekDirection::Current );
+                        
+                        incompatible = stream.readBigEndianUInt64();
+                    }
+                    
+                    /* Only the dirty bit is harmless for a read-only reader */
+                    if( ( incompatible & ~1ULL ) != 0 )
+                    {
+                        throw std::runtime_error( "Unsupported qcow2 incompatible features: " + std::to_string( incompatible ) );
+                    }
+                }
+                
+                if( backingFile != 0 )
+                {
+                    throw std::runtime_error( "qcow2 images with a backing file are not supported" );
+                }
+                
+                if( cryptMethod != 0 )
+                {
+                    throw std::runtime_error( "Encrypted qcow2 images are not supported" );
+                }
+                
+                if( this->_clusterBits < 9 || this->_clusterBits > 21 )
+                {
+                    throw std::runtime_error( "Invalid qcow2 cluster size" );
+                }
+                
+                this->_clusterSize = 1ULL << this->_clusterBits;
+                this->_l2Entries   = this->_clusterSize / sizeof( uint64_t );
+                
+                if( l1Size < ( ( this->_size + ( this->_clusterSize * this->_l2Entries ) - 1 ) / ( this->_clusterSize * this->_l2Entries ) ) )
+                {
+                    throw std::runtime_error( "Invalid qcow2 L1 table size" );
+                }
+                
+                {
+                    std::vector< uint8_t > data( numeric_cast< size_t >( l1Size ) * sizeof( uint64_t ) );
+                    
+                    this->_read( l1Offset, data.data(), data.size() );
+                    
+                    {
+                        BinaryDataStream stream( data );
+                        
+                        for( uint32_t i = 0; i < l1Size; i++ )
+                        {
+                            this->_l1.push_back( stream.readBigEndianUInt64() & OffsetMask );
+                        }
+                    }
+                }
+            }
+            catch( ... )
+            {
+                close( this->_fd );
+                
+                throw;
+            }
+        }
+        
+        QCOW2Backend::IMPL::~IMPL( void )
+        {
+            close( this->_fd );
+        }
+        
+        void QCOW2Backend::IMPL::_read( uint64_t offset, uint8_t * buf, size_t size ) const
+        {
+            while( size > 0 )
+            {
+                ssize_t n( pread( this->_fd, buf, size, numeric_cast< off_t >( offset ) ) );
+                
+                if( n <= 0 )
+                {
+                    throw std::runtime_error( "Cannot read from image: " + this->_path );
+                }
+                
+                buf    += n;
+                offset += static_cast< uint64_t >( n );
+                size   -= static_cast< size_t >( n );
+            }
+        }
+        
+        uint64_t QCOW2Backend::IMPL::_resolve( uint64_t offset )
+        {
+            uint64_t          cluster( offset >> this->_clusterBits );
+            uint64_t          l2Offset( this->_l1[ numeric_cast< size_t >( cluster / this->_l2Entries ) ] );
+            uint64_t          entry;
+            TableCache::Table table;
+            
+            if( l2Offset == 0 )
+            {
+                return 0;
+            }
+            
+            if( ( table = this->_l2.get( l2Offset ) ) == nullptr )
+            {
+                std::vector< uint8_t >                     data( numeric_cast< size_t >( this->_clusterSize ) );
+                std::shared_ptr< std::vector< uint64_t > > entries( std::make_shared< std::vector< uint64_t > >() );
+                
+                this->_read( l2Offset, data.data(), data.size() );
+                
+                {
+                    BinaryDataStream stream( data );
+                    
+                    entries->reserve( numeric_cast< size_t >( this->_l2Entries ) );
+                    
+                    for( uint64_t i = 0; i < this->_l2Entries; i++ )
+                    {
+                        entries->push_back( stream.readBigEndianUInt64() );
+                    }
+                }
+                
+                table = entries;
+                
+                this->_l2.put( l2Offset, table );
+            }
+            
+            entry = ( *( table ) )[ numeric_cast< size_t >( cluster % this->_l2Entries ) ];
+            
+            if( ( entry & CompressedFlag ) != 0 )
+            {
+                throw std::runtime_error( "Compressed qcow2 clusters are not supported" );
+            }
+            
+            if( ( entry & ZeroFlag ) != 0 )
+            {
+                return 0;
+            }
+            
+            return entry & OffsetMask;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/RawBackend.hpp"
+#include "UB/BinaryFileStream.hpp"
+#include "UB/SHA256.hpp"
+#include <mutex>
+#include <algorithm>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class RawBackend::IMPL
+        {
+            public:
+                
+                IMPL( const std::string & path );
+                ~IMPL( void );
+                
+                std::vector< uint8_t > _data;
+                mutable std::once_flag _hashOnce;
+                mutable std::string    _hash;
+        };
+        
+        RawBackend::RawBackend( const std::string & path ):
+            impl( std::make_unique< IMPL >( path ) )
+        {}
+        
+        RawBackend::~RawBackend( void )
+        {}
+        
+        std::string RawBackend::format( void ) const
+        {
+            return "raw";
+        }
+        
+        uint64_t RawBackend::size( void ) const
+        {
+            return this->impl->_data.size();
+        }
+        
+        std::string RawBackend::hash( void ) const
+        {
+            std::call_once
+            (
+                this->impl->_hashOnce,
+                [ & ]
+                {
+                    this->impl->_hash = SHA256::hash( this->impl->_data );
+                }
+            );
+            
+            return this->impl->_hash;
+        }
+        
+        /*
+         * The size and the first MiB, where the boot code and file system
+         * tables live. Cheap, unlike hash(), which covers the whole image.
+         */
+        std::string RawBackend::identity( void ) const
+        {
+            SHA256   sha;
+            uint64_t size( this->impl->_data.size() );
+            
+            sha.update( reinterpret_cast< const uint8_t * >( &size ), sizeof( size ) );
+            sha.update( this->impl->_data.data(), std::min< size_t >( this->impl->_data.size(), 1024 * 1024 ) );
+            
+            return sha.hexDigest();
+        }
+        
+        void RawBackend::read( uint64_t offset, uint8_t * buf, size_t size )
+        {
+            if( offset > this->impl->_data.size() || size > this->impl->_data.size() - offset )
+            {
+                throw std::runtime_error( "Invalid read - Not enough data available" );
+            }
+            
+            memcpy( buf, this->impl->_data.data() + offset, size );
+        }
+        
+        void RawBackend::prefetch( uint64_t offset, size_t size )
+        {
+            ( void )offset;
+            ( void )size;
+        }
+        
+        RawBackend::IMPL::IMPL( const std::string & path )
+        {
+            BinaryFileStream stream( path );
+            
+            this->_data = stream.readAll();
+        }
+        
+        RawBackend::IMPL::~IMPL( void )
+        {}
+    }
+}
@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/TableCache.hpp"
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class TableCache::IMPL
+        {
+            public:
+                
+                IMPL( size_t capacity );
+                ~IMPL( void );
+                
+                void _evict( void );
+                
+                typedef std::pair< uint64_t, Table > Item;
+                
+                mutable std::mutex                                          _mtx;
+                size_t                                                      _capacity;
+                size_t                                                      _size;
+                uint64_t                                                    _hits;
+                uint64_t                                                    _misses;
+                std::list< Item >                                           _items;
+                std::unordered_map< uint64_t, std::list< Item >::iterator > _index;
+        };
+        
+        TableCache::TableCache( size_t capacity ):
+            impl( std::make_unique< IMPL >( capacity ) )
+        {}
+        
+        TableCache::~TableCache( void )
+        {}
+        
+        size_t TableCache::capacity( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_capacity;
+        }
+        
+        size_t TableCache::size( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_size;
+        }
+        
+        uint64_t TableCache::hits( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_hits;
+        }
+        
+        uint64_t TableCache::misses( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_misses;
+        }
+        
+        TableCache::Table TableCache::get( uint64_t offset )
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            auto                          it( this->impl->_index.find( offset ) );
+            
+            if( it == this->impl->_index.end() )
+            {
+                this->impl->_misses++;
+                
+                return nullptr;
+            }
+            
+            this->impl->_hits++;
+            this->impl->_items.splice( this->impl->_items.begin(), this->impl->_items, it->second );
+            
+            return it->second->second;
+        }
+        
+        void TableCache::put( uint64_t offset, const Table & table )
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            auto                          it( this->impl->_index.find( offset ) );
+            
+            if( table == nullptr )
+            {
+                return;
+            }
+            
+            if( it != this->impl->_index.end() )
+            {
+                this->impl->_items.splice( this->impl->_items.begin(), this->impl->_items, it->second );
+                
+                return;
+            }
+            
+            this->impl->_items.push_front( { offset, table } );
+            
+            this->impl->_index[ offset ] = this->impl->_items.begin();
+            this->impl->_size           += table->size() * sizeof( uint64_t );
+            
+            this->impl->_evict();
+        }
+        
+        TableCache::IMPL::IMPL( size_t capacity ):
+            _capacity( capacity ),
+            _size(     0 ),
+            _hits(     0 ),
+            _misses(   0 )
+        {}
+        
+        TableCache::IMPL::~IMPL( void )
+        {}
+        
+        void TableCache::IMPL::_evict( void )
+        {
+            while( this->_size > this->_capacity && this->_items.size() > 1 )
+            {
+                const Item & item( this->_items.back() );
+                
+                this->_size -= item.second->size() * sizeof( uint64_t );
+                
+                this->_index.erase( item.first );
+                this->_items.pop_back();
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_FAT_TABLE_CACHE_HPP
+#define UB_FAT_TABLE_CACHE_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace UB
+{
+    namespace FAT
+    {
+        /*!
+         * LRU cache for the translation table pages of sparse image formats
+         * (qcow2 L2 tables, VHD BAT pages), keyed by their offset in the
+         * image file. Entries are decoded to host byte order.
+         */
+        class TableCache
+        {
+            public:
+                
+                typedef std::shared_ptr< const std::vector< uint64_t > > Table;
+                
+                TableCache( size_t capacity = 16 * 1024 * 1024 );
+                ~TableCache( void );
+                
+                TableCache( const TableCache & o )              = delete;
+                TableCache( TableCache && o )                   = delete;
+                TableCache & operator =( const TableCache & o ) = delete;
+                TableCache & operator =( TableCache && o )      = delete;
+                
+                size_t   capacity( void ) const;
+                size_t   size( void )     const;
+                uint64_t hits( void )     const;
+                uint64_t misses( void )   const;
+                
+                Table get( uint64_t offset );
+                void  put( uint64_t offset, const Table & table );
+            
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_FAT_TABLE_CACHE_HPP */
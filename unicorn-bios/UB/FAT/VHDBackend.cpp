@@ -0,0 +1,361 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FAT/VHDBackend.hpp"
+#include "UB/FAT/TableCache.hpp"
+#include "UB/BinaryDataStream.hpp"
+#include "UB/SHA256.hpp"
+#include "UB/Casts.hpp"
+#include <mutex>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class VHDBackend::IMPL
+        {
+            public:
+                
+                enum class Type: uint32_t
+                {
+                    Fixed        = 2,
+                    Dynamic      = 3,
+                    Differencing = 4
+                };
+                
+                IMPL( const std::string & path );
+                ~IMPL( void );
+                
+                static constexpr uint64_t BATPageEntries = 1024;
+                static constexpr uint32_t Unallocated    = 0xFFFFFFFF;
+                
+                static std::vector< uint8_t > _footer( int fd );
+                
+                void     _read( uint64_t offset, uint8_t * buf, size_t size ) const;
+                uint64_t _resolve( uint64_t offset );
+                
+                std::string            _path;
+                int                    _fd;
+                Type                   _type;
+                uint64_t               _size;
+                uint64_t               _batOffset;
+                uint32_t               _batEntries;
+                uint32_t               _blockSize;
+                uint64_t               _bitmapSize;
+                TableCache             _bat;
+                mutable std::once_flag _hashOnce;
+                mutable std::string    _hash;
+        };
+        
+        bool VHDBackend::isVHD( const std::string & path )
+        {
+            int                    fd( open( path.c_str(), O_RDONLY ) );
+            std::vector< uint8_t > footer;
+            
+            if( fd < 0 )
+            {
+                return false;
+            }
+            
+            footer = IMPL::_footer( fd );
+            
+            close( fd );
+            
+            return footer.size() == 512;
+        }
+        
+        VHDBackend::VHDBackend( const std::string & path ):
+            impl( std::make_unique< IMPL >( path ) )
+        {}
+        
+        VHDBackend::~VHDBackend( void )
+        {}
+        
+        std::string VHDBackend::format( void ) const
+        {
+            return ( this->impl->_type == IMPL::Type::Fixed ) ? "vhd-fixed" : "vhd-dynamic";
+        }
+        
+        uint64_t VHDBackend::size( void ) const
+        {
+            return this->impl->_size;
+        }
+        
+        std::string VHDBackend::hash( void ) const
+        {
+            std::call_once
+            (
+                this->impl->_hashOnce,
+                [ & ]
+                {
+                    SHA256                 sha;
+                    std::vector< uint8_t > buf( 1024 * 1024 );
+                    ssize_t                n;
+                    uint64_t               offset( 0 );
+                    
+                    while( ( n = pread( this->impl->_fd, buf.data(), buf.size(), numeric_cast< off_t >( offset ) ) ) > 0 )
+                    {
+                        sha.update( buf.data(), static_cast< size_t >( n ) );
+                        
+                        offset += static_cast< uint64_t >( n );
+                    }
+                    
+                    this->impl->_hash = sha.hexDigest();
+                }
+            );
+            
+            return this->impl->_hash;
+        }
+        
+        /*
+         * The footer holds the disk size, a creation time stamp and a unique
+         * identifier, so it names the image without reading any guest data.
+         * Cheap, unlike hash(), which covers the whole file.
+         */
+        std::string VHDBackend::identity( void ) const
+        {
+            return SHA256::hash( IMPL::_footer( this->impl->_fd ) );
+        }
+        
+        void VHDBackend::read( uint64_t offset, uint8_t * buf, size_t size )
+        {
+            if( offset > this->impl->_size || size > this->impl->_size - offset )
+            {
+                throw std::runtime_error( "Invalid read - Not enough data available" );
+            }
+            
+            if( this->impl->_type == IMPL::Type::Fixed )
+            {
+                this->impl->_read( offset, buf, size );
+                
+                return;
+            }
+            
+            while( size > 0 )
+            {
+                uint64_t start( offset % this->impl->_blockSize );
+                size_t   n( numeric_cast< size_t >( std::min< uint64_t >( size, this->impl->_blockSize - start ) ) );
+                uint64_t host( this->impl->_resolve( offset ) );
+                
+                if( host == 0 )
+                {
+                    memset( buf, 0, n );
+                }
+                else
+                {
+                    this->impl->_read( host + start, buf, n );
+                }
+                
+                buf    += n;
+                offset += n;
+                size   -= n;
+            }
+        }
+        
+        VHDBackend::IMPL::IMPL( const std::string & path ):
+            _path(       path ),
+            _fd(         open( path.c_str(), O_RDONLY ) ),
+            _type(       Type::Fixed ),
+            _size(       0 ),
+            _batOffset(  0 ),
+            _batEntries( 0 ),
+            _blockSize(  0 ),
+            _bitmapSize( 0 )
+        {
+            if( this->_fd < 0 )
+            {
+                throw std::runtime_error( "Cannot open image: " + path );
+            }
+            
+            try
+            {
+                std::vector< uint8_t > footer( _footer( this->_fd ) );
+                uint64_t               dataOffset;
+                
+                if( footer.size() != 512 )
+                {
+                    throw std::runtime_error( "Invalid VHD footer: " + path );
+                }
+                
+                {
+                    BinaryDataStream stream( footer );
+                    
+                    stream.seek( 16, BinaryStream::SeekDirection::Current );
+                    
+                    dataOffset = stream.readBigEndianUInt64();
+                    
+                    stream.seek( 48, BinaryStream::SeekDirection::Begin );
+                    
+                    this->_size = stream.readBigEndianUInt64();
+                    
+                    stream.seek( 4, BinaryStream::SeekDirection::Current );
+                    
+                    this->_type = static_cast< Type >( stream.readBigEndianUInt32() );
+                }
+                
+                if( this->_type == Type::Differencing )
+                {
+                    throw std::runtime_error( "Differencing VHD images are not supported" );
+                }
+                else if( this->_type == Type::Dynamic )
+                {
+                    std::vector< uint8_t > header( 1024 );
+                    
+                    this->_read( dataOffset, header.data(), header.size() );
+                    
+                    {
+                        BinaryDataStream stream( header );
+                        
+                        if( stream.readString( 8 ) != "cxsparse" )
+                        {
+                            throw std::runtime_error( "Invalid VHD dynamic disk header: " + path );
+                        }
+                        
+                        stream.seek( 8, BinaryStream::SeekDirection::Current );
+                        
+                        this->_batOffset  = stream.readBigEndianUInt64();
+                        
+                        stream.seek( 4, BinaryStream::SeekDirection::Current );
+                        
+                        this->_batEntries = stream.readBigEndianUInt32();
+                        this->_blockSize  = stream.readBigEndianUInt32();
+                    }
+                    
+                    if( this->_blockSize < 512 || ( this->_blockSize % 512 ) != 0 )
+                    {
+                        throw std::runtime_error( "Invalid VHD block size" );
+                    }
+                    
+                    if( static_cast< uint64_t >( this->_batEntries ) * this->_blockSize < this->_size )
+                    {
+                        throw std::runtime_error( "Invalid VHD block allocation table size" );
+                    }
+                    
+                    /* Each block starts with a sector bitmap, padded to a sector boundary */
+                    this->_bitmapSize = ( ( ( this->_blockSize / 512 ) + 4095 ) / 4096 ) * 512;
+                }
+                else if( this->_type != Type::Fixed )
+                {
+                    throw std::runtime_error( "Unsupported VHD disk type: " + std::to_string( static_cast< uint32_t >( this->_type ) ) );
+                }
+            }
+            catch( ... )
+            {
+                close( this->_fd );
+                
+                throw;
+            }
+        }
+        
+        VHDBackend::IMPL::~IMPL( void )
+        {
+            close( this->_fd );
+        }
+        
+        std::vector< uint8_t > VHDBackend::IMPL::_footer( int fd )
+        {
+            struct stat            s;
+            std::vector< uint8_t > footer( 512 );
+            
+            if( fstat( fd, &s ) != 0 || s.st_size < 512 )
+            {
+                return {};
+            }
+            
+            /* The footer is 511 bytes long in images made before Virtual PC 2004 */
+            for( off_t size: { 512, 511 } )
+            {
+                if( pread( fd, footer.data(), static_cast< size_t >( size ), s.st_size - size ) == static_cast< ssize_t >( size ) && memcmp( footer.data(), "conectix", 8 ) == 0 )
+                {
+                    return footer;
+                }
+            }
+            
+            return {};
+        }
+        
+        void VHDBackend::IMPL::_read( uint64_t offset, uint8_t * buf, size_t size ) const
+        {
+            while( size > 0 )
+            {
+                ssize_t n( pread( this->_fd, buf, size, numeric_cast< off_t >( offset ) ) );
+                
+                if( n <= 0 )
+                {
+                    throw std::runtime_error( "Cannot read from image: " + this->_path );
+                }
+                
+                buf    += n;
+                offset += static_cast< uint64_t >( n );
+                size   -= static_cast< size_t >( n );
+            }
+        }
+        
+        uint64_t VHDBackend::IMPL::_resolve( uint64_t offset )
+        {
+            uint64_t          block( offset / this->_blockSize );
+            uint64_t          page( this->_batOffset + ( ( block / BATPageEntries ) * BATPageEntries * sizeof( uint32_t ) ) );
+            uint64_t          entry;
+            TableCache::Table table;
+            
+            if( ( table = this->_bat.get( page ) ) == nullptr )
+            {
+                uint64_t                                   first( ( block / BATPageEntries ) * BATPageEntries );
+                uint64_t                                   count( std::min< uint64_t >( BATPageEntries, this->_batEntries - first ) );
+                std::vector< uint8_t >                     data( numeric_cast< size_t >( count * sizeof( uint32_t ) ) );
+                std::shared_ptr< std::vector< uint64_t > > entries( std::make_shared< std::vector< uint64_t > >() );
+                
+                this->_read( page, data.data(), data.size() );
+                
+                {
+                    BinaryDataStream stream( data );
+                    
+                    entries->reserve( numeric_cast< size_t >( count ) );
+                    
+                    for( uint64_t i = 0; i < count; i++ )
+                    {
+                        entries->push_back( stream.readBigEndianUInt32() );
+                    }
+                }
+                
+                table = entries;
+                
+                this->_bat.put( page, table );
+            }
+            
+            entry = ( *( table ) )[ numeric_cast< size_t >( block % BATPageEntries ) ];
+            
+            if( entry == Unallocated )
+            {
+                return 0;
+            }
+            
+            return ( entry * 512 ) + this->_bitmapSize;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_FAT_VHD_BACKEND_HPP
+#define UB_FAT_VHD_BACKEND_HPP
+
+#include "UB/FAT/Backend.hpp"
+#include <memory>
+#include <algorithm>
+
+namespace UB
+{
+    namespace FAT
+    {
+        class VHDBackend: public Backend
+        {
+            public:
+                
+                static bool isVHD( const std::string & path );
+                
+                VHDBackend( const std::string & path );
+                
+                virtual ~VHDBackend( void );
+                
+                VHDBackend( const VHDBackend & o )              = delete;
+                VHDBackend( VHDBackend && o )                   = delete;
+                VHDBackend & operator =( const VHDBackend & o ) = delete;
+                VHDBackend & operator =( VHDBackend && o )      = delete;
+                
+                using Backend::read;
+                
+                std::string format( void )                                const override;
+                uint64_t    size( void )                                  const override;
+                std::string hash( void )                                  const override;
+                std::string identity( void )                              const override;
+                void        read( uint64_t offset, uint8_t * buf, size_t size ) override;
+            
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* UB_FAT_VHD_BACKEND_HPP */
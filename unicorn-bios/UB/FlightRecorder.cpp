@@ -0,0 +1,272 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/FlightRecorder.hpp"
+#include "UB/String.hpp"
+#include <array>
+#include <atomic>
+#include <vector>
+#include <sstream>
+#include <cctype>
+
+namespace UB
+{
+    class FlightRecorder::IMPL
+    {
+        public:
+            
+            template< typename _T_, size_t _N_ >
+            class Ring
+            {
+                public:
+                    
+                    Ring( void ):
+                        _count( 0 )
+                    {}
+                    
+                    void push( const _T_ & item )
+                    {
+                        uint64_t count( this->_count.load( std::memory_order_relaxed ) );
+                        
+                        this->_items[ count % _N_ ] = item;
+                        
+                        this->_count.store( count + 1, std::memory_order_release );
+                    }
+                    
+                    std::vector< _T_ > items( void ) const
+                    {
+                        std::vector< _T_ > items;
+                        uint64_t           count( this->_count.load( std::memory_order_acquire ) );
+                        uint64_t           first( ( count > _N_ ) ? count - _N_ : 0 );
+                        
+                        for( uint64_t i = first; i < count; i++ )
+                        {
+                            items.push_back( this->_items[ i % _N_ ] );
+                        }
+                        
+                        return items;
+                    }
+                    
+                    std::array< _T_, _N_ >  _items;
+                    std::atomic< uint64_t > _count;
+            };
+            
+            class Branch
+            {
+                public:
+                    
+                    uint64_t _from;
+                    uint64_t _to;
+                    uint32_t _size;
+                    uint8_t  _mode;
+            };
+            
+            class Interrupt
+            {
+                public:
+                    
+                    uint64_t                  _instructions;
+                    uint64_t                  _address;
+                    uint32_t                  _vector;
+                    std::array< uint16_t, 8 > _registers;
+            };
+            
+            class DiskRead
+            {
+                public:
+                    
+                    uint64_t _instructions;
+                    uint64_t _lba;
+                    uint64_t _sectors;
+                    uint64_t _destination;
+                    uint8_t  _drive;
+                    bool     _success;
+            };
+            
+            IMPL( void );
+            ~IMPL( void );
+            
+            uint64_t                _lastBlock;
+            uint32_t                _lastSize;
+            Ring< Branch,    4096 > _branches;
+            Ring< Interrupt, 256 >  _interrupts;
+            Ring< DiskRead,  64 >   _diskReads;
+            Ring< uint8_t,   1024 > _output;
+    };
+    
+    FlightRecorder::FlightRecorder( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    FlightRecorder::~FlightRecorder( void )
+    {}
+    
+    void FlightRecorder::block( Engine::Mode mode, uint64_t address, size_t size )
+    {
+        uint64_t from( this->impl->_lastBlock );
+        uint32_t fromSize( this->impl->_lastSize );
+        
+        this->impl->_lastBlock = address;
+        this->impl->_lastSize  = static_cast< uint32_t >( size );
+        
+        if( fromSize == 0 || from + fromSize == address )
+        {
+            return;
+        }
+        
+        this->impl->_branches.push( { from, address, fromSize, static_cast< uint8_t >( mode ) } );
+    }
+    
+    void FlightRecorder::interrupt( uint32_t vector, const Engine & engine )
+    {
+        IMPL::Interrupt i;
+        
+        i._instructions = engine.instructions();
+        i._address      = Engine::getAddress( engine.cs(), engine.ip() );
+        i._vector       = vector;
+        i._registers    =
+        {
+            {
+                engine.ax(),
+                engine.bx(),
+                engine.cx(),
+                engine.dx(),
+                engine.si(),
+                engine.di(),
+                engine.ds(),
+                engine.es()
+            }
+        };
+        
+        this->impl->_interrupts.push( i );
+    }
+    
+    void FlightRecorder::diskRead( const BIOS::DiskAccess & access )
+    {
+        IMPL::DiskRead d;
+        
+        d._instructions = access.instructions();
+        d._lba          = access.lba();
+        d._sectors      = access.sectors();
+        d._destination  = access.destination();
+        d._drive        = access.drive();
+        d._success      = access.success();
+        
+        this->impl->_diskReads.push( d );
+    }
+    
+    void FlightRecorder::output( uint8_t c )
+    {
+        this->impl->_output.push( c );
+    }
+    
+    std::string FlightRecorder::dump( const std::string & reason ) const
+    {
+        std::stringstream ss;
+        auto              branches( this->impl->_branches.items() );
+        auto              interrupts( this->impl->_interrupts.items() );
+        auto              diskReads( this->impl->_diskReads.items() );
+        auto              output( this->impl->_output.items() );
+        
+        ss << "Flight recorder: " << reason << std::endl
+           << std::endl
+           << "    Taken branches (last " << branches.size() << ", oldest first):" << std::endl
+           << std::endl;
+        
+        for( const auto & b: branches )
+        {
+            ss << "        " << String::toHex( b._from ) << " (+" << b._size << ") -> " << String::toHex( b._to )
+               << ( ( b._mode == static_cast< uint8_t >( Engine::Mode::Real ) ) ? "" : ( ( b._mode == static_cast< uint8_t >( Engine::Mode::Protected ) ) ? " [32-bit]" : " [64-bit]" ) )
+               << std::endl;
+        }
+        
+        ss << std::endl
+           << "    Interrupts (last " << interrupts.size() << ", oldest first):" << std::endl
+           << std::endl;
+        
+        for( const auto & i: interrupts )
+        {
+            static const char * names[] = { "AX", "BX", "CX", "DX", "SI", "DI", "DS", "ES" };
+            
+            ss << "        #" << i._instructions << " INT " << String::toHex( static_cast< uint8_t >( i._vector ) ) << " at " << String::toHex( i._address ) << ":";
+            
+            for( size_t j = 0; j < i._registers.size(); j++ )
+            {
+                ss << " " << names[ j ] << "=" << String::toHex( i._registers[ j ] );
+            }
+            
+            ss << std::endl;
+        }
+        
+        ss << std::endl
+           << "    Disk reads (last " << diskReads.size() << ", oldest first):" << std::endl
+           << std::endl;
+        
+        for( const auto & d: diskReads )
+        {
+            ss << "        #" << d._instructions
+               << " drive " << String::toHex( d._drive )
+               << " LBA "   << d._lba
+               << " x "     << d._sectors
+               << " -> "    << String::toHex( d._destination )
+               << ( ( d._success ) ? "" : " (failed)" )
+               << std::endl;
+        }
+        
+        ss << std::endl
+           << "    Output (last " << output.size() << " bytes):" << std::endl
+           << std::endl
+           << "        ";
+        
+        for( const auto & o: output )
+        {
+            char c( static_cast< char >( o ) );
+            
+            if( c == '\n' )
+            {
+                ss << std::endl << "        ";
+            }
+            else if( std::isprint( c ) )
+            {
+                ss << c;
+            }
+            else if( c != '\r' )
+            {
+                ss << ".";
+            }
+        }
+        
+        ss << std::endl;
+        
+        return ss.str();
+    }
+    
+    FlightRecorder::IMPL::IMPL( void ):
+        _lastBlock( 0 ),
+        _lastSize(  0 )
+    {}
+    
+    FlightRecorder::IMPL::~IMPL( void )
+    {}
+}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_FLIGHT_RECORDER_HPP
+#define UB_FLIGHT_RECORDER_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include "UB/Engine.hpp"
+#include "UB/BIOS/DiskAccess.hpp"
+
+namespace UB
+{
+    /*!
+     * Always-on history of the most recent guest events, dumped when the
+     * emulation dies.
+     * 
+     * Taken branches (block entries that are not a fall-through from the
+     * previous block), interrupts with their register arguments, disk reads
+     * and output bytes each go to a fixed-size ring allocated once at
+     * construction, so recording never allocates. Each ring has a single
+     * writer, the emulation thread, and takes no lock. Dumps happen on that
+     * thread (faults) or once the engine has stopped (SIGINT).
+     */
+    class FlightRecorder
+    {
+        public:
+            
+            FlightRecorder( void );
+            ~FlightRecorder( void );
+            
+            FlightRecorder( const FlightRecorder & o )              = delete;
+            FlightRecorder( FlightRecorder && o )                   = delete;
+            FlightRecorder & operator =( const FlightRecorder & o ) = delete;
+            FlightRecorder & operator =( FlightRecorder && o )      = delete;
+            
+            void block( Engine::Mode mode, uint64_t address, size_t size );
+            void interrupt( uint32_t vector, const Engine & engine );
+            void diskRead( const BIOS::DiskAccess & access );
+            void output( uint8_t c );
+            
+            std::string dump( const std::string & reason ) const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_FLIGHT_RECORDER_HPP */
@@ -0,0 +1,266 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/HostProfile.hpp"
+#include "UB/PerfCounters.hpp"
+#include "UB/String.hpp"
+#include <map>
+#include <vector>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+
+namespace UB
+{
+    class HostProfile::IMPL
+    {
+        public:
+            
+            enum class Kind
+            {
+                None,
+                Guest,
+                BIOS,
+                Dispatch
+            };
+            
+            class Totals
+            {
+                public:
+                    
+                    Totals( void );
+                    
+                    PerfCounters::Values _values;
+                    uint64_t             _samples;
+            };
+            
+            IMPL( uint64_t granularity );
+            ~IMPL( void );
+            
+            static void _add( Totals & totals, const PerfCounters::Values & delta );
+            static void _print( std::stringstream & ss, const PerfCounters & counters, const std::string & title, const std::map< std::string, Totals > & totals, size_t max, uint64_t total );
+            
+            void _sample( Kind kind, uint64_t key );
+            
+            uint64_t                        _granularity;
+            std::unique_ptr< PerfCounters > _counters;
+            PerfCounters::Values            _last;
+            Kind                            _kind;
+            uint64_t                        _key;
+            std::map< uint64_t, Totals >    _ranges;
+            std::map< uint64_t, Totals >    _vectors;
+            std::map< std::string, Totals > _categories;
+            mutable std::mutex              _mtx;
+    };
+    
+    HostProfile::HostProfile( uint64_t granularity ):
+        impl( std::make_unique< IMPL >( granularity ) )
+    {}
+    
+    HostProfile::~HostProfile( void )
+    {}
+    
+    void HostProfile::interrupt( uint32_t vector )
+    {
+        this->impl->_sample( IMPL::Kind::BIOS, vector );
+    }
+    
+    void HostProfile::interruptReturn( uint32_t vector )
+    {
+        ( void )vector;
+        
+        this->impl->_sample( IMPL::Kind::Dispatch, 0 );
+    }
+    
+    void HostProfile::block( uint64_t address )
+    {
+        this->impl->_sample( IMPL::Kind::Guest, address - ( address % this->impl->_granularity ) );
+    }
+    
+    std::string HostProfile::report( size_t top ) const
+    {
+        std::lock_guard< std::mutex >         l( this->impl->_mtx );
+        std::stringstream                     ss;
+        std::map< std::string, IMPL::Totals > vectors;
+        std::map< std::string, IMPL::Totals > ranges;
+        uint64_t                              total( 0 );
+        
+        if( this->impl->_counters == nullptr )
+        {
+            return "Host profile: no samples\n";
+        }
+        
+        for( const auto & p: this->impl->_categories )
+        {
+            total += p.second._values[ static_cast< size_t >( PerfCounters::Counter::TaskClock ) ];
+        }
+        
+        for( const auto & p: this->impl->_vectors )
+        {
+            vectors[ "INT " + String::toHex( static_cast< uint8_t >( p.first ) ) ] = p.second;
+        }
+        
+        for( const auto & p: this->impl->_ranges )
+        {
+            ranges[ String::toHex( p.first ) + "-" + String::toHex( p.first + ( this->impl->_granularity - 1 ) ) ] = p.second;
+        }
+        
+        ss << "Host profile: "
+           << std::fixed << std::setprecision( 2 ) << static_cast< double >( total ) / 1000000.0 << " ms of emulation thread time, "
+           << "counters from " << this->impl->_counters->source()
+           << std::endl;
+        
+        IMPL::_print( ss, *( this->impl->_counters ), "Categories", this->impl->_categories, this->impl->_categories.size(), total );
+        IMPL::_print( ss, *( this->impl->_counters ), "BIOS vectors", vectors, vectors.size(), total );
+        IMPL::_print( ss, *( this->impl->_counters ), "Guest ranges (top " + std::to_string( top ) + ")", ranges, top, total );
+        
+        return ss.str();
+    }
+    
+    HostProfile::IMPL::Totals::Totals( void ):
+        _samples( 0 )
+    {
+        this->_values.fill( 0 );
+    }
+    
+    HostProfile::IMPL::IMPL( uint64_t granularity ):
+        _granularity( std::max< uint64_t >( granularity, 1 ) ),
+        _kind(        Kind::None ),
+        _key(         0 )
+    {
+        this->_last.fill( 0 );
+    }
+    
+    HostProfile::IMPL::~IMPL( void )
+    {}
+    
+    void HostProfile::IMPL::_add( Totals & totals, const PerfCounters::Values & delta )
+    {
+        for( size_t i = 0; i < delta.size(); i++ )
+        {
+            totals._values[ i ] += delta[ i ];
+        }
+        
+        totals._samples++;
+    }
+    
+    void HostProfile::IMPL::_print( std::stringstream & ss, const PerfCounters & counters, const std::string & title, const std::map< std::string, Totals > & totals, size_t max, uint64_t total )
+    {
+        std::vector< std::pair< std::string, Totals > > sorted( totals.begin(), totals.end() );
+        size_t                                          clock( static_cast< size_t >( PerfCounters::Counter::TaskClock ) );
+        size_t                                          switches( static_cast< size_t >( PerfCounters::Counter::ContextSwitches ) );
+        size_t                                          cycles( static_cast< size_t >( PerfCounters::Counter::Cycles ) );
+        size_t                                          instructions( static_cast< size_t >( PerfCounters::Counter::Instructions ) );
+        bool                                            hardware( counters.available( PerfCounters::Counter::Cycles ) && counters.available( PerfCounters::Counter::Instructions ) );
+        
+        std::sort
+        (
+            sorted.begin(),
+            sorted.end(),
+            [ = ]( const std::pair< std::string, Totals > & o1, const std::pair< std::string, Totals > & o2 ) -> bool
+            {
+                return ( o1.second._values[ clock ] == o2.second._values[ clock ] ) ? o1.first < o2.first : o1.second._values[ clock ] > o2.second._values[ clock ];
+            }
+        );
+        
+        ss << std::endl << "    " << title << ":" << std::endl << std::endl
+           << "        "
+           << std::left  << std::setw( 40 ) << ""
+           << std::right << std::setw( 12 ) << "task-clock"
+           << std::setw( 9 )  << "share"
+           << std::setw( 12 ) << "samples"
+           << std::setw( 10 ) << "ctx-sw";
+        
+        if( hardware )
+        {
+            ss << std::setw( 16 ) << "cycles"
+               << std::setw( 16 ) << "instructions"
+               << std::setw( 8 )  << "IPC";
+        }
+        
+        ss << std::endl;
+        
+        for( size_t i = 0; i < sorted.size() && i < max; i++ )
+        {
+            const PerfCounters::Values & values( sorted[ i ].second._values );
+            
+            ss << "        "
+               << std::left  << std::setw( 40 ) << sorted[ i ].first
+               << std::right << std::fixed << std::setprecision( 2 )
+               << std::setw( 9 )  << static_cast< double >( values[ clock ] ) / 1000000.0 << " ms"
+               << std::setw( 8 )  << ( ( total > 0 ) ? ( static_cast< double >( values[ clock ] ) * 100.0 ) / static_cast< double >( total ) : 0.0 ) << "%"
+               << std::setw( 12 ) << sorted[ i ].second._samples
+               << std::setw( 10 ) << values[ switches ];
+            
+            if( hardware )
+            {
+                ss << std::setw( 16 ) << values[ cycles ]
+                   << std::setw( 16 ) << values[ instructions ]
+                   << std::setw( 8 )  << ( ( values[ cycles ] > 0 ) ? static_cast< double >( values[ instructions ] ) / static_cast< double >( values[ cycles ] ) : 0.0 );
+            }
+            
+            ss << std::endl;
+        }
+    }
+    
+    void HostProfile::IMPL::_sample( Kind kind, uint64_t key )
+    {
+        std::lock_guard< std::mutex > l( this->_mtx );
+        PerfCounters::Values          now;
+        PerfCounters::Values          delta;
+        
+        /* Counters are per-thread, so they are opened by the first sample, on the emulation thread */
+        if( this->_counters == nullptr )
+        {
+            this->_counters = std::make_unique< PerfCounters >();
+            this->_last     = this->_counters->read();
+        }
+        
+        now = this->_counters->read();
+        
+        for( size_t i = 0; i < now.size(); i++ )
+        {
+            delta[ i ] = ( now[ i ] >= this->_last[ i ] ) ? now[ i ] - this->_last[ i ] : 0;
+        }
+        
+        if( this->_kind == Kind::Guest )
+        {
+            _add( this->_categories[ "Guest code and hooks" ], delta );
+            _add( this->_ranges[ this->_key ], delta );
+        }
+        else if( this->_kind == Kind::BIOS )
+        {
+            _add( this->_categories[ "BIOS services" ], delta );
+            _add( this->_vectors[ this->_key ], delta );
+        }
+        else if( this->_kind == Kind::Dispatch )
+        {
+            _add( this->_categories[ "Interrupt return and dispatch" ], delta );
+        }
+        
+        this->_last = now;
+        this->_kind = kind;
+        this->_key  = key;
+    }
+}
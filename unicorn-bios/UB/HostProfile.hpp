@@ -0,0 +1,66 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_HOST_PROFILE_HPP
+#define UB_HOST_PROFILE_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace UB
+{
+    /*!
+     * Attributes host counter deltas on the emulation thread to what the
+     * emulator was doing at the time: a guest address range (translated
+     * code and the hooks it triggers), a BIOS interrupt service, or the
+     * dispatch back into guest code after a service returns.
+     */
+    class HostProfile
+    {
+        public:
+            
+            HostProfile( uint64_t granularity = 0x1000 );
+            ~HostProfile( void );
+            
+            HostProfile( const HostProfile & o )              = delete;
+            HostProfile( HostProfile && o )                   = delete;
+            HostProfile & operator =( const HostProfile & o ) = delete;
+            HostProfile & operator =( HostProfile && o )      = delete;
+            
+            void interrupt( uint32_t vector );
+            void interruptReturn( uint32_t vector );
+            void block( uint64_t address );
+            
+            std::string report( size_t top = 20 ) const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_HOST_PROFILE_HPP */
@@ -0,0 +1,229 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/IOTrace.hpp"
+#include "UB/BinaryFileStream.hpp"
+#include "UB/Casts.hpp"
+#include <fstream>
+#include <mutex>
+
+namespace UB
+{
+    class IOTrace::IMPL
+    {
+        public:
+            
+            IMPL( const std::string & path );
+            ~IMPL( void );
+            
+            static const std::string & _magic( void );
+            static uint16_t            _version( void );
+            static uint16_t            _recordSize( void );
+            
+            void _append( uint64_t value, size_t size );
+            void _flush( void );
+            
+            std::string            _path;
+            std::ofstream          _stream;
+            std::vector< uint8_t > _buffer;
+            uint64_t               _start;
+            size_t                 _records;
+            mutable std::mutex     _mtx;
+    };
+    
+    std::vector< BIOS::DiskAccess > IOTrace::read( const std::string & path )
+    {
+        BinaryFileStream                stream( path );
+        std::vector< BIOS::DiskAccess > records;
+        uint16_t                        version;
+        uint16_t                        size;
+        
+        if( stream.readString( IMPL::_magic().length() ) != IMPL::_magic() )
+        {
+            throw std::runtime_error( "Not an I/O trace: " + path );
+        }
+        
+        version = stream.readLittleEndianUInt16();
+        
+        /* Version 1 stored a 32-bit sector count followed by 4 zero bytes, which reads back as the same 64-bit value */
+        if( version == 0 || version > IMPL::_version() )
+        {
+            throw std::runtime_error( "Unsupported I/O trace version: " + path );
+        }
+        
+        size = stream.readLittleEndianUInt16();
+        
+        if( size < IMPL::_recordSize() )
+        {
+            throw std::runtime_error( "Invalid I/O trace record size: " + path );
+        }
+        
+        while( stream.availableBytes() >= size )
+        {
+            BIOS::DiskAccess access;
+            uint8_t          flags;
+            
+            access.type( static_cast< BIOS::DiskAccess::Type >( stream.readUInt8() ) );
+            access.drive( stream.readUInt8() );
+            
+            flags = stream.readUInt8();
+            
+            access.success( ( flags & 1 ) != 0 );
+            access.cylinder( stream.readUInt8() );
+            access.head( stream.readUInt8() );
+            access.sector( stream.readUInt8() );
+            access.bytesPerSector( stream.readLittleEndianUInt16() );
+            access.sectors( stream.readLittleEndianUInt64() );
+            access.lba( stream.readLittleEndianUInt64() );
+            access.destination( stream.readLittleEndianUInt64() );
+            access.time( stream.readLittleEndianUInt64() );
+            access.latency( stream.readLittleEndianUInt64() );
+            access.instructions( stream.readLittleEndianUInt64() );
+            
+            if( size > IMPL::_recordSize() )
+            {
+                stream.read( size - IMPL::_recordSize() );
+            }
+            
+            records.push_back( access );
+        }
+        
+        return records;
+    }
+    
+    IOTrace::IOTrace( const std::string & path ):
+        impl( std::make_unique< IMPL >( path ) )
+    {}
+    
+    IOTrace::~IOTrace( void )
+    {
+        this->flush();
+    }
+    
+    std::string IOTrace::path( void ) const
+    {
+        return this->impl->_path;
+    }
+    
+    size_t IOTrace::records( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_records;
+    }
+    
+    void IOTrace::write( const BIOS::DiskAccess & access )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( this->impl->_records == 0 )
+        {
+            this->impl->_start = access.time();
+        }
+        
+        this->impl->_append( static_cast< uint8_t >( access.type() ), 1 );
+        this->impl->_append( access.drive(), 1 );
+        this->impl->_append( ( access.success() ) ? 1 : 0, 1 );
+        this->impl->_append( access.cylinder(), 1 );
+        this->impl->_append( access.head(), 1 );
+        this->impl->_append( access.sector(), 1 );
+        this->impl->_append( access.bytesPerSector(), 2 );
+        this->impl->_append( access.sectors(), 8 );
+        this->impl->_append( access.lba(), 8 );
+        this->impl->_append( access.destination(), 8 );
+        this->impl->_append( access.time() - this->impl->_start, 8 );
+        this->impl->_append( access.latency(), 8 );
+        this->impl->_append( access.instructions(), 8 );
+        
+        this->impl->_records++;
+        
+        if( this->impl->_buffer.size() >= 64 * 1024 )
+        {
+            this->impl->_flush();
+        }
+    }
+    
+    void IOTrace::flush( void )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_flush();
+    }
+    
+    IOTrace::IMPL::IMPL( const std::string & path ):
+        _path(    path ),
+        _stream(  path, std::ios::binary | std::ios::out | std::ios::trunc ),
+        _start(   0 ),
+        _records( 0 )
+    {
+        if( this->_stream.good() == false )
+        {
+            throw std::runtime_error( "Cannot open I/O trace: " + path );
+        }
+        
+        this->_buffer.insert( this->_buffer.end(), _magic().begin(), _magic().end() );
+        this->_append( _version(),    2 );
+        this->_append( _recordSize(), 2 );
+    }
+    
+    IOTrace::IMPL::~IMPL( void )
+    {}
+    
+    const std::string & IOTrace::IMPL::_magic( void )
+    {
+        static const std::string magic( "UBIO" );
+        
+        return magic;
+    }
+    
+    uint16_t IOTrace::IMPL::_version( void )
+    {
+        return 2;
+    }
+    
+    uint16_t IOTrace::IMPL::_recordSize( void )
+    {
+        return 56;
+    }
+    
+    void IOTrace::IMPL::_append( uint64_t value, size_t size )
+    {
+        for( size_t i = 0; i < size; i++ )
+        {
+            this->_buffer.push_back( static_cast< uint8_t >( ( value >> ( i * 8 ) ) & 0xFF ) );
+        }
+    }
+    
+    void IOTrace::IMPL::_flush( void )
+    {
+        if( this->_buffer.size() == 0 )
+        {
+            return;
+        }
+        
+        this->_stream.write( reinterpret_cast< const char * >( this->_buffer.data() ), numeric_cast< std::streamsize >( this->_buffer.size() ) );
+        this->_stream.flush();
+        this->_buffer.clear();
+    }
+}
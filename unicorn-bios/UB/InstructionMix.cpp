@@ -0,0 +1,242 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/InstructionMix.hpp"
+#include <map>
+#include <sstream>
+#include <iomanip>
+
+namespace UB
+{
+    class InstructionMix::IMPL
+    {
+        public:
+            
+            IMPL( const BlockCache & blocks );
+            IMPL( const IMPL & o );
+            ~IMPL( void );
+            
+            static void _print( std::stringstream & ss, const std::string & title, const std::map< std::string, uint64_t > & counts, size_t max, uint64_t total );
+            
+            const BlockCache * _blocks;
+    };
+    
+    std::vector< std::string > InstructionMix::classes( const std::string & mnemonic )
+    {
+        std::vector< std::string > classes;
+        std::string                base( mnemonic );
+        size_t                     space( mnemonic.find( ' ' ) );
+        
+        if( space != std::string::npos )
+        {
+            if( mnemonic.compare( 0, 3, "rep" ) == 0 )
+            {
+                classes.push_back( "rep" );
+            }
+            
+            base = mnemonic.substr( space + 1 );
+        }
+        
+        for( std::string op: { "movs", "stos", "lods", "cmps", "scas", "ins", "outs" } )
+        {
+            if
+            (
+                   base.length() == op.length() + 1
+                && base.compare( 0, op.length(), op ) == 0
+                && std::string( "bwdq" ).find( base.back() ) != std::string::npos
+            )
+            {
+                classes.push_back( "string" );
+                
+                if( op == "ins" || op == "outs" )
+                {
+                    classes.push_back( "port-io" );
+                }
+            }
+        }
+        
+        if( base == "in" || base == "out" )
+        {
+            classes.push_back( "port-io" );
+        }
+        
+        if( base == "lcall" || base == "ljmp" || base == "retf" || base == "lret" || base.compare( 0, 4, "iret" ) == 0 )
+        {
+            classes.push_back( "far-transfer" );
+        }
+        
+        return classes;
+    }
+    
+    InstructionMix::InstructionMix( const BlockCache & blocks ):
+        impl( std::make_unique< IMPL >( blocks ) )
+    {}
+    
+    InstructionMix::InstructionMix( const InstructionMix & o ):
+        impl( std::make_unique< IMPL >( *( o.impl ) ) )
+    {}
+    
+    InstructionMix::InstructionMix( InstructionMix && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    InstructionMix::~InstructionMix( void )
+    {}
+    
+    InstructionMix & InstructionMix::operator =( InstructionMix o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    uint64_t InstructionMix::instructions( void ) const
+    {
+        uint64_t instructions( 0 );
+        
+        for( const auto & p: this->impl->_blocks->blocks() )
+        {
+            instructions += p.first->instructions().size() * p.second;
+        }
+        
+        return instructions;
+    }
+    
+    uint64_t InstructionMix::blocks( void ) const
+    {
+        uint64_t executions( 0 );
+        
+        for( const auto & p: this->impl->_blocks->blocks() )
+        {
+            executions += p.second;
+        }
+        
+        return executions;
+    }
+    
+    size_t InstructionMix::uniqueBlocks( void ) const
+    {
+        return this->impl->_blocks->blocks().size();
+    }
+    
+    std::string InstructionMix::report( size_t top ) const
+    {
+        std::stringstream                                           ss;
+        std::map< Engine::Mode, uint64_t >                          totals;
+        std::map< Engine::Mode, std::map< std::string, uint64_t > > groups;
+        std::map< Engine::Mode, std::map< std::string, uint64_t > > mnemonics;
+        uint64_t                                                    instructions( 0 );
+        uint64_t                                                    executions( 0 );
+        auto                                                        blocks( this->impl->_blocks->blocks() );
+        
+        for( const auto & p: blocks )
+        {
+            Engine::Mode mode( p.first->mode() );
+            
+            executions   += p.second;
+            instructions += p.first->instructions().size() * p.second;
+            
+            for( const auto & instruction: p.first->instructions() )
+            {
+                totals[ mode ]                         += p.second;
+                mnemonics[ mode ][ instruction.first ] += p.second;
+                
+                for( const auto & group: instruction.second )
+                {
+                    groups[ mode ][ group ] += p.second;
+                }
+                
+                for( const auto & group: classes( instruction.first ) )
+                {
+                    groups[ mode ][ group ] += p.second;
+                }
+            }
+        }
+        
+        ss << "Instruction mix: "
+           << instructions  << " instructions, "
+           << executions    << " blocks executed, "
+           << blocks.size() << " unique blocks decoded"
+           << std::endl;
+        
+        for( const auto & p: totals )
+        {
+            ss << std::endl
+               << ( ( p.first == Engine::Mode::Real ) ? "Real" : ( ( p.first == Engine::Mode::Protected ) ? "Protected" : "Long" ) )
+               << " mode: " << p.second << " instructions"
+               << std::endl;
+            
+            IMPL::_print( ss, "Groups", groups[ p.first ], groups[ p.first ].size(), p.second );
+            IMPL::_print( ss, "Mnemonics (top " + std::to_string( top ) + ")", mnemonics[ p.first ], top, p.second );
+        }
+        
+        return ss.str();
+    }
+    
+    void swap( InstructionMix & o1, InstructionMix & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    InstructionMix::IMPL::IMPL( const BlockCache & blocks ):
+        _blocks( &blocks )
+    {}
+    
+    InstructionMix::IMPL::IMPL( const IMPL & o ):
+        _blocks( o._blocks )
+    {}
+    
+    InstructionMix::IMPL::~IMPL( void )
+    {}
+    
+    void InstructionMix::IMPL::_print( std::stringstream & ss, const std::string & title, const std::map< std::string, uint64_t > & counts, size_t max, uint64_t total )
+    {
+        std::vector< std::pair< std::string, uint64_t > > sorted( counts.begin(), counts.end() );
+        
+        std::sort
+        (
+            sorted.begin(),
+            sorted.end(),
+            []( const std::pair< std::string, uint64_t > & o1, const std::pair< std::string, uint64_t > & o2 ) -> bool
+            {
+                return ( o1.second == o2.second ) ? o1.first < o2.first : o1.second > o2.second;
+            }
+        );
+        
+        ss << std::endl << "    " << title << ":" << std::endl;
+        
+        for( size_t i = 0; i < sorted.size() && i < max; i++ )
+        {
+            ss << "        "
+               << std::left  << std::setw( 20 ) << sorted[ i ].first
+               << std::right << std::setw( 14 ) << sorted[ i ].second
+               << std::fixed << std::setprecision( 2 ) << std::setw( 9 )
+               << ( static_cast< double >( sorted[ i ].second ) * 100.0 ) / static_cast< double >( total )
+               << "%"
+               << std::endl;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_INSTRUCTION_MIX_HPP
+#define UB_INSTRUCTION_MIX_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "UB/Engine.hpp"
+#include "UB/BlockCache.hpp"
+
+namespace UB
+{
+    /*!
+     * Instruction mix of the blocks seen by a BlockCache, each block's
+     * decoded instructions weighted by its execution count. Nothing is
+     * done per execution beyond the cache's own counting.
+     */
+    class InstructionMix
+    {
+        public:
+            
+            static std::vector< std::string > classes( const std::string & mnemonic );
+            
+            InstructionMix( const BlockCache & blocks );
+            InstructionMix( const InstructionMix & o );
+            InstructionMix( InstructionMix && o ) noexcept;
+            ~InstructionMix( void );
+            
+            InstructionMix & operator =( InstructionMix o );
+            
+            uint64_t    instructions( void )     const;
+            uint64_t    blocks( void )           const;
+            size_t      uniqueBlocks( void )     const;
+            std::string report( size_t top = 20 ) const;
+            
+            friend void swap( InstructionMix & o1, InstructionMix & o2 );
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_INSTRUCTION_MIX_HPP */
@@ -27,6 +27,7 @@
 #include "UB/Machine.hpp"
 #include "UB/BIOS/Video.hpp"
 #include "UB/BIOS/Disk.hpp"
+#include "UB/BIOS/Serial.hpp"
 #include "UB/BIOS/Keyboard.hpp"
 #include "UB/BIOS/SystemServices.hpp"
 
@@ -99,8 +100,14 @@ namespace UB
         
         bool int0x14( const Machine & machine, Engine & engine )
         {
-            ( void )machine;
-            ( void )engine;
+            switch( engine.ah() )
+            {
+                case 0x00: return BIOS::Serial::initialize( machine, engine );
+                case 0x01: return BIOS::Serial::transmit( machine, engine );
+                case 0x02: return BIOS::Serial::receive( machine, engine );
+                case 0x03: return BIOS::Serial::status( machine, engine );
+                default:   break;
+            }
             
             return false;
         }
@@ -122,6 +129,9 @@ namespace UB
             switch( engine.ah() )
             {
                 case 0x00: return BIOS::Keyboard::readKey( machine, engine );
+                case 0x01: return BIOS::Keyboard::checkKey( machine, engine );
+                case 0x10: return BIOS::Keyboard::readKey( machine, engine );
+                case 0x11: return BIOS::Keyboard::checkKey( machine, engine );
                 default:   break;
             }
             
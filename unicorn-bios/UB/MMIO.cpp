@@ -0,0 +1,192 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/MMIO.hpp"
+#include "UB/String.hpp"
+#include <deque>
+#include <vector>
+#include <mutex>
+
+namespace UB
+{
+    class MMIO::IMPL
+    {
+        public:
+            
+            class Region
+            {
+                public:
+                    
+                    std::string                                         _name;
+                    uint64_t                                            _base;
+                    uint64_t                                            _size;
+                    std::function< uint64_t( uint64_t, size_t ) >       _read;
+                    std::function< void( uint64_t, size_t, uint64_t ) > _write;
+            };
+            
+            IMPL( Engine & engine );
+            ~IMPL( void );
+            
+            const Region * _find( uint64_t address ) const;
+            uint64_t       _dispatch( Engine::MemoryAccess access, uint64_t address, size_t size, uint64_t value ) const;
+            
+            Engine                        & _engine;
+            std::deque< Region >            _regions;
+            std::vector< const Region * >   _table;
+            mutable std::recursive_mutex    _rmtx;
+    };
+    
+    MMIO::MMIO( Engine & engine ):
+        impl( std::make_unique< IMPL >( engine ) )
+    {}
+    
+    MMIO::~MMIO( void )
+    {}
+    
+    void MMIO::claim( const std::string & name, uint64_t base, uint64_t size, const std::function< uint64_t( uint64_t, size_t ) > & read, const std::function< void( uint64_t, size_t, uint64_t ) > & write )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        const IMPL::Region                    * region;
+        
+        if( size == 0 || base + size < base )
+        {
+            throw std::runtime_error( "Invalid MMIO range for " + name + ": " + String::toHex( base ) + " (" + std::to_string( size ) + " bytes)" );
+        }
+        
+        for( const auto r: this->impl->_table )
+        {
+            if( base < r->_base + r->_size && r->_base < base + size )
+            {
+                throw std::runtime_error( "MMIO range " + String::toHex( base ) + " for " + name + " overlaps " + r->_name + " at " + String::toHex( r->_base ) );
+            }
+        }
+        
+        this->impl->_regions.push_back( { name, base, size, read, write } );
+        
+        region = &( this->impl->_regions.back() );
+        
+        this->impl->_table.insert
+        (
+            std::upper_bound
+            (
+                this->impl->_table.begin(),
+                this->impl->_table.end(),
+                base,
+                []( uint64_t address, const IMPL::Region * r ) -> bool
+                {
+                    return address < r->_base;
+                }
+            ),
+            region
+        );
+        
+        this->impl->_engine.onDeviceAccess
+        (
+            base,
+            base + size - 1,
+            [ this ]( Engine::MemoryAccess access, uint64_t address, size_t s, uint64_t value ) -> uint64_t
+            {
+                return this->impl->_dispatch( access, address, s, value );
+            }
+        );
+    }
+    
+    bool MMIO::claimed( uint64_t address, size_t size ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        const IMPL::Region                    * region( this->impl->_find( address ) );
+        
+        return region != nullptr && address + size <= region->_base + region->_size;
+    }
+    
+    std::string MMIO::owner( uint64_t address ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        const IMPL::Region                    * region( this->impl->_find( address ) );
+        
+        return ( region == nullptr ) ? "" : region->_name;
+    }
+    
+    MMIO::IMPL::IMPL( Engine & engine ):
+        _engine( engine )
+    {}
+    
+    MMIO::IMPL::~IMPL( void )
+    {}
+    
+    const MMIO::IMPL::Region * MMIO::IMPL::_find( uint64_t address ) const
+    {
+        auto it
+        (
+            std::upper_bound
+            (
+                this->_table.begin(),
+                this->_table.end(),
+                address,
+                []( uint64_t a, const Region * r ) -> bool
+                {
+                    return a < r->_base;
+                }
+            )
+        );
+        
+        if( it == this->_table.begin() )
+        {
+            return nullptr;
+        }
+        
+        --it;
+        
+        return ( address < ( *( it ) )->_base + ( *( it ) )->_size ) ? *( it ) : nullptr;
+    }
+    
+    uint64_t MMIO::IMPL::_dispatch( Engine::MemoryAccess access, uint64_t address, size_t size, uint64_t value ) const
+    {
+        const Region * region;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            region = this->_find( address );
+        }
+        
+        /* Regions are never removed and live in a deque, so the pointer stays valid unlocked */
+        if( region == nullptr )
+        {
+            return 0;
+        }
+        
+        if( access == Engine::MemoryAccess::Write )
+        {
+            if( region->_write != nullptr )
+            {
+                region->_write( address - region->_base, size, value );
+            }
+            
+            return 0;
+        }
+        
+        return ( region->_read != nullptr ) ? region->_read( address - region->_base, size ) : 0;
+    }
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_MMIO_HPP
+#define UB_MMIO_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <functional>
+#include "UB/Engine.hpp"
+
+namespace UB
+{
+    /*!
+     * Registry of memory-mapped device windows.
+     * 
+     * A device model claims a guest physical range with read and write
+     * callbacks, which receive the offset into the window. Each window gets
+     * unicorn memory hooks scoped to exactly that range, so a device costs
+     * nothing outside of it. Accesses are routed to the owning device through
+     * a table sorted by base address. Ranges outside of guest memory are
+     * mapped on demand. Overlapping claims are rejected.
+     */
+    class MMIO
+    {
+        public:
+            
+            MMIO( Engine & engine );
+            ~MMIO( void );
+            
+            MMIO( const MMIO & o )              = delete;
+            MMIO( MMIO && o )                   = delete;
+            MMIO & operator =( const MMIO & o ) = delete;
+            MMIO & operator =( MMIO && o )      = delete;
+            
+            void claim( const std::string & name, uint64_t base, uint64_t size, const std::function< uint64_t( uint64_t, size_t ) > & read, const std::function< void( uint64_t, size_t, uint64_t ) > & write );
+            
+            bool        claimed( uint64_t address, size_t size ) const;
+            std::string owner( uint64_t address )                const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_MMIO_HPP */
@@ -28,12 +28,26 @@
 #include "UB/Interrupts.hpp"
 #include "UB/FAT/MBR.hpp"
 #include "UB/String.hpp"
+#include "UB/Timeline.hpp"
+#include "UB/FlightRecorder.hpp"
+#include "UB/Signal.hpp"
+#include "UB/Probes.hpp"
 #include "UB/CPU/Functions.hpp"
+#include "UB/AhoCorasick.hpp"
 #include <sstream>
 #include <atomic>
 #include <csignal>
 #include <vector>
 #include <iostream>
+#include <mutex>
+#include <cctype>
+#include <deque>
+#include <fstream>
+#include <chrono>
+#include <array>
+#include <tuple>
+#include <iomanip>
+#include <limits>
 
 namespace UB
 {
@@ -41,7 +55,7 @@ namespace UB
     {
         public:
             
-            IMPL( size_t memory, const FAT::Image & fat, UI::Mode mode );
+            IMPL( const BIOS::MemoryMap & memoryMap, const FAT::Image & fat, UI::Mode mode );
             IMPL( const IMPL & o );
             ~IMPL( void );
             
@@ -49,23 +63,70 @@ namespace UB
             
             void _setup( const Machine & machine );
             void _break( const std::string & message = "" );
+            void _dump( const std::string & reason );
+            bool _reached( Milestone milestone ) const;
+            void _milestone( Milestone milestone );
             
-            size_t                  _memory;
-            FAT::Image              _fat;
-            UI::Mode                _mode;
-            Engine                  _engine;
-            UI                      _ui;
-            BIOS::MemoryMap         _memoryMap;
-            std::atomic< bool >     _breakOnInterrupt;
-            std::atomic< bool >     _breakOnInterruptReturn;
-            std::atomic< bool >     _trap;
-            std::atomic< bool >     _debugVideo;
-            std::atomic< bool >     _singleStep;
-            std::vector< uint64_t > _breakpoints;
+            /* Replaced, never modified, so output can run the handlers without copying them */
+            typedef std::shared_ptr< const std::vector< std::function< void( Output, uint8_t ) > > > OutputHandlers;
+            
+            FAT::Image                                                            _fat;
+            UI::Mode                                                              _mode;
+            Engine                                                                _engine;
+            UI                                                                    _ui;
+            MMIO                                                                  _mmio;
+            BIOS::MemoryMap                                                       _memoryMap;
+            std::atomic< bool >                                                   _breakOnInterrupt;
+            std::atomic< bool >                                                   _breakOnInterruptReturn;
+            std::atomic< bool >                                                   _trap;
+            std::atomic< bool >                                                   _debugVideo;
+            std::atomic< bool >                                                   _singleStep;
+            std::vector< uint64_t >                                               _breakpoints;
+            std::recursive_mutex                                                  _rmtx;
+            std::vector< std::function< void( const BIOS::DiskAccess & ) > >      _onDiskRead;
+            OutputHandlers                                                        _onOutput;
+            std::vector< std::function< void( uint32_t ) > >                      _onInterrupt;
+            std::vector< std::function< void( uint32_t ) > >                      _onInterruptReturn;
+            std::vector< std::function< void( uint64_t ) > >                      _onInstruction;
+            std::atomic< bool >                                                   _hasInstructionHandlers;
+            std::vector< std::function< void( uint8_t ) > >                       _onVideoMode;
+            std::vector< std::function< void( Milestone, uint64_t, uint64_t ) > > _onMilestone;
+            std::deque< uint8_t >                                                 _keys;
+            bool                                                                  _serialDLAB;
+            bool                                                                  _started;
+            FlightRecorder                                                        _recorder;
+            std::string                                                           _flightRecorderPath;
+            std::atomic< bool >                                                   _dumped;
+            std::atomic< bool >                                                   _interrupted;
+            uint64_t                                                              _signalHandler;
+            std::vector< std::tuple< Milestone, uint64_t, uint64_t > >            _milestones;
+            std::string                                                           _milestoneOutput;
+            std::unique_ptr< AhoCorasick >                                        _milestoneMatcher;
+            std::atomic< bool >                                                   _matchOutput;
+            std::array< uint32_t, 3 >                                             _milestoneStates;
+            std::chrono::steady_clock::time_point                                 _startTime;
     };
 
+    std::string Machine::milestoneName( Milestone milestone )
+    {
+        switch( milestone )
+        {
+            case Milestone::DiskInterrupt: return "First INT 13h";
+            case Milestone::ProtectedMode: return "Protected mode";
+            case Milestone::LongMode:      return "Long mode";
+            case Milestone::Output:        return "Output";
+            case Milestone::Ready:         return "Ready";
+        }
+        
+        return "Unknown";
+    }
+    
     Machine::Machine( size_t memory, const FAT::Image & fat, UI::Mode mode ):
-        impl( std::make_unique< IMPL >( memory, fat, mode ) )
+        Machine( BIOS::MemoryMap( IMPL::memorySizeOrDefault( memory ) ), fat, mode )
+    {}
+    
+    Machine::Machine( const BIOS::MemoryMap & memoryMap, const FAT::Image & fat, UI::Mode mode ):
+        impl( std::make_unique< IMPL >( memoryMap, fat, mode ) )
     {
         this->impl->_setup( *( this ) );
     }
@@ -105,8 +166,15 @@ namespace UB
         return this->impl->_ui;
     }
     
+    MMIO & Machine::mmio( void ) const
+    {
+        return this->impl->_mmio;
+    }
+    
     void Machine::run( void )
     {
+        this->impl->_startTime = std::chrono::steady_clock::now();
+        
         if( this->impl->_engine.start( 0x7C00 ) == false )
         {
             throw std::runtime_error( "Cannot start engine" );
@@ -115,6 +183,146 @@ namespace UB
         this->impl->_ui.mode( this->impl->_mode );
         this->impl->_ui.run();
         this->impl->_engine.stop();
+        
+        if( this->impl->_interrupted )
+        {
+            this->impl->_dump( "Interrupted" );
+        }
+    }
+    
+    void Machine::stop( void )
+    {
+        this->impl->_engine.stop();
+        this->impl->_ui.stop();
+    }
+    
+    bool Machine::execute( size_t instructions )
+    {
+        return this->execute( instructions, std::numeric_limits< uint64_t >::max() );
+    }
+    
+    bool Machine::execute( size_t instructions, uint64_t until )
+    {
+        bool ret;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            if( this->impl->_started == false )
+            {
+                this->impl->_engine.cs( 0 );
+                this->impl->_engine.ip( 0x7C00 );
+                
+                this->impl->_started   = true;
+                this->impl->_startTime = std::chrono::steady_clock::now();
+            }
+        }
+        
+        ret = this->impl->_engine.execute( instructions, until );
+        
+        /* An interrupted machine reports failure so its driver stops running it */
+        if( this->impl->_interrupted )
+        {
+            this->impl->_dump( "Interrupted" );
+            
+            return false;
+        }
+        
+        return ret;
+    }
+    
+    /*
+     * Called by BIOS services that wait on the host (INT 16h with an empty
+     * key queue). A machine driven by execute() gives its slice back to the
+     * caller, whose script can send keys before the service runs again.
+     * Nothing feeds the queue of a free-running machine, so it can't wait
+     * and false is returned.
+     */
+    bool Machine::yield( void ) const
+    {
+        bool started;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            started = this->impl->_started;
+        }
+        
+        if( started )
+        {
+            this->impl->_engine.stop();
+        }
+        
+        return started;
+    }
+    
+    Engine::Mode Machine::mode( void ) const
+    {
+        return this->impl->_engine.mode();
+    }
+    
+    unsigned int Machine::bits( void ) const
+    {
+        return this->impl->_engine.bits();
+    }
+    
+    uint64_t Machine::pc( void ) const
+    {
+        return this->impl->_engine.pc();
+    }
+    
+    uint64_t Machine::instructions( void ) const
+    {
+        return this->impl->_engine.instructions();
+    }
+    
+    std::vector< uint8_t > Machine::read( uint64_t address, size_t size ) const
+    {
+        return this->impl->_engine.read( address, size );
+    }
+    
+    void Machine::share( uint64_t address, size_t size, int fd, int64_t offset )
+    {
+        this->impl->_engine.share( address, size, fd, offset );
+    }
+    
+    void Machine::sendKeys( const std::string & keys )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        for( char c: keys )
+        {
+            this->impl->_keys.push_back( static_cast< uint8_t >( c ) );
+        }
+    }
+    
+    std::optional< uint8_t > Machine::peekKey( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        if( this->impl->_keys.size() == 0 )
+        {
+            return {};
+        }
+        
+        return this->impl->_keys.front();
+    }
+    
+    std::optional< uint8_t > Machine::readKey( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        uint8_t                                 key;
+        
+        if( this->impl->_keys.size() == 0 )
+        {
+            return {};
+        }
+        
+        key = this->impl->_keys.front();
+        
+        this->impl->_keys.pop_front();
+        
+        return key;
     }
     
     bool Machine::breakOnInterrupt( void ) const
@@ -167,6 +375,83 @@ namespace UB
         this->impl->_singleStep = value;
     }
 
+    std::string Machine::flightRecorderPath( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return this->impl->_flightRecorderPath;
+    }
+    
+    void Machine::flightRecorderPath( const std::string & path )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_flightRecorderPath = path;
+    }
+    
+    std::string Machine::milestoneOutput( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return this->impl->_milestoneOutput;
+    }
+    
+    void Machine::milestoneOutput( const std::string & text )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_milestoneOutput  = text;
+        this->impl->_milestoneMatcher = ( text.length() > 0 ) ? std::make_unique< AhoCorasick >( std::vector< std::string >( 1, text ) ) : nullptr;
+        
+        this->impl->_milestoneStates.fill( AhoCorasick::InitialState );
+        
+        this->impl->_matchOutput = this->impl->_milestoneMatcher != nullptr;
+    }
+    
+    std::string Machine::milestones( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::stringstream                       ss;
+        
+        ss << "Boot milestones:"
+           << std::endl
+           << std::endl
+           << std::left  << std::setw( 24 ) << "Milestone"
+           << std::right << std::setw( 16 ) << "Instructions"
+           << std::setw( 14 ) << "Time (ms)"
+           << std::endl;
+        
+        for( const auto & milestone: this->impl->_milestones )
+        {
+            std::string name( milestoneName( std::get< 0 >( milestone ) ) );
+            
+            if( std::get< 0 >( milestone ) == Milestone::Output )
+            {
+                name += ": " + this->impl->_milestoneOutput;
+            }
+            
+            ss << std::left  << std::setw( 24 ) << name
+               << std::right << std::setw( 16 ) << std::get< 1 >( milestone )
+               << std::setw( 14 ) << std::fixed << std::setprecision( 3 ) << static_cast< double >( std::get< 2 >( milestone ) ) / 1000000.0
+               << std::endl;
+        }
+        
+        for( Milestone milestone: { Milestone::DiskInterrupt, Milestone::ProtectedMode, Milestone::LongMode, Milestone::Output, Milestone::Ready } )
+        {
+            if( this->impl->_reached( milestone ) || ( milestone == Milestone::Output && this->impl->_milestoneMatcher == nullptr ) )
+            {
+                continue;
+            }
+            
+            ss << std::left  << std::setw( 24 ) << milestoneName( milestone )
+               << std::right << std::setw( 16 ) << "-"
+               << std::setw( 14 ) << "-"
+               << std::endl;
+        }
+        
+        return ss.str();
+    }
+    
     void Machine::breakHere( const std::string & message ) const
     {
         this->impl->_break( message );
@@ -191,6 +476,166 @@ namespace UB
         );
     }
     
+    void Machine::onDiskRead( const std::function< void( const BIOS::DiskAccess & ) > handler )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_onDiskRead.push_back( handler );
+    }
+    
+    void Machine::onOutput( const std::function< void( Output, uint8_t ) > handler )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        auto                                    handlers( std::make_shared< std::vector< std::function< void( Output, uint8_t ) > > >( *( this->impl->_onOutput ) ) );
+        
+        handlers->push_back( handler );
+        
+        std::atomic_store( &( this->impl->_onOutput ), IMPL::OutputHandlers( handlers ) );
+    }
+    
+    void Machine::onInterrupt( const std::function< void( uint32_t ) > handler )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_onInterrupt.push_back( handler );
+    }
+    
+    void Machine::onInterruptReturn( const std::function< void( uint32_t ) > handler )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_onInterruptReturn.push_back( handler );
+    }
+    
+    void Machine::onInstruction( const std::function< void( uint64_t ) > handler )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_onInstruction.push_back( handler );
+        
+        this->impl->_hasInstructionHandlers = true;
+    }
+    
+    void Machine::onBlock( const std::function< void( uint64_t, size_t ) > handler )
+    {
+        this->impl->_engine.onBlock( handler );
+    }
+    
+    void Machine::onMemoryAccess( uint64_t begin, uint64_t end, const std::function< void( Engine::MemoryAccess, uint64_t, size_t ) > handler )
+    {
+        this->impl->_engine.onMemoryAccess( begin, end, handler );
+    }
+    
+    void Machine::onCodeWrite( const std::function< void( uint64_t ) > handler )
+    {
+        this->impl->_engine.onCodeWrite( handler );
+    }
+    
+    void Machine::onModeChange( const std::function< void( Engine::Mode, Engine::Mode ) > handler )
+    {
+        this->impl->_engine.onModeChange( handler );
+    }
+    
+    void Machine::onVideoMode( const std::function< void( uint8_t ) > handler )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_onVideoMode.push_back( handler );
+    }
+    
+    void Machine::onMilestone( const std::function< void( Milestone, uint64_t, uint64_t ) > handler )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_onMilestone.push_back( handler );
+    }
+    
+    void Machine::didReadDisk( const BIOS::DiskAccess & access ) const
+    {
+        std::vector< std::function< void( const BIOS::DiskAccess & ) > > handlers;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            handlers = this->impl->_onDiskRead;
+        }
+        
+        this->impl->_recorder.diskRead( access );
+        
+        if( UB_PROBE_ENABLED( disk_read ) )
+        {
+            UB_PROBE5( disk_read, access.drive(), access.lba(), access.sectors(), access.size(), static_cast< int >( access.success() ) );
+        }
+        
+        for( const auto & f: handlers )
+        {
+            f( access );
+        }
+    }
+    
+    void Machine::didOutput( Output output, uint8_t c ) const
+    {
+        IMPL::OutputHandlers handlers( std::atomic_load( &( this->impl->_onOutput ) ) );
+        char                 s( static_cast< char >( c ) );
+        bool                 milestone( false );
+        
+        if( output == Output::DebugPort )
+        {
+            this->impl->_ui.debug() << std::string( 1, s );
+        }
+        else if( std::isprint( s ) || std::isspace( s ) )
+        {
+            this->impl->_ui.output() << std::string( 1, s );
+        }
+        else
+        {
+            this->impl->_ui.output() << ".";
+        }
+        
+        this->impl->_recorder.output( c );
+        
+        /* The lock is only needed to match --milestone-output, which is off by default */
+        if( this->impl->_matchOutput )
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            if( this->impl->_milestoneMatcher != nullptr )
+            {
+                uint32_t & state( this->impl->_milestoneStates[ static_cast< size_t >( output ) ] );
+                
+                state = this->impl->_milestoneMatcher->next( state, c );
+                
+                milestone = this->impl->_milestoneMatcher->isMatch( state );
+            }
+        }
+        
+        if( milestone )
+        {
+            this->impl->_milestone( Milestone::Output );
+        }
+        
+        for( const auto & f: *( handlers ) )
+        {
+            f( output, c );
+        }
+    }
+    
+    void Machine::didSetVideoMode( uint8_t mode ) const
+    {
+        std::vector< std::function< void( uint8_t ) > > handlers;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            handlers = this->impl->_onVideoMode;
+        }
+        
+        for( const auto & f: handlers )
+        {
+            f( mode );
+        }
+    }
+    
     void swap( Machine & o1, Machine & o2 )
     {
         using std::swap;
@@ -198,36 +643,66 @@ namespace UB
         swap( o1.impl, o2.impl );
     }
 
-    Machine::IMPL::IMPL( size_t memory, const FAT::Image & fat, UI::Mode mode ):
-        _memory(                 memorySizeOrDefault( memory ) ),
+    Machine::IMPL::IMPL( const BIOS::MemoryMap & memoryMap, const FAT::Image & fat, UI::Mode mode ):
         _fat(                    fat ),
         _mode(                   mode ),
-        _engine(                 memorySizeOrDefault( memory ) ),
+        _engine(                 memoryMap.regions() ),
         _ui(                     this->_engine ),
-        _memoryMap(              memorySizeOrDefault( memory ) ),
+        _mmio(                   this->_engine ),
+        _memoryMap(              memoryMap ),
         _breakOnInterrupt(       false ),
         _breakOnInterruptReturn( false ),
         _trap(                   false ),
         _debugVideo(             false ),
-        _singleStep(             false )
-    {}
+        _singleStep(             false ),
+        _onOutput(               std::make_shared< std::vector< std::function< void( Output, uint8_t ) > > >() ),
+        _hasInstructionHandlers( false ),
+        _serialDLAB(             false ),
+        _started(                false ),
+        _dumped(                 false ),
+        _interrupted(            false ),
+        _signalHandler(          0 ),
+        _matchOutput(            false ),
+        _startTime(              std::chrono::steady_clock::now() )
+    {
+        this->_milestoneStates.fill( AhoCorasick::InitialState );
+    }
 
     Machine::IMPL::IMPL( const IMPL & o ):
-        _memory(                 o._memory ),
         _fat(                    o._fat ),
         _mode(                   o._mode ),
-        _engine(                 o._memory ),
+        _engine(                 o._memoryMap.regions() ),
         _ui(                     this->_engine ),
+        _mmio(                   this->_engine ),
         _memoryMap(              o._memoryMap ),
         _breakOnInterrupt(       o._breakOnInterrupt.load() ),
         _breakOnInterruptReturn( o._breakOnInterruptReturn.load() ),
         _trap(                   o._trap.load() ),
         _debugVideo(             o._debugVideo.load() ),
-        _singleStep(             o._singleStep.load() )
-    {}
+        _singleStep(             o._singleStep.load() ),
+        _onOutput(               std::make_shared< std::vector< std::function< void( Output, uint8_t ) > > >() ),
+        _hasInstructionHandlers( false ),
+        _serialDLAB(             false ),
+        _started(                false ),
+        _flightRecorderPath(     o._flightRecorderPath ),
+        _dumped(                 false ),
+        _interrupted(            false ),
+        _signalHandler(          0 ),
+        _milestoneOutput(        o._milestoneOutput ),
+        _milestoneMatcher(       ( o._milestoneMatcher != nullptr ) ? std::make_unique< AhoCorasick >( *( o._milestoneMatcher ) ) : nullptr ),
+        _matchOutput(            o._matchOutput.load() ),
+        _startTime(              std::chrono::steady_clock::now() )
+    {
+        this->_milestoneStates.fill( AhoCorasick::InitialState );
+    }
 
     Machine::IMPL::~IMPL( void )
-    {}
+    {
+        if( this->_signalHandler != 0 )
+        {
+            Signal::remove( SIGINT, this->_signalHandler );
+        }
+    }
     
     size_t Machine::IMPL::memorySizeOrDefault( size_t memory )
     {
@@ -261,6 +736,8 @@ namespace UB
             {
                 this->_ui.debug() << "[ ERROR ]> Exception caught: " << e.what() << std::endl;
                 
+                this->_dump( e.what() );
+                
                 return true;
             }
         );
@@ -269,9 +746,25 @@ namespace UB
         (
             [ & ]( uint64_t address, const std::vector< uint8_t > & instruction )
             {
-                ( void )address;
                 ( void )instruction;
                 
+                /* Checked first, so machines without instruction handlers don't lock and copy per instruction */
+                if( this->_hasInstructionHandlers )
+                {
+                    std::vector< std::function< void( uint64_t ) > > handlers;
+                    
+                    {
+                        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                        
+                        handlers = this->_onInstruction;
+                    }
+                    
+                    for( const auto & f: handlers )
+                    {
+                        f( address );
+                    }
+                }
+                
                 if( this->_singleStep )
                 {
                     this->_break();
@@ -282,6 +775,8 @@ namespace UB
                     
                     if( std::find( this->_breakpoints.begin(), this->_breakpoints.end(), ip ) != this->_breakpoints.end() )
                     {
+                        UB_PROBE1( breakpoint, ip );
+                        
                         this->_break( String::toHex( ip ) );
                     }
                 }
@@ -310,7 +805,37 @@ namespace UB
         (
             [ & ]( uint32_t i ) -> bool
             {
-                bool ret( false );
+                Timeline::Span span( "BIOS", "INT " + String::toHex( static_cast< uint8_t >( i ) ) );
+                bool           ret( false );
+                
+                span.detail( "AX=" + String::toHex( this->_engine.ax() ) );
+                
+                this->_recorder.interrupt( i, this->_engine );
+                
+                if( UB_PROBE_ENABLED( interrupt_entry ) )
+                {
+                    UB_PROBE2( interrupt_entry, i, this->_engine.ah() );
+                }
+                
+                {
+                    std::vector< std::function< void( uint32_t ) > > handlers;
+                    
+                    {
+                        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                        
+                        handlers = this->_onInterrupt;
+                    }
+                    
+                    for( const auto & f: handlers )
+                    {
+                        f( i );
+                    }
+                }
+                
+                if( i == 0x13 )
+                {
+                    this->_milestone( Milestone::DiskInterrupt );
+                }
                 
                 if( this->_breakOnInterrupt )
                 {
@@ -335,6 +860,26 @@ namespace UB
                     default: break;
                 }
                 
+                {
+                    std::vector< std::function< void( uint32_t ) > > handlers;
+                    
+                    {
+                        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                        
+                        handlers = this->_onInterruptReturn;
+                    }
+                    
+                    for( const auto & f: handlers )
+                    {
+                        f( i );
+                    }
+                }
+                
+                if( UB_PROBE_ENABLED( interrupt_return ) )
+                {
+                    UB_PROBE3( interrupt_return, i, this->_engine.ah(), static_cast< int >( ret ) );
+                }
+                
                 if( this->_breakOnInterruptReturn )
                 {
                     this->_break( "Return from interrupt" );
@@ -344,6 +889,73 @@ namespace UB
             }
         );
         
+        this->_engine.flightRecorder( &( this->_recorder ) );
+        
+        this->_engine.onModeChange
+        (
+            [ & ]( Engine::Mode previous, Engine::Mode mode )
+            {
+                ( void )previous;
+                
+                this->_ui.debug() << "[ INFO ]> CPU entered "
+                                  << ( ( mode == Engine::Mode::Real ) ? "real" : ( ( mode == Engine::Mode::Protected ) ? "protected" : "long" ) )
+                                  << " mode at "
+                                  << String::toHex( this->_engine.eip() )
+                                  << std::endl;
+                
+                if( mode == Engine::Mode::Protected )
+                {
+                    this->_milestone( Milestone::ProtectedMode );
+                }
+                else if( mode == Engine::Mode::Long )
+                {
+                    this->_milestone( Milestone::LongMode );
+                }
+            }
+        );
+        
+        /*
+         * The handler runs on the signal dispatcher thread while the
+         * engine may still be running: it only flags the interrupt, and
+         * the dump happens once the engine has stopped.
+         */
+        this->_signalHandler = Signal::handle
+        (
+            SIGINT,
+            [ & ]( int sig )
+            {
+                ( void )sig;
+                
+                this->_interrupted = true;
+            }
+        );
+        
+        this->_engine.onPortOutput
+        (
+            [ & ]( uint16_t port, size_t size, uint32_t value )
+            {
+                ( void )size;
+                
+                if( port == 0xE9 )
+                {
+                    machine.didOutput( Output::DebugPort, static_cast< uint8_t >( value ) );
+                }
+                else if( port == SerialPort + 3 )
+                {
+                    /* LCR bit 7 (DLAB) maps the divisor latch over the transmit register */
+                    this->_serialDLAB = ( value & 0x80 ) != 0;
+                }
+                else if( port == SerialPort && this->_serialDLAB == false )
+                {
+                    machine.didOutput( Output::Serial, static_cast< uint8_t >( value ) );
+                }
+                else if( port == HypercallPort && static_cast< uint8_t >( value ) == HypercallReady )
+                {
+                    this->_milestone( Milestone::Ready );
+                }
+            }
+        );
+        
         this->_engine.onValidMemoryAccess
         (
             [ & ]( uint64_t address, size_t size )
@@ -364,6 +976,11 @@ namespace UB
                     
                     if( ( address >= entry.base() && address <= entry.end() ) || ( end >= entry.base() && end <= entry.end() ) )
                     {
+                        if( this->_mmio.claimed( address, size ) )
+                        {
+                            return;
+                        }
+                        
                         throw std::runtime_error( "Access to invalid memory at address " + String::toHex( address ) );
                     }
                 }
@@ -395,8 +1012,49 @@ namespace UB
         }
     }
     
+    void Machine::IMPL::_dump( const std::string & reason )
+    {
+        std::string path;
+        
+        /* Only the first fault or interrupt is dumped, as it's the one that matters */
+        if( this->_dumped.exchange( true ) )
+        {
+            return;
+        }
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            path = this->_flightRecorderPath;
+        }
+        
+        if( path.length() == 0 )
+        {
+            this->_ui.debug() << this->_recorder.dump( reason );
+            
+            return;
+        }
+        
+        {
+            std::ofstream stream( path, std::ios::out | std::ios::trunc );
+            
+            if( stream.good() == false )
+            {
+                this->_ui.debug() << "[ ERROR ]> Cannot write flight recorder dump: " << path << std::endl;
+                
+                return;
+            }
+            
+            stream << this->_recorder.dump( reason );
+        }
+        
+        this->_ui.debug() << "[ INFO ]> Flight recorder dumped to " << path << std::endl;
+    }
+    
     void Machine::IMPL::_break( const std::string & message )
     {
+        Timeline::shared().instant( "Debug", "Break", message );
+        
         if( message.length() > 0 )
         {
             this->_ui.debug() << "[ BREAK ]> " << message << std::endl;
@@ -418,4 +1076,59 @@ namespace UB
             }
         }
     }
+    
+    bool Machine::IMPL::_reached( Milestone milestone ) const
+    {
+        for( const auto & m: this->_milestones )
+        {
+            if( std::get< 0 >( m ) == milestone )
+            {
+                return true;
+            }
+        }
+        
+        return false;
+    }
+    
+    void Machine::IMPL::_milestone( Milestone milestone )
+    {
+        std::vector< std::function< void( Milestone, uint64_t, uint64_t ) > > handlers;
+        uint64_t                                                              instructions( this->_engine.instructions() );
+        uint64_t                                                              time;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            if( this->_reached( milestone ) )
+            {
+                return;
+            }
+            
+            time = static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - this->_startTime ).count() );
+            
+            this->_milestones.push_back( { milestone, instructions, time } );
+            
+            handlers = this->_onMilestone;
+        }
+        
+        Timeline::shared().instant( "Boot", milestoneName( milestone ), std::to_string( instructions ) + " instructions" );
+        
+        {
+            std::stringstream ss;
+            
+            ss << milestoneName( milestone )
+               << ": "
+               << instructions
+               << " instructions, "
+               << std::fixed << std::setprecision( 3 ) << static_cast< double >( time ) / 1000000.0
+               << " ms";
+            
+            this->_ui.milestone( ss.str() );
+        }
+        
+        for( const auto & f: handlers )
+        {
+            f( milestone, instructions, time );
+        }
+    }
 }
@@ -27,9 +27,14 @@
 
 #include <memory>
 #include <algorithm>
+#include <functional>
+#include <optional>
 #include "UB/FAT/Image.hpp"
 #include "UB/BIOS/MemoryMap.hpp"
+#include "UB/BIOS/DiskAccess.hpp"
 #include "UB/UI.hpp"
+#include "UB/Engine.hpp"
+#include "UB/MMIO.hpp"
 
 namespace UB
 {
@@ -37,7 +42,33 @@ namespace UB
     {
         public:
             
+            enum class Output
+            {
+                TTY,
+                Serial,
+                DebugPort
+            };
+            
+            enum class Milestone
+            {
+                DiskInterrupt,
+                ProtectedMode,
+                LongMode,
+                Output,
+                Ready
+            };
+            
+            /* Guest hypercall port: writing HypercallReady to it marks the Ready milestone */
+            static const uint16_t HypercallPort  = 0x0505;
+            static const uint8_t  HypercallReady = 0x01;
+            
+            /* COM1 base: bytes written to its transmit register are Serial output */
+            static const uint16_t SerialPort     = 0x03F8;
+            
+            static std::string milestoneName( Milestone milestone );
+            
             Machine( size_t memory, const FAT::Image & fat, UI::Mode mode );
+            Machine( const BIOS::MemoryMap & memoryMap, const FAT::Image & fat, UI::Mode mode );
             Machine( const Machine & o );
             Machine( Machine && o ) noexcept;
             ~Machine( void );
@@ -47,9 +78,25 @@ namespace UB
             const FAT::Image      & bootImage( void ) const;
             const BIOS::MemoryMap & memoryMap( void ) const;
             
-            UI & ui( void ) const;
+            UI   & ui( void )   const;
+            MMIO & mmio( void ) const;
             
             void run( void );
+            void stop( void );
+            bool execute( size_t instructions );
+            bool execute( size_t instructions, uint64_t until );
+            bool yield( void ) const;
+            
+            Engine::Mode           mode( void )         const;
+            unsigned int           bits( void )         const;
+            uint64_t               pc( void )           const;
+            uint64_t               instructions( void ) const;
+            std::vector< uint8_t > read( uint64_t address, size_t size ) const;
+            void                   share( uint64_t address, size_t size, int fd, int64_t offset );
+            
+            void                     sendKeys( const std::string & keys );
+            std::optional< uint8_t > peekKey( void ) const;
+            std::optional< uint8_t > readKey( void ) const;
             
             bool breakOnInterrupt( void )       const;
             bool breakOnInterruptReturn( void ) const;
@@ -62,11 +109,33 @@ namespace UB
             void trap( bool value );
             void debugVideo( bool value );
             void singleStep( bool value );
+            
+            std::string flightRecorderPath( void ) const;
+            void        flightRecorderPath( const std::string & path );
+            
+            std::string milestoneOutput( void ) const;
+            void        milestoneOutput( const std::string & text );
+            std::string milestones( void )      const;
 
             void breakHere(        const std::string & message ) const;
             void addBreakpoint(    uint64_t address );
             void removeBreakpoint( uint64_t address );
             
+            void onDiskRead(        const std::function< void( const BIOS::DiskAccess & ) > handler );
+            void onOutput(          const std::function< void( Output, uint8_t ) > handler );
+            void onInterrupt(       const std::function< void( uint32_t ) > handler );
+            void onInterruptReturn( const std::function< void( uint32_t ) > handler );
+            void onInstruction(     const std::function< void( uint64_t ) > handler );
+            void onBlock(           const std::function< void( uint64_t, size_t ) > handler );
+            void onMemoryAccess(    uint64_t begin, uint64_t end, const std::function< void( Engine::MemoryAccess, uint64_t, size_t ) > handler );
+            void onCodeWrite(       const std::function< void( uint64_t ) > handler );
+            void onModeChange(      const std::function< void( Engine::Mode, Engine::Mode ) > handler );
+            void onVideoMode(       const std::function< void( uint8_t ) > handler );
+            void onMilestone(       const std::function< void( Milestone, uint64_t, uint64_t ) > handler );
+            void didReadDisk(     const BIOS::DiskAccess & access ) const;
+            void didOutput(       Output output, uint8_t c )          const;
+            void didSetVideoMode( uint8_t mode )                      const;
+            
             friend void swap( Machine & o1, Machine & o2 );
             
         private:
@@ -0,0 +1,232 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/PerfCounters.hpp"
+#include <vector>
+#include <ctime>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace UB
+{
+    class PerfCounters::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            ~IMPL( void );
+            
+            void   _open( uint32_t type, uint64_t config, Counter counter );
+            Values _readSoftware( void ) const;
+            
+            int                                      _leader;
+            std::vector< std::pair< int, Counter > > _events;
+    };
+    
+    std::string PerfCounters::name( Counter counter )
+    {
+        switch( counter )
+        {
+            case Counter::TaskClock:       return "task-clock";
+            case Counter::ContextSwitches: return "context-switches";
+            case Counter::Cycles:          return "cycles";
+            case Counter::Instructions:    return "instructions";
+        }
+        
+        return "unknown";
+    }
+    
+    PerfCounters::PerfCounters( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    PerfCounters::~PerfCounters( void )
+    {}
+    
+    bool PerfCounters::available( Counter counter ) const
+    {
+        if( this->impl->_leader < 0 )
+        {
+            return counter == Counter::TaskClock || counter == Counter::ContextSwitches;
+        }
+        
+        for( const auto & event: this->impl->_events )
+        {
+            if( event.second == counter )
+            {
+                return true;
+            }
+        }
+        
+        return false;
+    }
+    
+    std::string PerfCounters::source( void ) const
+    {
+        if( this->impl->_leader < 0 )
+        {
+            return "software (thread CPU time, rusage)";
+        }
+        
+        if( this->available( Counter::Cycles ) )
+        {
+            return "perf_event (hardware and software)";
+        }
+        
+        return "perf_event (software only)";
+    }
+    
+    PerfCounters::Values PerfCounters::read( void ) const
+    {
+        Values values;
+        
+        values.fill( 0 );
+        
+        if( this->impl->_leader < 0 )
+        {
+            return this->impl->_readSoftware();
+        }
+        
+        #ifdef __linux__
+        {
+            std::vector< uint64_t > data( this->impl->_events.size() + 1, 0 );
+            ssize_t                 size( static_cast< ssize_t >( data.size() * sizeof( uint64_t ) ) );
+            
+            if( ::read( this->impl->_leader, &( data[ 0 ] ), static_cast< size_t >( size ) ) != size )
+            {
+                return values;
+            }
+            
+            for( size_t i = 0; i < this->impl->_events.size() && i < data[ 0 ]; i++ )
+            {
+                values[ static_cast< size_t >( this->impl->_events[ i ].second ) ] = data[ i + 1 ];
+            }
+        }
+        #endif
+        
+        return values;
+    }
+    
+    PerfCounters::IMPL::IMPL( void ):
+        _leader( -1 )
+    {
+        #ifdef __linux__
+        
+        this->_open( PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,       Counter::TaskClock );
+        this->_open( PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, Counter::ContextSwitches );
+        this->_open( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       Counter::Cycles );
+        this->_open( PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     Counter::Instructions );
+        
+        if( this->_leader >= 0 )
+        {
+            ioctl( this->_leader, PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP );
+            ioctl( this->_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+        }
+        
+        #endif
+    }
+    
+    PerfCounters::IMPL::~IMPL( void )
+    {
+        for( const auto & event: this->_events )
+        {
+            close( event.first );
+        }
+    }
+    
+    void PerfCounters::IMPL::_open( uint32_t type, uint64_t config, Counter counter )
+    {
+        #ifdef __linux__
+        
+        perf_event_attr attr;
+        int             fd;
+        
+        /* Hardware counters are optional, but the group needs its task-clock leader */
+        if( this->_leader < 0 && counter != Counter::TaskClock )
+        {
+            return;
+        }
+        
+        std::fill( reinterpret_cast< char * >( &attr ), reinterpret_cast< char * >( &attr ) + sizeof( attr ), 0 );
+        
+        attr.type           = type;
+        attr.size           = sizeof( attr );
+        attr.config         = config;
+        attr.disabled       = ( this->_leader < 0 ) ? 1 : 0;
+        attr.exclude_kernel = ( type == PERF_TYPE_HARDWARE ) ? 1 : 0;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP;
+        
+        if( ( fd = static_cast< int >( syscall( SYS_perf_event_open, &attr, 0, -1, this->_leader, 0 ) ) ) < 0 )
+        {
+            return;
+        }
+        
+        if( this->_leader < 0 )
+        {
+            this->_leader = fd;
+        }
+        
+        this->_events.push_back( { fd, counter } );
+        
+        #else
+        
+        ( void )type;
+        ( void )config;
+        ( void )counter;
+        
+        #endif
+    }
+    
+    PerfCounters::Values PerfCounters::IMPL::_readSoftware( void ) const
+    {
+        Values          values;
+        struct timespec ts;
+        struct rusage   usage;
+        
+        values.fill( 0 );
+        
+        if( clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts ) == 0 )
+        {
+            values[ static_cast< size_t >( Counter::TaskClock ) ] = ( static_cast< uint64_t >( ts.tv_sec ) * 1000000000 ) + static_cast< uint64_t >( ts.tv_nsec );
+        }
+        
+        #ifdef RUSAGE_THREAD
+        if( getrusage( RUSAGE_THREAD, &usage ) == 0 )
+        #else
+        if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+        #endif
+        {
+            values[ static_cast< size_t >( Counter::ContextSwitches ) ] = static_cast< uint64_t >( usage.ru_nvcsw + usage.ru_nivcsw );
+        }
+        
+        return values;
+    }
+}
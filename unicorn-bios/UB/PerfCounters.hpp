@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_PERF_COUNTERS_HPP
+#define UB_PERF_COUNTERS_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <array>
+
+namespace UB
+{
+    /*!
+     * Host performance counters for the calling thread.
+     * 
+     * On Linux, the counters come from perf_event_open, read as a single
+     * group. Cycles and instructions need a PMU, so they may be missing
+     * (e.g. in virtual machines or containers). When perf events are not
+     * available at all, thread CPU time and rusage stand in for
+     * task-clock and context switches.
+     */
+    class PerfCounters
+    {
+        public:
+            
+            enum class Counter: size_t
+            {
+                TaskClock       = 0,
+                ContextSwitches = 1,
+                Cycles          = 2,
+                Instructions    = 3
+            };
+            
+            typedef std::array< uint64_t, 4 > Values;
+            
+            static std::string name( Counter counter );
+            
+            PerfCounters( void );
+            ~PerfCounters( void );
+            
+            PerfCounters( const PerfCounters & o )              = delete;
+            PerfCounters( PerfCounters && o )                   = delete;
+            PerfCounters & operator =( const PerfCounters & o ) = delete;
+            PerfCounters & operator =( PerfCounters && o )      = delete;
+            
+            bool        available( Counter counter ) const;
+            std::string source( void )                const;
+            Values      read( void )                  const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_PERF_COUNTERS_HPP */
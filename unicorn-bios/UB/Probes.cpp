@@ -0,0 +1,44 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/Probes.hpp"
+
+#ifdef UB_USDT
+
+/*
+ * Probe semaphores, in the section where tracers look for them. A tracer
+ * increments a probe's semaphore while attached to it.
+ */
+#define UB_PROBE_SEMAPHORE_DEFINE( name ) unsigned short unicorn_bios_ ## name ## _semaphore __attribute__( ( section( ".probes" ) ) ) = 0
+
+UB_PROBE_SEMAPHORE_DEFINE( engine_start );
+UB_PROBE_SEMAPHORE_DEFINE( engine_stop );
+UB_PROBE_SEMAPHORE_DEFINE( exception );
+UB_PROBE_SEMAPHORE_DEFINE( mode_switch );
+UB_PROBE_SEMAPHORE_DEFINE( interrupt_entry );
+UB_PROBE_SEMAPHORE_DEFINE( interrupt_return );
+UB_PROBE_SEMAPHORE_DEFINE( disk_read );
+UB_PROBE_SEMAPHORE_DEFINE( breakpoint );
+
+#endif
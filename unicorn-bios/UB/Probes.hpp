@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_PROBES_HPP
+#define UB_PROBES_HPP
+
+/*
+ * USDT probes for the "unicorn_bios" provider (see README, "Build options").
+ * 
+ * On Linux, when <sys/sdt.h> is available, each probe compiles to a single
+ * nop plus an ELF note that perf, bpftrace or SystemTap can attach to at
+ * runtime. The nop doesn't stop its arguments from being computed, so a
+ * probe whose arguments aren't already at hand goes in an
+ * if( UB_PROBE_ENABLED( name ) ) block: the semaphore it tests is only set
+ * while a tracer is attached (see Probes.cpp).
+ * 
+ * Elsewhere, or when UB_NO_USDT is defined, probes expand to nothing,
+ * UB_PROBE_ENABLED is false and no argument is evaluated.
+ */
+
+#if defined( __linux__ ) && !defined( UB_NO_USDT ) && defined( __has_include )
+    #if __has_include( <sys/sdt.h> )
+        #define _SDT_HAS_SEMAPHORES 1
+        #include <sys/sdt.h>
+        #define UB_USDT 1
+    #endif
+#endif
+
+#ifdef UB_USDT
+    #define UB_PROBE_SEMAPHORE( name ) extern unsigned short unicorn_bios_ ## name ## _semaphore
+    
+    UB_PROBE_SEMAPHORE( engine_start );
+    UB_PROBE_SEMAPHORE( engine_stop );
+    UB_PROBE_SEMAPHORE( exception );
+    UB_PROBE_SEMAPHORE( mode_switch );
+    UB_PROBE_SEMAPHORE( interrupt_entry );
+    UB_PROBE_SEMAPHORE( interrupt_return );
+    UB_PROBE_SEMAPHORE( disk_read );
+    UB_PROBE_SEMAPHORE( breakpoint );
+    
+    #define UB_PROBE_ENABLED( name ) __builtin_expect( unicorn_bios_ ## name ## _semaphore != 0, 0 )
+    #define UB_PROBE1( name, a1 )                 DTRACE_PROBE1( unicorn_bios, name, a1 )
+    #define UB_PROBE2( name, a1, a2 )             DTRACE_PROBE2( unicorn_bios, name, a1, a2 )
+    #define UB_PROBE3( name, a1, a2, a3 )         DTRACE_PROBE3( unicorn_bios, name, a1, a2, a3 )
+    #define UB_PROBE5( name, a1, a2, a3, a4, a5 ) DTRACE_PROBE5( unicorn_bios, name, a1, a2, a3, a4, a5 )
+#else
+    #define UB_PROBE_ENABLED( name ) false
+    #define UB_PROBE1( name, a1 )
+    #define UB_PROBE2( name, a1, a2 )
+    #define UB_PROBE3( name, a1, a2, a3 )
+    #define UB_PROBE5( name, a1, a2, a3, a4, a5 )
+#endif
+
+#endif /* UB_PROBES_HPP */
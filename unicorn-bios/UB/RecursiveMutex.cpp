@@ -0,0 +1,400 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/RecursiveMutex.hpp"
+
+#ifdef UB_LOCK_STATS
+
+#include "UB/String.hpp"
+#include <atomic>
+#include <array>
+#include <map>
+#include <vector>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <execinfo.h>
+
+namespace UB
+{
+    class LockStats
+    {
+        public:
+            
+            /* Return addresses above RecursiveMutex::lock(), resolved to the first one outside the locking code when reported */
+            static constexpr size_t Depth = 4;
+            
+            typedef std::array< void *, Depth > Frames;
+            
+            LockStats( void ):
+                _acquisitions( 0 ),
+                _contended(    0 ),
+                _wait(         0 ),
+                _maxWait(      0 ),
+                _histogram(    {} )
+            {}
+            
+            std::atomic< uint64_t >                 _acquisitions;
+            std::atomic< uint64_t >                 _contended;
+            std::atomic< uint64_t >                 _wait;
+            std::atomic< uint64_t >                 _maxWait;
+            std::array< std::atomic< uint64_t >, 6 > _histogram;
+            std::map< Frames, uint64_t >             _holders;
+            std::mutex                               _mtx;
+    };
+    
+    class RecursiveMutex::IMPL
+    {
+        public:
+            
+            IMPL( const std::string & name );
+            ~IMPL( void );
+            
+            static std::map< std::string, LockStats * > & _stats( void );
+            static std::mutex                           & _statsMutex( void );
+            static std::string                            _name( void * address );
+            static std::string                            _symbol( void * address );
+            static std::string                            _caller( const LockStats::Frames & frames );
+            
+            void _acquired( void );
+            
+            std::recursive_mutex                                  _rmtx;
+            LockStats                                           * _lockStats;
+            std::array< std::atomic< void * >, LockStats::Depth > _holder;
+            size_t                                                _depth;
+    };
+    
+    std::string RecursiveMutex::report( void )
+    {
+        std::lock_guard< std::mutex > l( IMPL::_statsMutex() );
+        std::stringstream             ss;
+        
+        ss << "Lock statistics:" << std::endl;
+        
+        for( const auto & p: IMPL::_stats() )
+        {
+            LockStats                                        & stats( *( p.second ) );
+            std::map< std::string, uint64_t >                  callers;
+            std::vector< std::pair< std::string, uint64_t > >  holders;
+            uint64_t                                           contended( stats._contended );
+            
+            {
+                std::lock_guard< std::mutex > hl( stats._mtx );
+                
+                for( const auto & holder: stats._holders )
+                {
+                    callers[ IMPL::_caller( holder.first ) ] += holder.second;
+                }
+            }
+            
+            holders.assign( callers.begin(), callers.end() );
+            
+            std::sort
+            (
+                holders.begin(),
+                holders.end(),
+                []( const std::pair< std::string, uint64_t > & o1, const std::pair< std::string, uint64_t > & o2 ) -> bool
+                {
+                    return o1.second > o2.second;
+                }
+            );
+            
+            ss << std::endl
+               << "    " << p.first << ":" << std::endl
+               << "        Acquisitions: " << stats._acquisitions << std::endl
+               << "        Contended:    " << contended;
+            
+            if( stats._acquisitions > 0 )
+            {
+                ss << " (" << std::fixed << std::setprecision( 2 ) << ( static_cast< double >( contended ) * 100.0 ) / static_cast< double >( stats._acquisitions ) << "%)";
+            }
+            
+            ss << std::endl
+               << "        Total wait:   " << stats._wait / 1000 << " us" << std::endl
+               << "        Max wait:     " << stats._maxWait / 1000 << " us" << std::endl;
+            
+            if( contended == 0 )
+            {
+                continue;
+            }
+            
+            ss << "        Wait histogram:" << std::endl
+               << "            < 1 us:    " << stats._histogram[ 0 ] << std::endl
+               << "            < 10 us:   " << stats._histogram[ 1 ] << std::endl
+               << "            < 100 us:  " << stats._histogram[ 2 ] << std::endl
+               << "            < 1 ms:    " << stats._histogram[ 3 ] << std::endl
+               << "            < 10 ms:   " << stats._histogram[ 4 ] << std::endl
+               << "            >= 10 ms:  " << stats._histogram[ 5 ] << std::endl
+               << "        Held by (when contended):" << std::endl;
+            
+            for( size_t i = 0; i < holders.size() && i < 5; i++ )
+            {
+                ss << "            " << std::setw( 10 ) << holders[ i ].second << "  " << holders[ i ].first << std::endl;
+            }
+        }
+        
+        return ss.str();
+    }
+    
+    std::string RecursiveMutex::summary( void )
+    {
+        std::lock_guard< std::mutex > l( IMPL::_statsMutex() );
+        std::string                   name;
+        uint64_t                      wait( 0 );
+        
+        for( const auto & p: IMPL::_stats() )
+        {
+            if( p.second->_wait > wait )
+            {
+                name = p.first;
+                wait = p.second->_wait;
+            }
+        }
+        
+        if( wait == 0 )
+        {
+            return "";
+        }
+        
+        return "Lock wait: " + name + " " + std::to_string( wait / 1000 ) + " us";
+    }
+    
+    RecursiveMutex::RecursiveMutex( const std::string & name ):
+        impl( std::make_unique< IMPL >( name ) )
+    {}
+    
+    RecursiveMutex::~RecursiveMutex( void )
+    {}
+    
+    void RecursiveMutex::lock( void )
+    {
+        LockStats & stats( *( this->impl->_lockStats ) );
+        
+        if( this->impl->_rmtx.try_lock() == false )
+        {
+            LockStats::Frames holder;
+            auto              start( std::chrono::steady_clock::now() );
+            uint64_t          wait;
+            uint64_t          max;
+            size_t            bucket( 0 );
+            
+            for( size_t i = 0; i < holder.size(); i++ )
+            {
+                holder[ i ] = this->impl->_holder[ i ].load( std::memory_order_relaxed );
+            }
+            
+            this->impl->_rmtx.lock();
+            
+            wait = static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start ).count() );
+            
+            for( uint64_t limit = 1000; bucket < stats._histogram.size() - 1 && wait >= limit; limit *= 10 )
+            {
+                bucket++;
+            }
+            
+            stats._contended++;
+            stats._histogram[ bucket ]++;
+            
+            stats._wait += wait;
+            
+            max = stats._maxWait.load( std::memory_order_relaxed );
+            
+            while( wait > max && stats._maxWait.compare_exchange_weak( max, wait, std::memory_order_relaxed ) == false )
+            {}
+            
+            {
+                std::lock_guard< std::mutex > l( stats._mtx );
+                
+                stats._holders[ holder ]++;
+            }
+        }
+        
+        this->impl->_acquired();
+    }
+    
+    void RecursiveMutex::unlock( void )
+    {
+        if( --( this->impl->_depth ) == 0 )
+        {
+            for( auto & frame: this->impl->_holder )
+            {
+                frame.store( nullptr, std::memory_order_relaxed );
+            }
+        }
+        
+        this->impl->_rmtx.unlock();
+    }
+    
+    bool RecursiveMutex::try_lock( void )
+    {
+        if( this->impl->_rmtx.try_lock() == false )
+        {
+            return false;
+        }
+        
+        this->impl->_acquired();
+        
+        return true;
+    }
+    
+    RecursiveMutex::IMPL::IMPL( const std::string & name ):
+        _lockStats( nullptr ),
+        _holder(    {} ),
+        _depth(     0 )
+    {
+        std::lock_guard< std::mutex > l( _statsMutex() );
+        LockStats                 * & stats( _stats()[ name ] );
+        
+        if( stats == nullptr )
+        {
+            stats = new LockStats();
+        }
+        
+        this->_lockStats = stats;
+    }
+    
+    RecursiveMutex::IMPL::~IMPL( void )
+    {}
+    
+    std::map< std::string, LockStats * > & RecursiveMutex::IMPL::_stats( void )
+    {
+        static std::map< std::string, LockStats * > * stats( nullptr );
+        static std::once_flag                        once;
+        
+        std::call_once( once, [ & ]{ stats = new std::map< std::string, LockStats * >(); } );
+        
+        return *( stats );
+    }
+    
+    std::mutex & RecursiveMutex::IMPL::_statsMutex( void )
+    {
+        static std::mutex   * mtx( nullptr );
+        static std::once_flag once;
+        
+        std::call_once( once, [ & ]{ mtx = new std::mutex(); } );
+        
+        return *( mtx );
+    }
+    
+    std::string RecursiveMutex::IMPL::_name( void * address )
+    {
+        Dl_info info;
+        
+        if( address == nullptr || dladdr( address, &info ) == 0 || info.dli_sname == nullptr )
+        {
+            return "";
+        }
+        
+        {
+            int         status( 0 );
+            char      * demangled( abi::__cxa_demangle( info.dli_sname, nullptr, nullptr, &status ) );
+            std::string name( ( status == 0 && demangled != nullptr ) ? demangled : info.dli_sname );
+            
+            free( demangled );
+            
+            return name;
+        }
+    }
+    
+    std::string RecursiveMutex::IMPL::_symbol( void * address )
+    {
+        Dl_info     info;
+        std::string name( _name( address ) );
+        
+        if( address == nullptr )
+        {
+            return "(unknown)";
+        }
+        
+        if( name.length() > 0 && dladdr( address, &info ) != 0 )
+        {
+            return name + " + " + std::to_string( reinterpret_cast< uintptr_t >( address ) - reinterpret_cast< uintptr_t >( info.dli_saddr ) );
+        }
+        
+        return String::toHex( reinterpret_cast< uintptr_t >( address ) );
+    }
+    
+    std::string RecursiveMutex::IMPL::_caller( const LockStats::Frames & frames )
+    {
+        /* Depending on inlining, lock() is called directly or through lock_guard and friends */
+        for( void * frame: frames )
+        {
+            std::string name( _name( frame ) );
+            
+            if( name.find( "UB::RecursiveMutex::" ) == 0 || name.find( "std::lock_guard<" ) == 0 || name.find( "std::unique_lock<" ) == 0 || name.find( "std::scoped_lock<" ) == 0 )
+            {
+                continue;
+            }
+            
+            return _symbol( frame );
+        }
+        
+        return _symbol( nullptr );
+    }
+    
+    void RecursiveMutex::IMPL::_acquired( void )
+    {
+        std::array< void *, LockStats::Depth + 1 > frames{};
+        int                                        n;
+        
+        this->_lockStats->_acquisitions++;
+        
+        if( this->_depth++ > 0 )
+        {
+            return;
+        }
+        
+        /* The first frame is in this function, the rest are resolved by _caller() */
+        n = backtrace( frames.data(), static_cast< int >( frames.size() ) );
+        
+        for( size_t i = 0; i < this->_holder.size(); i++ )
+        {
+            this->_holder[ i ].store( ( static_cast< int >( i ) + 1 < n ) ? frames[ i + 1 ] : nullptr, std::memory_order_relaxed );
+        }
+    }
+}
+
+#else
+
+namespace UB
+{
+    std::string RecursiveMutex::report( void )
+    {
+        return "";
+    }
+    
+    std::string RecursiveMutex::summary( void )
+    {
+        return "";
+    }
+    
+    RecursiveMutex::RecursiveMutex( const std::string & name )
+    {
+        ( void )name;
+    }
+}
+
+#endif
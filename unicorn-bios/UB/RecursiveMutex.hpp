@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_RECURSIVE_MUTEX_HPP
+#define UB_RECURSIVE_MUTEX_HPP
+
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <mutex>
+
+namespace UB
+{
+    #ifdef UB_LOCK_STATS
+    
+    class RecursiveMutex
+    {
+        public:
+            
+            static std::string report( void );
+            static std::string summary( void );
+            
+            RecursiveMutex( const std::string & name );
+            ~RecursiveMutex( void );
+            
+            RecursiveMutex( const RecursiveMutex & o )              = delete;
+            RecursiveMutex( RecursiveMutex && o )                   = delete;
+            RecursiveMutex & operator =( const RecursiveMutex & o ) = delete;
+            RecursiveMutex & operator =( RecursiveMutex && o )      = delete;
+            
+            void lock( void );
+            void unlock( void );
+            bool try_lock( void );
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+    
+    #else
+    
+    class RecursiveMutex: public std::recursive_mutex
+    {
+        public:
+            
+            static std::string report( void );
+            static std::string summary( void );
+            
+            RecursiveMutex( const std::string & name );
+    };
+    
+    #endif
+}
+
+#endif /* UB_RECURSIVE_MUTEX_HPP */
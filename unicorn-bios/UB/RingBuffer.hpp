@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_RING_BUFFER_HPP
+#define UB_RING_BUFFER_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <algorithm>
+
+namespace UB
+{
+    /*!
+     * Bounded lock-free queue for exactly one producer thread and one
+     * consumer thread. The capacity is rounded up to a power of two.
+     */
+    template< typename _T_ >
+    class RingBuffer
+    {
+        public:
+            
+            RingBuffer( size_t capacity ):
+                _mask( 0 ),
+                _head( 0 ),
+                _tail( 0 )
+            {
+                size_t size( 2 );
+                
+                while( size < capacity )
+                {
+                    size <<= 1;
+                }
+                
+                this->_items.resize( size );
+                
+                this->_mask = size - 1;
+            }
+            
+            RingBuffer( const RingBuffer & o )              = delete;
+            RingBuffer( RingBuffer && o )                   = delete;
+            RingBuffer & operator =( const RingBuffer & o ) = delete;
+            RingBuffer & operator =( RingBuffer && o )      = delete;
+            
+            size_t capacity( void ) const
+            {
+                return this->_items.size();
+            }
+            
+            size_t size( void ) const
+            {
+                return this->_tail.load( std::memory_order_acquire ) - this->_head.load( std::memory_order_acquire );
+            }
+            
+            bool push( const _T_ & item )
+            {
+                size_t tail( this->_tail.load( std::memory_order_relaxed ) );
+                
+                if( tail - this->_head.load( std::memory_order_acquire ) == this->_items.size() )
+                {
+                    return false;
+                }
+                
+                this->_items[ tail & this->_mask ] = item;
+                
+                this->_tail.store( tail + 1, std::memory_order_release );
+                
+                return true;
+            }
+            
+            size_t pop( _T_ * items, size_t max )
+            {
+                size_t head( this->_head.load( std::memory_order_relaxed ) );
+                size_t n( std::min( max, this->_tail.load( std::memory_order_acquire ) - head ) );
+                
+                for( size_t i = 0; i < n; i++ )
+                {
+                    items[ i ] = this->_items[ ( head + i ) & this->_mask ];
+                }
+                
+                this->_head.store( head + n, std::memory_order_release );
+                
+                return n;
+            }
+        
+        private:
+            
+            std::vector< _T_ >                  _items;
+            size_t                              _mask;
+            alignas( 64 ) std::atomic< size_t > _head;
+            alignas( 64 ) std::atomic< size_t > _tail;
+    };
+}
+
+#endif /* UB_RING_BUFFER_HPP */
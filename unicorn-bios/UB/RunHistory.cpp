@@ -0,0 +1,442 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/RunHistory.hpp"
+#include <mutex>
+#include <vector>
+#include <map>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace UB
+{
+    class RunHistory::IMPL
+    {
+        public:
+            
+            class Metric
+            {
+                public:
+                    
+                    std::string _name;
+                    bool        _higherIsBetter;
+            };
+            
+            IMPL( void );
+            ~IMPL( void );
+            
+            static const std::vector< std::string > & _columns( void );
+            static const std::vector< Metric >      & _metrics( void );
+            static uint64_t                           _now( void );
+            static double                             _percentile( std::vector< uint64_t > values, double p );
+            static double                             _critical( size_t df );
+            static std::vector< std::string >         _split( const std::string & line );
+            static std::string                        _format( double value );
+            
+            mutable std::mutex                             _mtx;
+            uint64_t                                       _start;
+            uint64_t                                       _end;
+            uint64_t                                       _instructions;
+            uint64_t                                       _firstOutput;
+            std::vector< std::pair< uint32_t, uint64_t > > _pending;
+            std::vector< uint64_t >                        _latencies;
+            uint64_t                                       _diskBytes;
+            uint64_t                                       _diskTime;
+    };
+    
+    bool RunHistory::check( const std::string & path, const std::string & image, size_t window, std::ostream & os )
+    {
+        std::ifstream                                        stream( path );
+        std::string                                          line;
+        std::vector< std::string >                           header;
+        std::vector< std::map< std::string, std::string > > runs;
+        std::vector< std::map< std::string, std::string > > baseline;
+        bool                                                 regressed( false );
+        
+        if( stream.good() == false || std::getline( stream, line ).good() == false )
+        {
+            throw std::runtime_error( "Cannot read run history: " + path );
+        }
+        
+        header = IMPL::_split( line );
+        
+        while( std::getline( stream, line ) )
+        {
+            std::vector< std::string >           values( IMPL::_split( line ) );
+            std::map< std::string, std::string > run;
+            
+            for( size_t i = 0; i < header.size() && i < values.size(); i++ )
+            {
+                run[ header[ i ] ] = values[ i ];
+            }
+            
+            if( run[ "image" ] == image )
+            {
+                runs.push_back( run );
+            }
+        }
+        
+        if( runs.size() < 2 )
+        {
+            os << "Run history: " << runs.size() << " run(s) of this image, nothing to compare" << std::endl;
+            
+            return false;
+        }
+        
+        window = ( window == 0 ) ? 10 : window;
+        
+        baseline.assign( runs.end() - static_cast< std::ptrdiff_t >( std::min( window, runs.size() - 1 ) ) - 1, runs.end() - 1 );
+        
+        os << "Run history: "
+           << image.substr( 0, 16 )
+           << ", latest run built " << runs.back()[ "build" ]
+           << ", baseline of " << baseline.size() << " run(s)"
+           << std::endl
+           << std::endl
+           << std::left
+           << std::setw( 18 ) << "Metric"
+           << std::right
+           << std::setw( 14 ) << "Baseline"
+           << std::setw( 12 ) << "Stddev"
+           << std::setw( 14 ) << "Latest"
+           << std::setw( 10 ) << "Change"
+           << "  Verdict"
+           << std::endl;
+        
+        for( const auto & metric: IMPL::_metrics() )
+        {
+            std::vector< double > values;
+            std::string           latest( runs.back()[ metric._name ] );
+            double                mean( 0 );
+            double                deviation( 0 );
+            double                x;
+            double                worse;
+            double                change;
+            std::string           verdict;
+            
+            for( auto & run: baseline )
+            {
+                if( run[ metric._name ].length() > 0 )
+                {
+                    values.push_back( std::strtod( run[ metric._name ].c_str(), nullptr ) );
+                }
+            }
+            
+            if( latest.length() == 0 || values.size() < 3 )
+            {
+                os << std::left << std::setw( 18 ) << metric._name << std::right << "  not enough data" << std::endl;
+                
+                continue;
+            }
+            
+            for( double v: values )
+            {
+                mean += v;
+            }
+            
+            mean /= static_cast< double >( values.size() );
+            
+            for( double v: values )
+            {
+                deviation += ( v - mean ) * ( v - mean );
+            }
+            
+            deviation = std::sqrt( deviation / static_cast< double >( values.size() - 1 ) );
+            x         = std::strtod( latest.c_str(), nullptr );
+            worse     = ( metric._higherIsBetter ) ? mean - x : x - mean;
+            change    = ( mean != 0 ) ? ( x - mean ) / mean : 0;
+            
+            /*
+             * The latest run is a single sample, so it is tested against the
+             * prediction interval of the baseline (one-sided, 99%). Changes
+             * under 2% are ignored, as a quiet baseline would otherwise flag
+             * any noise.
+             */
+            if( std::fabs( change ) < 0.02 )
+            {
+                verdict = "ok";
+            }
+            else if( deviation == 0 || worse / ( deviation * std::sqrt( 1.0 + ( 1.0 / static_cast< double >( values.size() ) ) ) ) > IMPL::_critical( values.size() - 1 ) )
+            {
+                verdict = ( worse > 0 ) ? "REGRESSION" : "improved";
+            }
+            else
+            {
+                verdict = "ok";
+            }
+            
+            regressed = regressed || verdict == "REGRESSION";
+            
+            os << std::left
+               << std::setw( 18 ) << metric._name
+               << std::right
+               << std::setw( 14 ) << IMPL::_format( mean )
+               << std::setw( 12 ) << IMPL::_format( deviation )
+               << std::setw( 14 ) << latest
+               << std::setw( 9 )  << std::fixed << std::setprecision( 1 ) << ( change * 100 ) << "%"
+               << "  " << verdict
+               << std::endl;
+        }
+        
+        return regressed;
+    }
+    
+    RunHistory::RunHistory( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    RunHistory::~RunHistory( void )
+    {}
+    
+    void RunHistory::start( void )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_start = IMPL::_now();
+    }
+    
+    void RunHistory::stop( uint64_t instructions )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_end          = IMPL::_now();
+        this->impl->_instructions = instructions;
+    }
+    
+    void RunHistory::interrupt( uint32_t vector )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_pending.push_back( { vector, IMPL::_now() } );
+    }
+    
+    void RunHistory::interruptReturn( uint32_t vector )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( this->impl->_pending.size() == 0 || this->impl->_pending.back().first != vector )
+        {
+            return;
+        }
+        
+        this->impl->_latencies.push_back( IMPL::_now() - this->impl->_pending.back().second );
+        this->impl->_pending.pop_back();
+    }
+    
+    void RunHistory::diskRead( const BIOS::DiskAccess & access )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( access.success() )
+        {
+            this->impl->_diskBytes += access.size();
+            this->impl->_diskTime  += access.latency();
+        }
+    }
+    
+    void RunHistory::output( void )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( this->impl->_firstOutput == 0 )
+        {
+            this->impl->_firstOutput = IMPL::_now();
+        }
+    }
+    
+    void RunHistory::append( const std::string & path, const std::string & image ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        std::string                   header;
+        std::string                   existing;
+        std::vector< std::string >    row;
+        uint64_t                      end( ( this->impl->_end != 0 ) ? this->impl->_end : IMPL::_now() );
+        double                        wall( static_cast< double >( end - this->impl->_start ) / 1000000.0 );
+        
+        for( const auto & column: IMPL::_columns() )
+        {
+            header += ( ( header.length() > 0 ) ? "\t" : "" ) + column;
+        }
+        
+        {
+            std::ifstream stream( path );
+            
+            if( stream.good() && std::getline( stream, existing ) && existing.length() > 0 && existing != header )
+            {
+                throw std::runtime_error( "Run history has different columns: " + path );
+            }
+        }
+        
+        row.push_back( std::to_string( static_cast< uint64_t >( std::time( nullptr ) ) ) );
+        row.push_back( image );
+        row.push_back( UB_BUILD );
+        row.push_back( std::to_string( this->impl->_instructions ) );
+        row.push_back( IMPL::_format( wall ) );
+        row.push_back( ( wall > 0 ) ? IMPL::_format( static_cast< double >( this->impl->_instructions ) / ( wall * 1000.0 ) ) : "" );
+        
+        for( double p: { 0.50, 0.95, 0.99 } )
+        {
+            row.push_back( ( this->impl->_latencies.size() > 0 ) ? IMPL::_format( IMPL::_percentile( this->impl->_latencies, p ) / 1000.0 ) : "" );
+        }
+        
+        /* Bytes per nanosecond, times 1000 for MB/s */
+        row.push_back( ( this->impl->_diskTime > 0 ) ? IMPL::_format( ( static_cast< double >( this->impl->_diskBytes ) / static_cast< double >( this->impl->_diskTime ) ) * 1000.0 ) : "" );
+        row.push_back( ( this->impl->_firstOutput != 0 ) ? IMPL::_format( static_cast< double >( this->impl->_firstOutput - this->impl->_start ) / 1000000.0 ) : "" );
+        
+        {
+            std::ofstream stream( path, std::ios::out | std::ios::app );
+            
+            if( stream.good() == false )
+            {
+                throw std::runtime_error( "Cannot write run history: " + path );
+            }
+            
+            if( existing.length() == 0 )
+            {
+                stream << header << std::endl;
+            }
+            
+            for( size_t i = 0; i < row.size(); i++ )
+            {
+                stream << ( ( i > 0 ) ? "\t" : "" ) << row[ i ];
+            }
+            
+            stream << std::endl;
+        }
+    }
+    
+    RunHistory::IMPL::IMPL( void ):
+        _start(        0 ),
+        _end(          0 ),
+        _instructions( 0 ),
+        _firstOutput(  0 ),
+        _diskBytes(    0 ),
+        _diskTime(     0 )
+    {}
+    
+    RunHistory::IMPL::~IMPL( void )
+    {}
+    
+    const std::vector< std::string > & RunHistory::IMPL::_columns( void )
+    {
+        static const std::vector< std::string > columns
+        {
+            "time",
+            "image",
+            "build",
+            "instructions",
+            "wall_ms",
+            "mips",
+            "int_p50_us",
+            "int_p95_us",
+            "int_p99_us",
+            "disk_mbps",
+            "first_output_ms"
+        };
+        
+        return columns;
+    }
+    
+    const std::vector< RunHistory::IMPL::Metric > & RunHistory::IMPL::_metrics( void )
+    {
+        static const std::vector< Metric > metrics
+        {
+            { "mips",            true  },
+            { "int_p50_us",      false },
+            { "int_p95_us",      false },
+            { "int_p99_us",      false },
+            { "disk_mbps",       true  },
+            { "first_output_ms", false },
+            { "wall_ms",         false }
+        };
+        
+        return metrics;
+    }
+    
+    uint64_t RunHistory::IMPL::_now( void )
+    {
+        return static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+    }
+    
+    double RunHistory::IMPL::_percentile( std::vector< uint64_t > values, double p )
+    {
+        size_t rank( static_cast< size_t >( std::ceil( p * static_cast< double >( values.size() ) ) ) );
+        
+        rank = std::min( std::max< size_t >( rank, 1 ), values.size() ) - 1;
+        
+        std::nth_element( values.begin(), values.begin() + static_cast< std::ptrdiff_t >( rank ), values.end() );
+        
+        return static_cast< double >( values[ rank ] );
+    }
+    
+    double RunHistory::IMPL::_critical( size_t df )
+    {
+        /* One-sided Student's t at 99%, for 1 to 30 degrees of freedom */
+        static const std::array< double, 30 > t
+        {
+            {
+                31.821, 6.965, 4.541, 3.747, 3.365, 3.143, 2.998, 2.896, 2.821, 2.764,
+                2.718,  2.681, 2.650, 2.624, 2.602, 2.583, 2.567, 2.552, 2.539, 2.528,
+                2.518,  2.508, 2.500, 2.492, 2.485, 2.479, 2.473, 2.467, 2.462, 2.457
+            }
+        };
+        
+        return ( df >= 1 && df <= t.size() ) ? t[ df - 1 ] : 2.326;
+    }
+    
+    std::vector< std::string > RunHistory::IMPL::_split( const std::string & line )
+    {
+        std::vector< std::string > values;
+        std::stringstream          ss( line );
+        std::string                value;
+        
+        while( std::getline( ss, value, '\t' ) )
+        {
+            values.push_back( value );
+        }
+        
+        if( line.length() > 0 && line.back() == '\t' )
+        {
+            values.push_back( "" );
+        }
+        
+        return values;
+    }
+    
+    std::string RunHistory::IMPL::_format( double value )
+    {
+        std::stringstream ss;
+        
+        ss << std::fixed << std::setprecision( 3 ) << value;
+        
+        return ss.str();
+    }
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_RUN_HISTORY_HPP
+#define UB_RUN_HISTORY_HPP
+
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <ostream>
+#include "UB/BIOS/DiskAccess.hpp"
+
+#ifndef UB_BUILD
+#define UB_BUILD __DATE__ " " __TIME__
+#endif
+
+namespace UB
+{
+    /*!
+     * Collects the key metrics of a run (guest MIPS, BIOS service latency
+     * percentiles, disk throughput, time to the first output byte and
+     * wall time) and appends them as one row to a tab-separated history
+     * file, keyed by image hash and emulator build (UB_BUILD).
+     * 
+     * Rows are never rewritten. Columns are looked up by name from the
+     * header row, so new columns can be added without breaking older
+     * files being read.
+     */
+    class RunHistory
+    {
+        public:
+            
+            /* Compares the last run of an image against the runs before it, returns true if a metric regressed */
+            static bool check( const std::string & path, const std::string & image, size_t window, std::ostream & os );
+            
+            RunHistory( void );
+            ~RunHistory( void );
+            
+            RunHistory( const RunHistory & o )              = delete;
+            RunHistory( RunHistory && o )                   = delete;
+            RunHistory & operator =( const RunHistory & o ) = delete;
+            RunHistory & operator =( RunHistory && o )      = delete;
+            
+            void start( void );
+            void stop( uint64_t instructions );
+            void interrupt( uint32_t vector );
+            void interruptReturn( uint32_t vector );
+            void diskRead( const BIOS::DiskAccess & access );
+            void output( void );
+            
+            void append( const std::string & path, const std::string & image ) const;
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_RUN_HISTORY_HPP */
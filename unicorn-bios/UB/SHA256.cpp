@@ -0,0 +1,252 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/SHA256.hpp"
+#include <array>
+#include <sstream>
+#include <iomanip>
+
+namespace UB
+{
+    class SHA256::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            IMPL( const IMPL & o );
+            ~IMPL( void );
+            
+            void _transform( const uint8_t * block );
+            
+            std::array< uint32_t, 8 > _state;
+            std::array< uint8_t, 64 > _buffer;
+            size_t                    _bufferSize;
+            uint64_t                  _length;
+    };
+    
+    static const std::array< uint32_t, 64 > k =
+    {
+        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+    };
+    
+    static inline uint32_t rotr( uint32_t x, unsigned int n )
+    {
+        return ( x >> n ) | ( x << ( 32 - n ) );
+    }
+    
+    std::string SHA256::hash( const std::vector< uint8_t > & data )
+    {
+        return hash( data.data(), data.size() );
+    }
+    
+    std::string SHA256::hash( const uint8_t * data, size_t size )
+    {
+        SHA256 sha;
+        
+        sha.update( data, size );
+        
+        return sha.hexDigest();
+    }
+    
+    SHA256::SHA256( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    SHA256::SHA256( const SHA256 & o ):
+        impl( std::make_unique< IMPL >( *( o.impl ) ) )
+    {}
+    
+    SHA256::SHA256( SHA256 && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    SHA256::~SHA256( void )
+    {}
+    
+    SHA256 & SHA256::operator =( SHA256 o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void SHA256::update( const std::vector< uint8_t > & data )
+    {
+        this->update( data.data(), data.size() );
+    }
+    
+    void SHA256::update( const uint8_t * data, size_t size )
+    {
+        this->impl->_length += size;
+        
+        while( size > 0 )
+        {
+            size_t n( std::min( size, this->impl->_buffer.size() - this->impl->_bufferSize ) );
+            
+            memcpy( this->impl->_buffer.data() + this->impl->_bufferSize, data, n );
+            
+            this->impl->_bufferSize += n;
+            data                    += n;
+            size                    -= n;
+            
+            if( this->impl->_bufferSize == this->impl->_buffer.size() )
+            {
+                this->impl->_transform( this->impl->_buffer.data() );
+                
+                this->impl->_bufferSize = 0;
+            }
+        }
+    }
+    
+    std::vector< uint8_t > SHA256::digest( void )
+    {
+        IMPL                   ctx( *( this->impl ) );
+        uint64_t               bits( ctx._length * 8 );
+        std::vector< uint8_t > digest;
+        
+        ctx._buffer[ ctx._bufferSize++ ] = 0x80;
+        
+        if( ctx._bufferSize > 56 )
+        {
+            std::fill( ctx._buffer.begin() + static_cast< ssize_t >( ctx._bufferSize ), ctx._buffer.end(), 0 );
+            ctx._transform( ctx._buffer.data() );
+            
+            ctx._bufferSize = 0;
+        }
+        
+        std::fill( ctx._buffer.begin() + static_cast< ssize_t >( ctx._bufferSize ), ctx._buffer.begin() + 56, 0 );
+        
+        for( size_t i = 0; i < 8; i++ )
+        {
+            ctx._buffer[ 63 - i ] = static_cast< uint8_t >( bits >> ( i * 8 ) );
+        }
+        
+        ctx._transform( ctx._buffer.data() );
+        
+        for( uint32_t s: ctx._state )
+        {
+            digest.push_back( static_cast< uint8_t >( s >> 24 ) );
+            digest.push_back( static_cast< uint8_t >( s >> 16 ) );
+            digest.push_back( static_cast< uint8_t >( s >>  8 ) );
+            digest.push_back( static_cast< uint8_t >( s ) );
+        }
+        
+        return digest;
+    }
+    
+    std::string SHA256::hexDigest( void )
+    {
+        std::stringstream ss;
+        
+        for( uint8_t b: this->digest() )
+        {
+            ss << std::hex << std::setfill( '0' ) << std::setw( 2 ) << static_cast< unsigned int >( b );
+        }
+        
+        return ss.str();
+    }
+    
+    void swap( SHA256 & o1, SHA256 & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    SHA256::IMPL::IMPL( void ):
+        _state
+        (
+            {
+                0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+            }
+        ),
+        _buffer(     {} ),
+        _bufferSize( 0 ),
+        _length(     0 )
+    {}
+    
+    SHA256::IMPL::IMPL( const IMPL & o ):
+        _state(      o._state ),
+        _buffer(     o._buffer ),
+        _bufferSize( o._bufferSize ),
+        _length(     o._length )
+    {}
+    
+    SHA256::IMPL::~IMPL( void )
+    {}
+    
+    void SHA256::IMPL::_transform( const uint8_t * block )
+    {
+        std::array< uint32_t, 64 > w;
+        std::array< uint32_t, 8 >  s( this->_state );
+        
+        for( size_t i = 0; i < 16; i++ )
+        {
+            w[ i ] = ( static_cast< uint32_t >( block[ i * 4 ] ) << 24 )
+                   | ( static_cast< uint32_t >( block[ i * 4 + 1 ] ) << 16 )
+                   | ( static_cast< uint32_t >( block[ i * 4 + 2 ] ) <<  8 )
+                   |   static_cast< uint32_t >( block[ i * 4 + 3 ] );
+        }
+        
+        for( size_t i = 16; i < 64; i++ )
+        {
+            uint32_t s0( rotr( w[ i - 15 ], 7 ) ^ rotr( w[ i - 15 ], 18 ) ^ ( w[ i - 15 ] >> 3 ) );
+            uint32_t s1( rotr( w[ i - 2 ], 17 ) ^ rotr( w[ i - 2 ], 19 ) ^ ( w[ i - 2 ] >> 10 ) );
+            
+            w[ i ] = w[ i - 16 ] + s0 + w[ i - 7 ] + s1;
+        }
+        
+        for( size_t i = 0; i < 64; i++ )
+        {
+            uint32_t s1( rotr( s[ 4 ], 6 ) ^ rotr( s[ 4 ], 11 ) ^ rotr( s[ 4 ], 25 ) );
+            uint32_t ch( ( s[ 4 ] & s[ 5 ] ) ^ ( ~s[ 4 ] & s[ 6 ] ) );
+            uint32_t t1( s[ 7 ] + s1 + ch + k[ i ] + w[ i ] );
+            uint32_t s0( rotr( s[ 0 ], 2 ) ^ rotr( s[ 0 ], 13 ) ^ rotr( s[ 0 ], 22 ) );
+            uint32_t mj( ( s[ 0 ] & s[ 1 ] ) ^ ( s[ 0 ] & s[ 2 ] ) ^ ( s[ 1 ] & s[ 2 ] ) );
+            uint32_t t2( s0 + mj );
+            
+            s[ 7 ] = s[ 6 ];
+            s[ 6 ] = s[ 5 ];
+            s[ 5 ] = s[ 4 ];
+            s[ 4 ] = s[ 3 ] + t1;
+            s[ 3 ] = s[ 2 ];
+            s[ 2 ] = s[ 1 ];
+            s[ 1 ] = s[ 0 ];
+            s[ 0 ] = t1 + t2;
+        }
+        
+        for( size_t i = 0; i < 8; i++ )
+        {
+            this->_state[ i ] += s[ i ];
+        }
+    }
+}
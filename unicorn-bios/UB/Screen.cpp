@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "UB/Screen.hpp"
+#include "UB/RecursiveMutex.hpp"
 #include <algorithm>
 #include <ncurses.h>
 #include <sys/ioctl.h>
@@ -51,9 +52,14 @@ namespace UB
             std::size_t          _height;
             bool                 _colors;
             bool                 _running;
-            std::recursive_mutex _rmtx;
+            FILE               * _output;
+            FILE               * _input;
+            RecursiveMutex       _rmtx;
     };
     
+    static FILE * terminalOutput( nullptr );
+    static FILE * terminalInput( nullptr );
+    
     Screen & Screen::shared( void )
     {
         static Screen       * screen( nullptr );
@@ -64,12 +70,24 @@ namespace UB
         return *( screen );
     }
     
+    void Screen::terminal( FILE * output, FILE * input )
+    {
+        terminalOutput = output;
+        terminalInput  = input;
+    }
+    
     Screen::Screen( void ):
         impl( std::make_unique< IMPL >() )
     {
         struct winsize s;
         
-        ::initscr();
+        this->impl->_output = ( terminalOutput != nullptr ) ? terminalOutput : stdout;
+        this->impl->_input  = ( terminalInput  != nullptr ) ? terminalInput  : stdin;
+        
+        if( ::newterm( nullptr, this->impl->_output, this->impl->_input ) == nullptr )
+        {
+            throw std::runtime_error( "Cannot initialize terminal" );
+        }
         
         if( ::has_colors() )
         {
@@ -95,7 +113,7 @@ namespace UB
         ::keypad( stdscr, true );
         this->refresh();
         
-        ::ioctl( STDOUT_FILENO, TIOCGWINSZ, &s );
+        ::ioctl( fileno( this->impl->_output ), TIOCGWINSZ, &s );
         
         this->impl->_width  = s.ws_col;
         this->impl->_height = s.ws_row;
@@ -103,63 +121,63 @@ namespace UB
     
     std::size_t Screen::width( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_width;
     }
     
     std::size_t Screen::height( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_height;
     }
     
     bool Screen::supportsColors( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_colors;
     }
     
     void Screen::disableColors( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_colors = false;
     }
     
     bool Screen::isRunning( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_running;
     }
     
     void Screen::clear( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         ::clear();
     }
     
     void Screen::refresh( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         ::refresh();
     }
     
     void Screen::print( const std::string & s )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         ::printw( s.c_str() );
     }
     
     void Screen::print( const Color & color, const std::string & s )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
     
         if( this->supportsColors() )
         {
@@ -177,7 +195,7 @@ namespace UB
     void Screen::start( void )
     {
         {
-            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
             
             if( this->impl->_running )
             {
@@ -195,10 +213,10 @@ namespace UB
             std::vector< std::function< void( void ) > > onUpdate;
             int                                          key( 0 );
             
-            ::ioctl( STDOUT_FILENO, TIOCGWINSZ, &s );
+            ::ioctl( fileno( this->impl->_output ), TIOCGWINSZ, &s );
             
             {
-                std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
                 
                 onKeyPress = this->impl->_onKeyPress;
                 onUpdate   = this->impl->_onUpdate;
@@ -216,13 +234,13 @@ namespace UB
                     
                     memset( &p, 0, sizeof( p ) );
                     
-                    p.fd      = 0;
+                    p.fd      = fileno( this->impl->_input );
                     p.events  = POLLIN;
                     p.revents = 0;
                     
                     if( poll( &p, 1, 0 ) > 0 )
                     {
-                        key        = getc( stdin );
+                        key        = getc( this->impl->_input );
                         onKeyPress = this->impl->_onKeyPress;
                     }
                 }
@@ -252,28 +270,28 @@ namespace UB
     
     void Screen::stop( void )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_running = false;
     }
     
     void Screen::onResize( const std::function< void( void ) > & f )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_onResize.push_back( f );
     }
     
     void Screen::onKeyPress( const std::function< void( int key ) > & f )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_onKeyPress.push_back( f );
     }
     
     void Screen::onUpdate( const std::function< void( void ) > & f )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_onUpdate.push_back( f );
     }
@@ -282,7 +300,10 @@ namespace UB
         _width( 0 ),
         _height( 0 ),
         _colors( false ),
-        _running( false )
+        _running( false ),
+        _output( stdout ),
+        _input( stdin ),
+        _rmtx( "Screen" )
     {}
     
     Screen::IMPL::~IMPL( void )
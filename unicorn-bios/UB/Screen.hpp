@@ -26,6 +26,7 @@
 #define UB_SCREEN_HPP
 
 #include <cstdlib>
+#include <cstdio>
 #include <functional>
 #include <memory>
 #include "UB/Color.hpp"
@@ -37,6 +38,7 @@ namespace UB
         public:
             
             static Screen & shared( void );
+            static void     terminal( FILE * output, FILE * input );
             
             Screen( const Screen & o )      = delete;
             Screen( Screen && o ) noexcept  = delete;
@@ -0,0 +1,331 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/SharedFramebuffer.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace UB
+{
+    class SharedFramebuffer::IMPL
+    {
+        public:
+            
+            enum class Format: uint32_t
+            {
+                Text        = 0,
+                Indexed8    = 1,
+                Unsupported = 2
+            };
+            
+            class Rect
+            {
+                public:
+                    
+                    uint64_t _sequence;
+                    uint32_t _x;
+                    uint32_t _y;
+                    uint32_t _width;
+                    uint32_t _height;
+            };
+            
+            class Header
+            {
+                public:
+                    
+                    char                    _magic[ 4 ];
+                    uint32_t                _version;
+                    std::atomic< uint64_t > _sequence;
+                    std::atomic< uint32_t > _mode;
+                    std::atomic< Format >   _format;
+                    std::atomic< uint32_t > _width;
+                    std::atomic< uint32_t > _height;
+                    std::atomic< uint32_t > _pitch;
+                    std::atomic< uint32_t > _offset;
+                    uint32_t                _data;
+                    uint32_t                _size;
+                    std::atomic< uint64_t > _geometry;
+                    Rect                    _rects[ 16 ];
+            };
+            
+            static const uint64_t base = 0xA0000;
+            static const uint64_t size = 0x20000;
+            static const uint64_t page = 0x1000;
+            
+            IMPL( const std::string & name, Machine & machine );
+            ~IMPL( void );
+            
+            void _setMode( uint8_t mode );
+            void _dirty( uint64_t address, size_t size );
+            void _run( void );
+            
+            std::string         _name;
+            int                 _fd;
+            Header            * _header;
+            uint8_t             _videoMode;
+            Format              _format;
+            uint32_t            _width;
+            uint32_t            _height;
+            uint32_t            _pitch;
+            uint32_t            _unit;
+            uint64_t            _visible;
+            bool                _modeChanged;
+            bool                _pending;
+            uint32_t            _x0;
+            uint32_t            _y0;
+            uint32_t            _x1;
+            uint32_t            _y1;
+            std::mutex          _mtx;
+            std::atomic< bool > _stopping;
+            std::thread         _thread;
+    };
+    
+    SharedFramebuffer::SharedFramebuffer( const std::string & name, Machine & machine ):
+        impl( std::make_unique< IMPL >( name, machine ) )
+    {}
+    
+    SharedFramebuffer::~SharedFramebuffer( void )
+    {
+        this->stop();
+    }
+    
+    void SharedFramebuffer::stop( void )
+    {
+        this->impl->_stopping = true;
+        
+        if( this->impl->_thread.joinable() )
+        {
+            this->impl->_thread.join();
+        }
+    }
+    
+    SharedFramebuffer::IMPL::IMPL( const std::string & name, Machine & machine ):
+        _name(        ( name.length() > 0 && name[ 0 ] == '/' ) ? name : "/" + name ),
+        _fd(          -1 ),
+        _header(      nullptr ),
+        _videoMode(   0x03 ),
+        _format(      Format::Text ),
+        _width(       80 ),
+        _height(      25 ),
+        _pitch(       160 ),
+        _unit(        2 ),
+        _visible(     0xB8000 ),
+        _modeChanged( true ),
+        _pending(     false ),
+        _x0(          0 ),
+        _y0(          0 ),
+        _x1(          0 ),
+        _y1(          0 ),
+        _stopping(    false )
+    {
+        void * p;
+        
+        static_assert( sizeof( Header ) == 56 + 16 * 24, "Unexpected shared framebuffer header layout" );
+        
+        /* Truncating an existing object would pull the pages out from under whoever maps it */
+        if( ( this->_fd = shm_open( this->_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 ) ) < 0 )
+        {
+            if( errno == EEXIST )
+            {
+                throw std::runtime_error( "Shared memory object already exists: " + this->_name + " - Used by another process, or left over (remove it with shm_unlink)" );
+            }
+            
+            throw std::runtime_error( "Cannot create shared memory object: " + this->_name );
+        }
+        
+        if( ftruncate( this->_fd, static_cast< off_t >( page + size ) ) != 0 || ( p = mmap( nullptr, page, PROT_READ | PROT_WRITE, MAP_SHARED, this->_fd, 0 ) ) == MAP_FAILED )
+        {
+            close( this->_fd );
+            shm_unlink( this->_name.c_str() );
+            
+            throw std::runtime_error( "Cannot map shared memory object: " + this->_name );
+        }
+        
+        this->_header = new( p ) Header();
+        
+        std::memcpy( this->_header->_magic, "UBFB", 4 );
+        
+        this->_header->_version = 2;
+        this->_header->_data    = static_cast< uint32_t >( page );
+        this->_header->_size    = static_cast< uint32_t >( size );
+        
+        machine.share( base, size, this->_fd, page );
+        
+        machine.onVideoMode
+        (
+            [ this ]( uint8_t mode )
+            {
+                this->_setMode( mode );
+            }
+        );
+        
+        machine.onMemoryAccess
+        (
+            base,
+            base + size - 1,
+            [ this ]( Engine::MemoryAccess access, uint64_t address, size_t s )
+            {
+                if( access == Engine::MemoryAccess::Write )
+                {
+                    this->_dirty( address, s );
+                }
+            }
+        );
+        
+        this->_thread = std::thread( [ this ] { this->_run(); } );
+    }
+    
+    SharedFramebuffer::IMPL::~IMPL( void )
+    {
+        munmap( this->_header, page );
+        close( this->_fd );
+        
+        /* Guest memory keeps its own mapping, only the name goes away */
+        shm_unlink( this->_name.c_str() );
+    }
+    
+    void SharedFramebuffer::IMPL::_setMode( uint8_t mode )
+    {
+        std::lock_guard< std::mutex > l( this->_mtx );
+        
+        this->_videoMode   = mode;
+        this->_modeChanged = true;
+        
+        switch( mode )
+        {
+            case 0x00: case 0x01: this->_format = Format::Text;        this->_width =  40; this->_height =  25; this->_pitch =  80; this->_unit = 2; this->_visible = 0xB8000; break;
+            case 0x02: case 0x03: this->_format = Format::Text;        this->_width =  80; this->_height =  25; this->_pitch = 160; this->_unit = 2; this->_visible = 0xB8000; break;
+            case 0x07:            this->_format = Format::Text;        this->_width =  80; this->_height =  25; this->_pitch = 160; this->_unit = 2; this->_visible = 0xB0000; break;
+            case 0x13:            this->_format = Format::Indexed8;    this->_width = 320; this->_height = 200; this->_pitch = 320; this->_unit = 1; this->_visible = 0xA0000; break;
+            
+            default:              this->_format = Format::Unsupported; this->_width =   0; this->_height =   0; this->_pitch =   0; this->_unit = 1; this->_visible = 0xA0000; break;
+        }
+    }
+    
+    void SharedFramebuffer::IMPL::_dirty( uint64_t address, size_t size )
+    {
+        std::lock_guard< std::mutex > l( this->_mtx );
+        uint64_t                      first;
+        uint64_t                      last;
+        
+        if( this->_pitch == 0 || address + size <= this->_visible || address >= this->_visible + this->_pitch * this->_height )
+        {
+            return;
+        }
+        
+        first = ( address < this->_visible ) ? 0 : address - this->_visible;
+        last  = std::min< uint64_t >( ( address + size ) - this->_visible, this->_pitch * this->_height ) - 1;
+        
+        {
+            uint32_t x0( static_cast< uint32_t >( ( first % this->_pitch ) / this->_unit ) );
+            uint32_t y0( static_cast< uint32_t >(   first / this->_pitch ) );
+            uint32_t x1( static_cast< uint32_t >( ( last  % this->_pitch ) / this->_unit ) + 1 );
+            uint32_t y1( static_cast< uint32_t >(   last  / this->_pitch ) + 1 );
+            
+            /* A write wrapping to the next row dirties both rows entirely */
+            if( y1 - y0 > 1 || x1 <= x0 )
+            {
+                x0 = 0;
+                x1 = this->_width;
+            }
+            
+            if( this->_pending == false )
+            {
+                this->_x0      = x0;
+                this->_y0      = y0;
+                this->_x1      = x1;
+                this->_y1      = y1;
+                this->_pending = true;
+            }
+            else
+            {
+                this->_x0 = std::min( this->_x0, x0 );
+                this->_y0 = std::min( this->_y0, y0 );
+                this->_x1 = std::max( this->_x1, x1 );
+                this->_y1 = std::max( this->_y1, y1 );
+            }
+        }
+    }
+    
+    void SharedFramebuffer::IMPL::_run( void )
+    {
+        while( this->_stopping == false )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 16 ) );
+            
+            {
+                std::lock_guard< std::mutex > l( this->_mtx );
+                uint64_t                      sequence( this->_header->_sequence.load() + 1 );
+                Rect                        & rect( this->_header->_rects[ sequence % 16 ] );
+                
+                if( this->_pending == false && this->_modeChanged == false )
+                {
+                    continue;
+                }
+                
+                if( this->_modeChanged )
+                {
+                    uint64_t geometry( this->_header->_geometry.load( std::memory_order_relaxed ) );
+                    
+                    /* Seqlock: viewers retry while the sequence is odd or moved, so they never see torn dimensions */
+                    this->_header->_geometry.store( geometry + 1, std::memory_order_relaxed );
+                    std::atomic_thread_fence( std::memory_order_release );
+                    
+                    this->_header->_mode.store(   this->_videoMode, std::memory_order_relaxed );
+                    this->_header->_format.store( this->_format,    std::memory_order_relaxed );
+                    this->_header->_width.store(  this->_width,     std::memory_order_relaxed );
+                    this->_header->_height.store( this->_height,    std::memory_order_relaxed );
+                    this->_header->_pitch.store(  this->_pitch,     std::memory_order_relaxed );
+                    this->_header->_offset.store( static_cast< uint32_t >( page + ( this->_visible - base ) ), std::memory_order_relaxed );
+                    
+                    this->_header->_geometry.store( geometry + 2, std::memory_order_release );
+                    
+                    this->_x0 = 0;
+                    this->_y0 = 0;
+                    this->_x1 = this->_width;
+                    this->_y1 = this->_height;
+                }
+                
+                rect._sequence = sequence;
+                rect._x        = this->_x0;
+                rect._y        = this->_y0;
+                rect._width    = this->_x1 - this->_x0;
+                rect._height   = this->_y1 - this->_y0;
+                
+                this->_header->_sequence.store( sequence, std::memory_order_release );
+                
+                this->_pending     = false;
+                this->_modeChanged = false;
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_SHARED_FRAMEBUFFER_HPP
+#define UB_SHARED_FRAMEBUFFER_HPP
+
+#include <memory>
+#include <algorithm>
+#include <string>
+#include "UB/Machine.hpp"
+
+namespace UB
+{
+    /*!
+     * Exports the guest video memory (0xA0000-0xBFFFF) through a POSIX
+     * shared-memory object, so external viewers can render it without the
+     * emulator copying or drawing anything.
+     * 
+     * The guest pages are backed by the object itself, starting at offset
+     * 4096. The first page is a little-endian header:
+     * 
+     *     0   char[ 4 ]  "UBFB"
+     *     4   uint32     Version (2)
+     *     8   uint64     Frame sequence, incremented after each publish
+     *     16  uint32     BIOS video mode
+     *     20  uint32     Format (0: text cells, character then attribute,
+     *                    1: 8-bit indexed pixels, 2: unsupported mode)
+     *     24  uint32     Width (columns or pixels)
+     *     28  uint32     Height (rows or pixels)
+     *     32  uint32     Pitch (bytes per row)
+     *     36  uint32     Offset of the visible buffer in the object
+     *     40  uint32     Offset of guest address 0xA0000 in the object
+     *     44  uint32     Size of the guest video window
+     *     48  uint64     Geometry sequence, odd while fields 16-36 change
+     *     56  Dirty rectangles, 16 entries of { uint64 sequence; uint32 x,
+     *         y, width, height }, entry n % 16 holding frame n
+     * 
+     * Writes to the window are coalesced and published about 60 times per
+     * second. A viewer that fell more than 16 frames behind, or sees a
+     * rectangle with an unexpected sequence, redraws everything.
+     * 
+     * Fields 16-36 change together on a video mode switch. A viewer reads
+     * the geometry sequence, then the fields, then the sequence again, and
+     * retries if it was odd or changed in between.
+     * 
+     * The object must not exist yet: a name in use by another process (or
+     * left over by a crash) is reported instead of being truncated.
+     */
+    class SharedFramebuffer
+    {
+        public:
+            
+            SharedFramebuffer( const std::string & name, Machine & machine );
+            ~SharedFramebuffer( void );
+            
+            SharedFramebuffer( const SharedFramebuffer & o )              = delete;
+            SharedFramebuffer( SharedFramebuffer && o )                   = delete;
+            SharedFramebuffer & operator =( const SharedFramebuffer & o ) = delete;
+            SharedFramebuffer & operator =( SharedFramebuffer && o )      = delete;
+            
+            void stop( void );
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_SHARED_FRAMEBUFFER_HPP */
@@ -23,20 +23,30 @@
  ******************************************************************************/
 
 #include "UB/Signal.hpp"
+#include "UB/RecursiveMutex.hpp"
 #include <mutex>
 #include <map>
-#include <vector>
+#include <thread>
+#include <stdexcept>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
 
-static std::recursive_mutex                                          * rmtx;
-static std::map< int,  std::vector< std::function< void( int ) > > > * handlers;
+static UB::RecursiveMutex                                                   * rmtx;
+static std::map< int, std::map< uint64_t, std::function< void( int ) > > > * handlers;
+static uint64_t                                                               lastHandler;
+static int                                                                    fds[ 2 ] = { -1, -1 };
 
 static void handle( int sig );
+static void dispatch( void );
 
 namespace UB
 {
     namespace Signal
     {
-        void handle( int sig, const std::function< void( int ) > & handler )
+        uint64_t handle( int sig, const std::function< void( int ) > & handler )
         {
             static std::once_flag once;
             
@@ -45,17 +55,45 @@ namespace UB
                 once,
                 []
                 {
-                    rmtx     = new std::recursive_mutex();
-                    handlers = new std::map< int, std::vector< std::function< void( int ) > > >();
+                    if( pipe( fds ) != 0 )
+                    {
+                        throw std::runtime_error( std::string( "Cannot create signal pipe: " ) + strerror( errno ) );
+                    }
+                    
+                    /* A full pipe already has a wake-up pending, so the signal handler must not block on it */
+                    fcntl( fds[ 0 ], F_SETFD, FD_CLOEXEC );
+                    fcntl( fds[ 1 ], F_SETFD, FD_CLOEXEC );
+                    fcntl( fds[ 1 ], F_SETFL, fcntl( fds[ 1 ], F_GETFL ) | O_NONBLOCK );
+                    
+                    rmtx     = new UB::RecursiveMutex( "Signal" );
+                    handlers = new std::map< int, std::map< uint64_t, std::function< void( int ) > > >();
+                    
+                    std::thread( dispatch ).detach();
                 }
             );
             
             {
-                std::lock_guard< std::recursive_mutex > l( *( rmtx ) );
+                std::lock_guard< UB::RecursiveMutex > l( *( rmtx ) );
                 
-                handlers->operator[]( sig ).push_back( handler );
+                handlers->operator[]( sig )[ ++lastHandler ] = handler;
                 
-                signal( SIGINT, ::handle ); 
+                signal( sig, ::handle );
+                
+                return lastHandler;
+            }
+        }
+        
+        void remove( int sig, uint64_t handler )
+        {
+            if( rmtx == nullptr )
+            {
+                return;
+            }
+            
+            {
+                std::lock_guard< UB::RecursiveMutex > l( *( rmtx ) );
+                
+                handlers->operator[]( sig ).erase( handler );
             }
         }
     }
@@ -63,10 +101,45 @@ namespace UB
 
 static void handle( int sig )
 {
-    std::lock_guard< std::recursive_mutex > l( *( rmtx ) );
+    int           e( errno );
+    unsigned char c( static_cast< unsigned char >( sig ) );
+    
+    /* Only async-signal-safe calls here: the handlers run from dispatch() */
+    ( void )write( fds[ 1 ], &c, 1 );
+    
+    errno = e;
+}
+
+static void dispatch( void )
+{
+    unsigned char c;
+    ssize_t       n;
     
-    for( const auto & f: handlers->operator[]( sig ) )
+    while( ( n = read( fds[ 0 ], &c, 1 ) ) != 0 )
     {
-        f( sig );
+        if( n < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            
+            return;
+        }
+        
+        {
+            std::lock_guard< UB::RecursiveMutex > l( *( rmtx ) );
+            auto                                  it( handlers->find( c ) );
+            
+            if( it == handlers->end() )
+            {
+                continue;
+            }
+            
+            for( const auto & p: it->second )
+            {
+                p.second( c );
+            }
+        }
     }
 }
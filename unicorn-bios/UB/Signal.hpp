@@ -26,12 +26,21 @@
 #define UB_SIGNAL_HPP
 
 #include <functional>
+#include <cstdint>
 
 namespace UB
 {
     namespace Signal
     {
-        void handle( int sig, const std::function< void( int ) > & handler );
+        /*
+         * The signal handler only writes the signal number to a pipe, and
+         * handlers run on a dispatcher thread outside signal context. The
+         * returned identifier is passed to remove() before anything the
+         * handler references goes away; once remove() returns, the handler
+         * is neither running nor called again.
+         */
+        uint64_t handle( int sig, const std::function< void( int ) > & handler );
+        void     remove( int sig, uint64_t handler );
     }
 }
 
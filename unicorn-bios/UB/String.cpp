@@ -59,5 +59,41 @@ namespace UB
             
             return lower;
         }
+        
+        std::string toJSON( const std::string & s )
+        {
+            std::stringstream ss;
+            
+            ss << "\"";
+            
+            for( char c: s )
+            {
+                switch( c )
+                {
+                    case '"':  ss << "\\\""; break;
+                    case '\\': ss << "\\\\"; break;
+                    case '\n': ss << "\\n";  break;
+                    case '\r': ss << "\\r";  break;
+                    case '\t': ss << "\\t";  break;
+                    
+                    default:
+                        
+                        if( static_cast< unsigned char >( c ) < 0x20 )
+                        {
+                            ss << "\\u" << std::hex << std::setfill( '0' ) << std::setw( 4 ) << static_cast< unsigned int >( c ) << std::dec;
+                        }
+                        else
+                        {
+                            ss << c;
+                        }
+                        
+                        break;
+                }
+            }
+            
+            ss << "\"";
+            
+            return ss.str();
+        }
     }
 }
@@ -39,6 +39,7 @@ namespace UB
         
         std::string toUpper( const std::string & s );
         std::string toLower( const std::string & s );
+        std::string toJSON( const std::string & s );
         
         template< typename _T_ >
         _T_ fromHex( const std::string & s, typename std::enable_if< std::is_integral< _T_ >::value >::type * = 0 )
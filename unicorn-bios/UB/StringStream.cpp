@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "StringStream.hpp"
+#include "UB/RecursiveMutex.hpp"
 #include <mutex>
 #include <sstream>
 #include <vector>
@@ -37,10 +38,10 @@ namespace UB
             IMPL( void );
             IMPL( const std::string & s );
             IMPL( const IMPL & o );
-            IMPL( const IMPL & o, const std::lock_guard< std::recursive_mutex > & l );
+            IMPL( const IMPL & o, const std::lock_guard< RecursiveMutex > & l );
             ~IMPL( void );
             
-            mutable std::recursive_mutex                          _rmtx;
+            mutable RecursiveMutex                                _rmtx;
             std::stringstream                                     _ss;
             std::vector< std::reference_wrapper< std::ostream > > _redirects;
     };
@@ -78,21 +79,21 @@ namespace UB
 
     std::string StringStream::string( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_ss.str();
     }
             
     void StringStream::redirect( std::ostream & os )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_redirects.push_back( os );
     }
 
     StringStream & StringStream::operator <<( const std::string & s )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << s;
         
@@ -106,7 +107,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( short v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -120,7 +121,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( unsigned short v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -134,7 +135,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( int v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -148,7 +149,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( unsigned int v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -162,7 +163,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( long v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -176,7 +177,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( unsigned long v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -190,7 +191,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( long long v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -204,7 +205,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( unsigned long long v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -218,7 +219,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( float v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -232,7 +233,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( double v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -246,7 +247,7 @@ namespace UB
 
     StringStream & StringStream::operator <<( long double v )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         this->impl->_ss << v;
         
@@ -260,7 +261,7 @@ namespace UB
     
     StringStream & StringStream::operator <<( std::ostream & ( * f )( std::ostream & ) )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         f( this->impl->_ss );
         
@@ -274,7 +275,7 @@ namespace UB
     
     StringStream & StringStream::operator <<( std::ios_base & ( * f )( std::ios_base & ) )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         f( this->impl->_ss );
         
@@ -293,18 +294,21 @@ namespace UB
         swap( o1.impl, o2.impl );
     }
 
-    StringStream::IMPL::IMPL()
+    StringStream::IMPL::IMPL():
+        _rmtx( "StringStream" )
     {}
 
     StringStream::IMPL::IMPL( const std::string & s ):
+        _rmtx( "StringStream" ),
         _ss( s )
     {}
 
     StringStream::IMPL::IMPL( const IMPL & o ):
-        IMPL( o, std::lock_guard< std::recursive_mutex >( o._rmtx ) )
+        IMPL( o, std::lock_guard< RecursiveMutex >( o._rmtx ) )
     {}
 
-    StringStream::IMPL::IMPL( const IMPL & o, const std::lock_guard< std::recursive_mutex > & l ):
+    StringStream::IMPL::IMPL( const IMPL & o, const std::lock_guard< RecursiveMutex > & l ):
+        _rmtx( "StringStream" ),
         _ss( o._ss.str() )
     {
         ( void )l;
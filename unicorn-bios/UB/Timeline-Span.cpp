@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/Timeline.hpp"
+
+namespace UB
+{
+    class Timeline::Span::IMPL
+    {
+        public:
+            
+            IMPL( const std::string & category, const std::string & name );
+            ~IMPL( void );
+            
+            std::string _category;
+            std::string _name;
+            std::string _detail;
+            uint64_t    _host;
+            uint64_t    _guest;
+    };
+    
+    Timeline::Span::Span( const std::string & category, const std::string & name ):
+        impl( Timeline::shared().enabled() ? std::make_unique< IMPL >( category, name ) : nullptr )
+    {}
+    
+    Timeline::Span::~Span( void )
+    {
+        if( this->impl != nullptr )
+        {
+            Timeline::shared().complete( this->impl->_category, this->impl->_name, this->impl->_host, this->impl->_guest, this->impl->_detail );
+        }
+    }
+    
+    void Timeline::Span::detail( const std::string & value )
+    {
+        if( this->impl != nullptr )
+        {
+            this->impl->_detail = value;
+        }
+    }
+    
+    Timeline::Span::IMPL::IMPL( const std::string & category, const std::string & name ):
+        _category( category ),
+        _name(     name ),
+        _host(     Timeline::shared().hostTime() ),
+        _guest(    Timeline::shared().guestTime() )
+    {}
+    
+    Timeline::Span::IMPL::~IMPL( void )
+    {}
+}
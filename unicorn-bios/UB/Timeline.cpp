@@ -0,0 +1,327 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/Timeline.hpp"
+#include "UB/String.hpp"
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+namespace UB
+{
+    class TimelineEvent
+    {
+        public:
+            
+            char        _phase;
+            std::string _category;
+            std::string _name;
+            std::string _detail;
+            uint64_t    _host;
+            uint64_t    _guest;
+            uint64_t    _hostDuration;
+            uint64_t    _guestDuration;
+    };
+    
+    /*
+     * One per thread. Only that thread appends, so its lock is uncontended
+     * except while save() or numberOfEvents() reads the buffer.
+     */
+    class TimelineBuffer
+    {
+        public:
+            
+            TimelineBuffer( uint32_t tid ):
+                _tid( tid )
+            {}
+            
+            uint32_t                     _tid;
+            std::string                  _name;
+            std::vector< TimelineEvent > _events;
+            std::mutex                   _mtx;
+    };
+    
+    class Timeline::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            ~IMPL( void );
+            
+            TimelineBuffer & _buffer( void );
+            void             _add( char phase, const std::string & category, const std::string & name, const std::string & detail, uint64_t host, uint64_t guest, uint64_t hostDuration, uint64_t guestDuration );
+            
+            std::atomic< bool >                                                 _enabled;
+            uint64_t                                                            _origin;
+            std::atomic< const std::function< uint64_t( void ) > * >            _clock;
+            std::vector< std::unique_ptr< std::function< uint64_t( void ) > > > _clocks;
+            std::vector< std::shared_ptr< TimelineBuffer > >                    _buffers;
+            mutable std::recursive_mutex                                        _rmtx;
+    };
+    
+    static uint64_t now( void )
+    {
+        return static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+    }
+    
+    Timeline & Timeline::shared( void )
+    {
+        static Timeline     * timeline( nullptr );
+        static std::once_flag once;
+        
+        std::call_once( once, [ & ]{ timeline = new Timeline(); } );
+        
+        return *( timeline );
+    }
+    
+    Timeline::Timeline( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    Timeline::~Timeline( void )
+    {}
+    
+    bool Timeline::enabled( void ) const
+    {
+        return this->impl->_enabled;
+    }
+    
+    uint64_t Timeline::hostTime( void ) const
+    {
+        return now();
+    }
+    
+    uint64_t Timeline::guestTime( void ) const
+    {
+        const std::function< uint64_t( void ) > * clock( this->impl->_clock.load( std::memory_order_acquire ) );
+        
+        return ( clock != nullptr && *( clock ) ) ? ( *( clock ) )() : 0;
+    }
+    
+    size_t Timeline::numberOfEvents( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        size_t                                  n( 0 );
+        
+        for( const auto & buffer: this->impl->_buffers )
+        {
+            std::lock_guard< std::mutex > bl( buffer->_mtx );
+            
+            n += buffer->_events.size();
+        }
+        
+        return n;
+    }
+    
+    void Timeline::enable( void )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        if( this->impl->_enabled == false )
+        {
+            this->impl->_origin  = now();
+            this->impl->_enabled = true;
+        }
+    }
+    
+    void Timeline::disable( void )
+    {
+        this->impl->_enabled = false;
+    }
+    
+    /*
+     * Events read the clock without locking: a new clock is published
+     * atomically, and replaced ones are kept alive for readers still
+     * calling them.
+     */
+    void Timeline::clock( const std::function< uint64_t( void ) > & f )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_clocks.push_back( std::make_unique< std::function< uint64_t( void ) > >( f ) );
+        this->impl->_clock.store( this->impl->_clocks.back().get(), std::memory_order_release );
+    }
+    
+    void Timeline::threadName( const std::string & name )
+    {
+        if( this->impl->_enabled )
+        {
+            TimelineBuffer              & buffer( this->impl->_buffer() );
+            std::lock_guard< std::mutex > l( buffer._mtx );
+            
+            buffer._name = name;
+        }
+    }
+    
+    void Timeline::begin( const std::string & category, const std::string & name )
+    {
+        if( this->impl->_enabled )
+        {
+            this->impl->_add( 'B', category, name, "", now(), this->guestTime(), 0, 0 );
+        }
+    }
+    
+    void Timeline::end( const std::string & category, const std::string & name )
+    {
+        if( this->impl->_enabled )
+        {
+            this->impl->_add( 'E', category, name, "", now(), this->guestTime(), 0, 0 );
+        }
+    }
+    
+    void Timeline::instant( const std::string & category, const std::string & name, const std::string & detail )
+    {
+        if( this->impl->_enabled )
+        {
+            this->impl->_add( 'i', category, name, detail, now(), this->guestTime(), 0, 0 );
+        }
+    }
+    
+    void Timeline::complete( const std::string & category, const std::string & name, uint64_t hostStart, uint64_t guestStart, const std::string & detail )
+    {
+        if( this->impl->_enabled )
+        {
+            uint64_t host(  now() );
+            uint64_t guest( this->guestTime() );
+            
+            this->impl->_add( 'X', category, name, detail, hostStart, guestStart, ( host > hostStart ) ? host - hostStart : 0, ( guest > guestStart ) ? guest - guestStart : 0 );
+        }
+    }
+    
+    void Timeline::save( const std::string & path )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::ofstream                           stream( path, std::ios::out | std::ios::trunc );
+        bool                                    first( true );
+        
+        this->disable();
+        
+        if( stream.good() == false )
+        {
+            throw std::runtime_error( "Cannot write timeline: " + path );
+        }
+        
+        stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+        
+        for( unsigned int pid = 1; pid <= 2; pid++ )
+        {
+            stream << ( ( first ) ? "" : ",\n" )
+                   << "{\"ph\":\"M\",\"pid\":" << pid << ",\"name\":\"process_name\",\"args\":{\"name\":"
+                   << String::toJSON( ( pid == 1 ) ? "Host time" : "Guest instructions (1 us = 1 instruction)" )
+                   << "}}";
+            
+            first = false;
+            
+            for( const auto & buffer: this->impl->_buffers )
+            {
+                /* Threads may still be appending: disable() doesn't wait for them */
+                std::lock_guard< std::mutex > bl( buffer->_mtx );
+                
+                stream << ",\n{\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->_tid << ",\"name\":\"thread_name\",\"args\":{\"name\":"
+                       << String::toJSON( ( buffer->_name.length() > 0 ) ? buffer->_name : "Thread " + std::to_string( buffer->_tid ) )
+                       << "}}";
+                
+                for( const auto & event: buffer->_events )
+                {
+                    std::string ts;
+                    std::string dur;
+                    
+                    if( pid == 1 )
+                    {
+                        uint64_t host( ( event._host > this->impl->_origin ) ? event._host - this->impl->_origin : 0 );
+                        
+                        ts  = std::to_string( host / 1000 ) + "." + std::to_string( 1000 + ( host % 1000 ) ).substr( 1 );
+                        dur = std::to_string( event._hostDuration / 1000 ) + "." + std::to_string( 1000 + ( event._hostDuration % 1000 ) ).substr( 1 );
+                    }
+                    else
+                    {
+                        ts  = std::to_string( event._guest );
+                        dur = std::to_string( event._guestDuration );
+                    }
+                    
+                    stream << ",\n{\"ph\":\"" << event._phase << "\""
+                           << ",\"pid\":"     << pid
+                           << ",\"tid\":"     << buffer->_tid
+                           << ",\"ts\":"      << ts
+                           << ",\"cat\":"     << String::toJSON( event._category )
+                           << ",\"name\":"    << String::toJSON( event._name );
+                    
+                    if( event._phase == 'X' )
+                    {
+                        stream << ",\"dur\":" << dur;
+                    }
+                    else if( event._phase == 'i' )
+                    {
+                        stream << ",\"s\":\"t\"";
+                    }
+                    
+                    if( event._detail.length() > 0 )
+                    {
+                        stream << ",\"args\":{\"detail\":" << String::toJSON( event._detail ) << "}";
+                    }
+                    
+                    stream << "}";
+                }
+            }
+        }
+        
+        stream << std::endl << "]}" << std::endl;
+    }
+    
+    Timeline::IMPL::IMPL( void ):
+        _enabled( false ),
+        _origin(  now() ),
+        _clock(   nullptr )
+    {}
+    
+    Timeline::IMPL::~IMPL( void )
+    {}
+    
+    TimelineBuffer & Timeline::IMPL::_buffer( void )
+    {
+        static thread_local TimelineBuffer * buffer( nullptr );
+        
+        if( buffer == nullptr )
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            this->_buffers.push_back( std::make_shared< TimelineBuffer >( static_cast< uint32_t >( this->_buffers.size() + 1 ) ) );
+            
+            buffer = this->_buffers.back().get();
+        }
+        
+        return *( buffer );
+    }
+    
+    void Timeline::IMPL::_add( char phase, const std::string & category, const std::string & name, const std::string & detail, uint64_t host, uint64_t guest, uint64_t hostDuration, uint64_t guestDuration )
+    {
+        TimelineBuffer              & buffer( this->_buffer() );
+        std::lock_guard< std::mutex > l( buffer._mtx );
+        
+        buffer._events.push_back( { phase, category, name, detail, host, guest, hostDuration, guestDuration } );
+    }
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_TIMELINE_HPP
+#define UB_TIMELINE_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <functional>
+
+namespace UB
+{
+    class Timeline
+    {
+        public:
+            
+            class Span
+            {
+                public:
+                    
+                    Span( const std::string & category, const std::string & name );
+                    ~Span( void );
+                    
+                    Span( const Span & o )              = delete;
+                    Span( Span && o )                   = delete;
+                    Span & operator =( const Span & o ) = delete;
+                    Span & operator =( Span && o )      = delete;
+                    
+                    void detail( const std::string & value );
+                
+                private:
+                    
+                    class IMPL;
+                    std::unique_ptr< IMPL > impl;
+            };
+            
+            static Timeline & shared( void );
+            
+            Timeline( const Timeline & o )              = delete;
+            Timeline( Timeline && o )                   = delete;
+            Timeline & operator =( const Timeline & o ) = delete;
+            Timeline & operator =( Timeline && o )      = delete;
+            
+            bool     enabled( void )        const;
+            uint64_t hostTime( void )       const;
+            uint64_t guestTime( void )      const;
+            size_t   numberOfEvents( void ) const;
+            
+            void enable( void );
+            void disable( void );
+            void clock( const std::function< uint64_t( void ) > & f );
+            void threadName( const std::string & name );
+            
+            void begin(    const std::string & category, const std::string & name );
+            void end(      const std::string & category, const std::string & name );
+            void instant(  const std::string & category, const std::string & name, const std::string & detail = "" );
+            void complete( const std::string & category, const std::string & name, uint64_t hostStart, uint64_t guestStart, const std::string & detail = "" );
+            
+            void save( const std::string & path );
+        
+        private:
+            
+            Timeline( void );
+            ~Timeline( void );
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_TIMELINE_HPP */
@@ -0,0 +1,479 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "UB/TimingModel.hpp"
+#include "UB/InstructionMix.hpp"
+#include "UB/CallStack.hpp"
+#include "UB/String.hpp"
+#include <array>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+
+namespace UB
+{
+    class TimingModel::IMPL
+    {
+        public:
+            
+            class Block
+            {
+                public:
+                    
+                    bool     _costed;
+                    uint64_t _cycles;
+            };
+            
+            class Function
+            {
+                public:
+                    
+                    uint64_t _cycles;
+                    uint64_t _calls;
+            };
+            
+            IMPL( void );
+            IMPL( const IMPL & o );
+            ~IMPL( void );
+            
+            static std::string _phase( Engine::Mode mode );
+            
+            uint64_t _get( const std::string & key ) const;
+            uint64_t _cost( const std::string & mnemonic, const std::vector< std::string > & groups ) const;
+            void     _add( const std::string & phase, uint64_t cycles );
+            
+            std::map< std::string, uint64_t > _costs;
+            std::vector< Block >              _blocks;
+            std::map< std::string, uint64_t > _phases;
+            std::array< uint64_t, 3 >         _modes;
+            std::map< uint64_t, Function >    _functions;
+            CallStack                         _stack;
+            uint64_t                          _entry;
+            Function                        * _function;
+            Engine::Mode                      _mode;
+            bool                              _started;
+            uint64_t                          _cycles;
+            uint64_t                          _instructions;
+            uint64_t                          _executions;
+            size_t                            _unique;
+            mutable std::mutex                _mtx;
+    };
+    
+    TimingModel::TimingModel( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    TimingModel::TimingModel( const std::string & path ):
+        impl( std::make_unique< IMPL >() )
+    {
+        std::ifstream stream( path );
+        std::string   line;
+        
+        if( stream.good() == false )
+        {
+            throw std::runtime_error( "Cannot read timing model: " + path );
+        }
+        
+        while( std::getline( stream, line ) )
+        {
+            std::string key;
+            std::string value;
+            size_t      equal;
+            char      * end;
+            uint64_t    cycles;
+            
+            line = line.substr( 0, line.find( '#' ) );
+            
+            if( line.find_first_not_of( " \t\r" ) == std::string::npos )
+            {
+                continue;
+            }
+            
+            if( ( equal = line.find( '=' ) ) == std::string::npos )
+            {
+                throw std::runtime_error( "Invalid timing model entry: " + line );
+            }
+            
+            {
+                std::stringstream ks( line.substr( 0, equal ) );
+                std::stringstream vs( line.substr( equal + 1 ) );
+                
+                ks >> key;
+                vs >> value;
+            }
+            
+            cycles = std::strtoull( value.c_str(), &end, 0 );
+            
+            if( key.length() == 0 || value.length() == 0 || *( end ) != 0 )
+            {
+                throw std::runtime_error( "Invalid timing model entry: " + line );
+            }
+            
+            this->cost( String::toLower( key ), cycles );
+        }
+    }
+    
+    TimingModel::TimingModel( const TimingModel & o ):
+        impl( std::make_unique< IMPL >( *( o.impl ) ) )
+    {}
+    
+    TimingModel::TimingModel( TimingModel && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    TimingModel::~TimingModel( void )
+    {}
+    
+    TimingModel & TimingModel::operator =( TimingModel o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    uint64_t TimingModel::cost( const std::string & key ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_get( key );
+    }
+    
+    void TimingModel::cost( const std::string & key, uint64_t cycles )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_costs[ key ] = cycles;
+        
+        /* Blocks were costed with the previous table */
+        this->impl->_blocks.clear();
+    }
+    
+    void TimingModel::block( const BlockCache::Block & block )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        Engine::Mode                  mode( block.mode() );
+        IMPL::Block                 * b;
+        
+        if( block.id() >= this->impl->_blocks.size() )
+        {
+            this->impl->_blocks.resize( block.id() + 1, { false, 0 } );
+        }
+        
+        b = &( this->impl->_blocks[ block.id() ] );
+        
+        if( b->_costed == false )
+        {
+            b->_costed = true;
+            b->_cycles = 0;
+            
+            for( const auto & instruction: block.instructions() )
+            {
+                std::vector< std::string > groups( instruction.second );
+                std::vector< std::string > classes( InstructionMix::classes( instruction.first ) );
+                
+                groups.insert( groups.end(), classes.begin(), classes.end() );
+                
+                b->_cycles += this->impl->_cost( instruction.first, groups );
+            }
+            
+            this->impl->_unique++;
+        }
+        
+        if( this->impl->_started && mode != this->impl->_mode )
+        {
+            this->impl->_add( "Mode switches", this->impl->_get( "penalty.mode-switch" ) );
+        }
+        
+        this->impl->_stack.block( block.address(), block.exit() );
+        
+        /* Map nodes are stable, so the function is only looked up when the shadow stack moves */
+        if( this->impl->_function == nullptr || this->impl->_stack.function() != this->impl->_entry )
+        {
+            this->impl->_entry    = this->impl->_stack.function();
+            this->impl->_function = &( this->impl->_functions[ this->impl->_entry ] );
+        }
+        
+        if( this->impl->_stack.entered() )
+        {
+            this->impl->_function->_calls++;
+        }
+        
+        this->impl->_started = true;
+        this->impl->_mode    = mode;
+        
+        this->impl->_cycles                                 += b->_cycles;
+        this->impl->_modes[ static_cast< size_t >( mode ) ] += b->_cycles;
+        this->impl->_function->_cycles                      += b->_cycles;
+        this->impl->_instructions                           += block.instructions().size();
+        this->impl->_executions++;
+    }
+    
+    void TimingModel::interrupt( uint32_t vector )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        ( void )vector;
+        
+        this->impl->_add( "BIOS services", this->impl->_get( "latency.interrupt" ) );
+    }
+    
+    void TimingModel::diskRead( uint64_t size )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_add( "Disk I/O", this->impl->_get( "latency.disk" ) + ( size * this->impl->_get( "latency.disk-byte" ) ) );
+    }
+    
+    uint64_t TimingModel::cycles( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_cycles;
+    }
+    
+    std::string TimingModel::report( size_t top ) const
+    {
+        std::lock_guard< std::mutex >                        l( this->impl->_mtx );
+        std::stringstream                                    ss;
+        uint64_t                                             frequency( std::max< uint64_t >( this->impl->_get( "frequency" ), 1 ) );
+        uint64_t                                             total( std::max< uint64_t >( this->impl->_cycles, 1 ) );
+        std::vector< std::pair< std::string, uint64_t > >    phases( this->impl->_phases.begin(), this->impl->_phases.end() );
+        std::vector< std::pair< uint64_t, IMPL::Function > > functions( this->impl->_functions.begin(), this->impl->_functions.end() );
+        
+        for( Engine::Mode mode: { Engine::Mode::Real, Engine::Mode::Protected, Engine::Mode::Long } )
+        {
+            if( this->impl->_modes[ static_cast< size_t >( mode ) ] > 0 )
+            {
+                phases.push_back( { IMPL::_phase( mode ), this->impl->_modes[ static_cast< size_t >( mode ) ] } );
+            }
+        }
+        
+        std::sort
+        (
+            phases.begin(),
+            phases.end(),
+            []( const std::pair< std::string, uint64_t > & o1, const std::pair< std::string, uint64_t > & o2 ) -> bool
+            {
+                return ( o1.second == o2.second ) ? o1.first < o2.first : o1.second > o2.second;
+            }
+        );
+        
+        std::sort
+        (
+            functions.begin(),
+            functions.end(),
+            []( const std::pair< uint64_t, IMPL::Function > & o1, const std::pair< uint64_t, IMPL::Function > & o2 ) -> bool
+            {
+                return ( o1.second._cycles == o2.second._cycles ) ? o1.first < o2.first : o1.second._cycles > o2.second._cycles;
+            }
+        );
+        
+        ss << "Timing estimate: "
+           << this->impl->_cycles << " cycles, "
+           << std::fixed << std::setprecision( 3 )
+           << ( static_cast< double >( this->impl->_cycles ) * 1000.0 ) / static_cast< double >( frequency ) << " ms at "
+           << std::setprecision( 1 ) << static_cast< double >( frequency ) / 1000000.0 << " MHz ("
+           << this->impl->_instructions << " instructions, "
+           << this->impl->_executions   << " blocks executed, "
+           << this->impl->_unique       << " blocks costed)"
+           << std::endl
+           << std::endl
+           << "    Phases:"
+           << std::endl;
+        
+        for( const auto & p: phases )
+        {
+            ss << "        "
+               << std::left  << std::setw( 20 ) << p.first
+               << std::right << std::setw( 16 ) << p.second
+               << std::fixed << std::setprecision( 2 ) << std::setw( 9 )
+               << ( static_cast< double >( p.second ) * 100.0 ) / static_cast< double >( total )
+               << "%"
+               << std::endl;
+        }
+        
+        ss << std::endl << "    Functions (top " << top << ", self cycles):" << std::endl;
+        
+        for( size_t i = 0; i < functions.size() && i < top; i++ )
+        {
+            ss << "        "
+               << std::left  << std::setw( 20 ) << String::toHex( functions[ i ].first )
+               << std::right << std::setw( 16 ) << functions[ i ].second._cycles
+               << std::fixed << std::setprecision( 2 ) << std::setw( 9 )
+               << ( static_cast< double >( functions[ i ].second._cycles ) * 100.0 ) / static_cast< double >( total )
+               << "%"
+               << std::setw( 12 ) << functions[ i ].second._calls << " calls"
+               << std::endl;
+        }
+        
+        return ss.str();
+    }
+    
+    void swap( TimingModel & o1, TimingModel & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    TimingModel::IMPL::IMPL( void ):
+        _entry(        0 ),
+        _function(     nullptr ),
+        _mode(         Engine::Mode::Real ),
+        _started(      false ),
+        _cycles(       0 ),
+        _instructions( 0 ),
+        _executions(   0 ),
+        _unique(       0 )
+    {
+        this->_modes.fill( 0 );
+        
+        /* Rough i486 figures, meant to be overridden by a timing model file */
+        this->_costs[ "default" ]              = 1;
+        this->_costs[ "group.jump" ]           = 3;
+        this->_costs[ "group.call" ]           = 3;
+        this->_costs[ "group.ret" ]            = 5;
+        this->_costs[ "group.int" ]            = 30;
+        this->_costs[ "group.iret" ]           = 15;
+        this->_costs[ "group.privilege" ]      = 10;
+        this->_costs[ "group.fpu" ]            = 8;
+        this->_costs[ "group.string" ]         = 5;
+        this->_costs[ "mnemonic.mul" ]         = 13;
+        this->_costs[ "mnemonic.imul" ]        = 13;
+        this->_costs[ "mnemonic.div" ]         = 24;
+        this->_costs[ "mnemonic.idiv" ]        = 27;
+        this->_costs[ "penalty.far-transfer" ] = 17;
+        this->_costs[ "penalty.port-io" ]      = 30;
+        this->_costs[ "penalty.mode-switch" ]  = 100;
+        this->_costs[ "latency.interrupt" ]    = 200;
+        this->_costs[ "latency.disk" ]         = 1000000;
+        this->_costs[ "latency.disk-byte" ]    = 20;
+        this->_costs[ "frequency" ]            = 100000000;
+    }
+    
+    TimingModel::IMPL::IMPL( const IMPL & o ):
+        _costs(        o._costs ),
+        _blocks(       o._blocks ),
+        _phases(       o._phases ),
+        _modes(        o._modes ),
+        _functions(    o._functions ),
+        _stack(        o._stack ),
+        _entry(        o._entry ),
+        _function(     nullptr ),
+        _mode(         o._mode ),
+        _started(      o._started ),
+        _cycles(       o._cycles ),
+        _instructions( o._instructions ),
+        _executions(   o._executions ),
+        _unique(       o._unique )
+    {
+        if( o._function != nullptr )
+        {
+            this->_function = &( this->_functions[ this->_entry ] );
+        }
+    }
+    
+    TimingModel::IMPL::~IMPL( void )
+    {}
+    
+    std::string TimingModel::IMPL::_phase( Engine::Mode mode )
+    {
+        if( mode == Engine::Mode::Real )
+        {
+            return "Real mode";
+        }
+        else if( mode == Engine::Mode::Protected )
+        {
+            return "Protected mode";
+        }
+        
+        return "Long mode";
+    }
+    
+    uint64_t TimingModel::IMPL::_get( const std::string & key ) const
+    {
+        auto it( this->_costs.find( key ) );
+        
+        return ( it == this->_costs.end() ) ? 0 : it->second;
+    }
+    
+    uint64_t TimingModel::IMPL::_cost( const std::string & mnemonic, const std::vector< std::string > & groups ) const
+    {
+        std::string base( mnemonic.substr( mnemonic.find( ' ' ) + 1 ) );
+        uint64_t    cycles( 0 );
+        bool        found( false );
+        auto        it( this->_costs.find( "mnemonic." + mnemonic ) );
+        
+        if( it == this->_costs.end() )
+        {
+            it = this->_costs.find( "mnemonic." + base );
+        }
+        
+        if( it != this->_costs.end() )
+        {
+            cycles = it->second;
+            found  = true;
+        }
+        else
+        {
+            for( const auto & group: groups )
+            {
+                if( ( it = this->_costs.find( "group." + group ) ) != this->_costs.end() )
+                {
+                    cycles = std::max( cycles, it->second );
+                    found  = true;
+                }
+            }
+        }
+        
+        if( found == false && ( it = this->_costs.find( "default" ) ) != this->_costs.end() )
+        {
+            cycles = it->second;
+        }
+        
+        for( const std::string penalty: { "far-transfer", "port-io" } )
+        {
+            if( std::find( groups.begin(), groups.end(), penalty ) != groups.end() && ( it = this->_costs.find( "penalty." + penalty ) ) != this->_costs.end() )
+            {
+                cycles += it->second;
+            }
+        }
+        
+        return cycles;
+    }
+    
+    void TimingModel::IMPL::_add( const std::string & phase, uint64_t cycles )
+    {
+        this->_cycles          += cycles;
+        this->_phases[ phase ] += cycles;
+        
+        if( this->_function != nullptr )
+        {
+            this->_function->_cycles += cycles;
+        }
+    }
+}
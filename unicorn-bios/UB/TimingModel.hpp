@@ -0,0 +1,82 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef UB_TIMING_MODEL_HPP
+#define UB_TIMING_MODEL_HPP
+
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "UB/Engine.hpp"
+#include "UB/BlockCache.hpp"
+
+namespace UB
+{
+    /*!
+     * Cycle-approximate estimate of guest execution time on real hardware.
+     * 
+     * Costs come from a table of "key = cycles" entries, where keys are
+     * "default", "mnemonic.NAME", "group.NAME" (Capstone groups and the
+     * InstructionMix classes), "penalty.far-transfer", "penalty.port-io",
+     * "penalty.mode-switch", "latency.interrupt", "latency.disk",
+     * "latency.disk-byte" and "frequency" (in Hz, for the time estimate).
+     * 
+     * Blocks come decoded from the shared BlockCache and are costed once,
+     * then only their total is accumulated on later executions. Repeat counts of rep-prefixed string
+     * instructions are not known statically and are costed as one iteration.
+     */
+    class TimingModel
+    {
+        public:
+            
+            TimingModel( void );
+            TimingModel( const std::string & path );
+            TimingModel( const TimingModel & o );
+            TimingModel( TimingModel && o ) noexcept;
+            ~TimingModel( void );
+            
+            TimingModel & operator =( TimingModel o );
+            
+            uint64_t cost( const std::string & key ) const;
+            void     cost( const std::string & key, uint64_t cycles );
+            
+            void block( const BlockCache::Block & block );
+            void interrupt( uint32_t vector );
+            void diskRead( uint64_t size );
+            
+            uint64_t    cycles( void )           const;
+            std::string report( size_t top = 20 ) const;
+            
+            friend void swap( TimingModel & o1, TimingModel & o2 );
+        
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* UB_TIMING_MODEL_HPP */
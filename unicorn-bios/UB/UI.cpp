@@ -31,14 +31,18 @@
 #include "UB/Capstone.hpp"
 #include "UB/Window.hpp"
 #include "UB/Signal.hpp"
+#include "UB/Timeline.hpp"
+#include "UB/RecursiveMutex.hpp"
 #include <mutex>
 #include <optional>
 #include <thread>
+#include <atomic>
 #include <functional>
 #include <optional>
 #include <iostream>
 #include <condition_variable>
 #include <csignal>
+#include <chrono>
 
 namespace UB
 {
@@ -48,10 +52,11 @@ namespace UB
             
             IMPL( Engine & engine );
             IMPL( const IMPL & o );
-            IMPL( const IMPL & o, const std::lock_guard< std::recursive_mutex > & l );
+            IMPL( const IMPL & o, const std::lock_guard< RecursiveMutex > & l );
             
             void _setupEngine( void );
             void _setupScreen( void );
+            void _display( const std::string & name, const std::function< void( void ) > & f );
             void _displayStatus( void );
             void _displayOutput( void );
             void _displayDebug( void );
@@ -68,18 +73,23 @@ namespace UB
             void _memoryPageDown( void );
             
             bool                          _running;
+            std::atomic< bool >           _exit;
             Mode                          _mode;
             Engine                      & _engine;
+            std::atomic< Engine::Mode >   _cpuMode;
             StringStream                  _output;
             StringStream                  _debug;
             std::string                   _status;
             Color                         _statusColor;
+            std::string                   _milestone;
             size_t                        _memoryOffset;
             size_t                        _memoryBytesPerLine;
             size_t                        _memoryLines;
             std::optional< std::string >  _memoryAddressPrompt;
             std::function< void( int ) >  _waitEnterOrSpaceKeyPress;
-            mutable std::recursive_mutex  _rmtx;
+            mutable RecursiveMutex        _rmtx;
+            
+            std::vector< std::function< void( const std::string &, uint64_t ) > > _onPanelDisplayed;
     };
     
     UI::UI( Engine & engine ):
@@ -92,7 +102,7 @@ namespace UB
     
     UI::UI( UI && o ) noexcept
     {
-        std::lock_guard< std::recursive_mutex >( o.impl->_rmtx );
+        std::lock_guard< RecursiveMutex >( o.impl->_rmtx );
         
         this->impl = std::move( o.impl );
     }
@@ -109,14 +119,14 @@ namespace UB
     
     UI::Mode UI::mode( void ) const
     {
-        std::lock_guard< std::recursive_mutex >( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex >( this->impl->_rmtx );
         
         return this->impl->_mode;
     }
     
     void UI::mode( Mode mode )
     {
-        std::lock_guard< std::recursive_mutex >( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex >( this->impl->_rmtx );
         
         if( this->impl->_running )
         {
@@ -131,7 +141,7 @@ namespace UB
         Mode mode;
         
         {
-            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
             
             if( this->impl->_running )
             {
@@ -139,6 +149,7 @@ namespace UB
             }
             
             this->impl->_running = true;
+            this->impl->_exit    = false;
             mode                 = this->impl->_mode;
             
             this->impl->_output = {};
@@ -162,8 +173,6 @@ namespace UB
             (
                 [ & ]
                 {
-                    std::atomic< bool > exit( false );
-                    
                     Signal::handle
                     (
                         SIGINT,
@@ -171,7 +180,7 @@ namespace UB
                         {
                             if( sig == SIGINT )
                             {
-                                exit = true;
+                                this->impl->_exit = true;
                             }
                             
                             if( mode == Mode::Interactive )
@@ -183,18 +192,19 @@ namespace UB
                     
                     if( mode == Mode::Interactive )
                     {
+                        Timeline::shared().threadName( "UI" );
                         Screen::shared().start();
                     }
                     else
                     {
-                        while( exit == false )
+                        while( this->impl->_exit == false )
                         {
                             std::this_thread::yield();
                         }
                     }
                     
                     {
-                        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
                         
                         this->impl->_running = false;
                         
@@ -205,7 +215,7 @@ namespace UB
             .detach();
             
             {
-                std::unique_lock< std::recursive_mutex > l( this->impl->_rmtx );
+                std::unique_lock< RecursiveMutex > l( this->impl->_rmtx );
                 
                 cv.wait
                 (
@@ -219,6 +229,23 @@ namespace UB
         }
     }
     
+    void UI::stop( void )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        if( this->impl->_running == false )
+        {
+            return;
+        }
+        
+        this->impl->_exit = true;
+        
+        if( this->impl->_mode == Mode::Interactive )
+        {
+            Screen::shared().stop();
+        }
+    }
+    
     int UI::waitForUserResume( void )
     {
         bool                        keyPressed( false );
@@ -235,7 +262,7 @@ namespace UB
             int pressed( 0 );
             
             {
-                std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
                 std::string                             s;
                 
                 this->impl->_status                   = "Emulation paused - Press [ENTER] or [SPACE] to continue...";
@@ -243,7 +270,7 @@ namespace UB
                 this->impl->_waitEnterOrSpaceKeyPress =
                 [ & ]( int key )
                 {
-                    std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                    std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
                     
                     pressed    = key;
                     keyPressed = true;
@@ -264,7 +291,7 @@ namespace UB
             }
             
             {
-                std::unique_lock< std::recursive_mutex > l( this->impl->_rmtx );
+                std::unique_lock< RecursiveMutex > l( this->impl->_rmtx );
                 
                 cv.wait
                 (
@@ -282,25 +309,39 @@ namespace UB
     
     StringStream & UI::output( void )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_output;
     }
     
     StringStream & UI::debug( void )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
         
         return this->impl->_debug;
     }
     
+    void UI::milestone( const std::string & text )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        this->impl->_milestone = text;
+    }
+    
+    void UI::onPanelDisplayed( const std::function< void( const std::string &, uint64_t ) > handler )
+    {
+        std::lock_guard< RecursiveMutex > l( this->impl->_rmtx );
+        
+        this->impl->_onPanelDisplayed.push_back( handler );
+    }
+    
     void swap( UI & o1, UI & o2 )
     {
         std::lock( o1.impl->_rmtx, o2.impl->_rmtx );
         
         {
-            std::lock_guard< std::recursive_mutex > l1( o1.impl->_rmtx, std::adopt_lock );
-            std::lock_guard< std::recursive_mutex > l2( o2.impl->_rmtx, std::adopt_lock );
+            std::lock_guard< RecursiveMutex > l1( o1.impl->_rmtx, std::adopt_lock );
+            std::lock_guard< RecursiveMutex > l2( o2.impl->_rmtx, std::adopt_lock );
             
             using std::swap;
             
@@ -310,32 +351,38 @@ namespace UB
     
     UI::IMPL::IMPL( Engine & engine ):
         _running(            false ),
+        _exit(               false ),
         _mode(               Mode::Interactive ),
         _engine(             engine ),
+        _cpuMode(            Engine::Mode::Real ),
         _status(             "Emulation not running" ),
         _statusColor(        Color::red() ),
         _memoryOffset(       0x7C00 ),
         _memoryBytesPerLine( 0 ),
-        _memoryLines(        0 )
+        _memoryLines(        0 ),
+        _rmtx(               "UI" )
     {
         this->_setupEngine();
     }
     
     UI::IMPL::IMPL( const IMPL & o ):
-        IMPL( o, std::lock_guard< std::recursive_mutex >( o._rmtx ) )
+        IMPL( o, std::lock_guard< RecursiveMutex >( o._rmtx ) )
     {}
     
-    UI::IMPL::IMPL( const IMPL & o, const std::lock_guard< std::recursive_mutex > & l ):
+    UI::IMPL::IMPL( const IMPL & o, const std::lock_guard< RecursiveMutex > & l ):
         _running(            false ),
+        _exit(               false ),
         _mode(               o._mode ),
         _engine(             o._engine ),
+        _cpuMode(            o._cpuMode.load() ),
         _output(             o._output.string() ),
         _debug(              o._debug.string() ),
         _status(             "Emulation not running" ),
         _statusColor(        Color::red() ),
         _memoryOffset(       o._memoryOffset ),
         _memoryBytesPerLine( o._memoryBytesPerLine ),
-        _memoryLines(        o._memoryLines )
+        _memoryLines(        o._memoryLines ),
+        _rmtx(               "UI" )
     {
         ( void )l;
         
@@ -348,7 +395,7 @@ namespace UB
         (
             [ & ]
             {
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->_rmtx );
                 
                 this->_status      = "Emulation running...";
                 this->_statusColor = Color::green();
@@ -359,12 +406,22 @@ namespace UB
         (
             [ & ]
             {
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->_rmtx );
                 
                 this->_status      = "Emulation stopped";
                 this->_statusColor = Color::red();
             }
         );
+        
+        this->_engine.onModeChange
+        (
+            [ & ]( Engine::Mode previous, Engine::Mode mode )
+            {
+                ( void )previous;
+                
+                this->_cpuMode = mode;
+            }
+        );
     }
     
     void UI::IMPL::_setupScreen( void )
@@ -373,6 +430,8 @@ namespace UB
         (
             [ & ]( void )
             {
+                Timeline::Span span( "UI", "Frame" );
+                
                 if( Screen::shared().width() < 50 || Screen::shared().height() < 30 )
                 {
                     Screen::shared().clear();
@@ -381,15 +440,15 @@ namespace UB
                     return;
                 }
                 
-                this->_displayRegisters();
-                this->_displayFlags();
-                this->_displayStack();
-                this->_displayInstructions();
-                this->_displayDisassembly();
-                this->_displayMemory();
-                this->_displayOutput();
-                this->_displayDebug();
-                this->_displayStatus();
+                this->_display( "Registers",    [ & ] { this->_displayRegisters(); } );
+                this->_display( "Flags",        [ & ] { this->_displayFlags(); } );
+                this->_display( "Stack",        [ & ] { this->_displayStack(); } );
+                this->_display( "Instructions", [ & ] { this->_displayInstructions(); } );
+                this->_display( "Disassembly",  [ & ] { this->_displayDisassembly(); } );
+                this->_display( "Memory",       [ & ] { this->_displayMemory(); } );
+                this->_display( "Output",       [ & ] { this->_displayOutput(); } );
+                this->_display( "Debug",        [ & ] { this->_displayDebug(); } );
+                this->_display( "Status",       [ & ] { this->_displayStatus(); } );
             }
         );
         
@@ -425,7 +484,7 @@ namespace UB
                 }
                 else if( key == 10 || key == 13 || key == 0x20 )
                 {
-                    std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                    std::lock_guard< RecursiveMutex > l( this->_rmtx );
                     
                     if( this->_waitEnterOrSpaceKeyPress != nullptr )
                     {
@@ -474,6 +533,38 @@ namespace UB
         );
     }
     
+    void UI::IMPL::_display( const std::string & name, const std::function< void( void ) > & f )
+    {
+        std::vector< std::function< void( const std::string &, uint64_t ) > > handlers;
+        
+        {
+            std::lock_guard< RecursiveMutex > l( this->_rmtx );
+            
+            handlers = this->_onPanelDisplayed;
+        }
+        
+        if( handlers.size() == 0 )
+        {
+            f();
+            
+            return;
+        }
+        
+        {
+            auto     start( std::chrono::steady_clock::now() );
+            uint64_t time;
+            
+            f();
+            
+            time = static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start ).count() );
+            
+            for( const auto & handler: handlers )
+            {
+                handler( name, time );
+            }
+        }
+    }
+    
     void UI::IMPL::_displayStatus( void )
     {
         size_t x(      0 );
@@ -483,11 +574,26 @@ namespace UB
         Window win( x, y, width, height );
         
         {
-            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            std::lock_guard< RecursiveMutex > l( this->_rmtx );
             
             win.box();
             win.move( 2, 1 );
             win.print( this->_statusColor, this->_status );
+            
+            if( this->_milestone.length() > 0 && this->_status.length() + this->_milestone.length() + 8 < width )
+            {
+                win.print( Color::cyan(), " - " + this->_milestone );
+            }
+        }
+        
+        {
+            std::string locks( RecursiveMutex::summary() );
+            
+            if( locks.length() > 0 && locks.length() + 4 < width )
+            {
+                win.move( width - locks.length() - 2, 1 );
+                win.print( Color::yellow(), locks );
+            }
         }
         
         Screen::shared().refresh();
@@ -518,7 +624,7 @@ namespace UB
             size_t                     max( 80 );
             
             {
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->_rmtx );
                 
                 lines = String::lines( this->_output.string() );
             }
@@ -578,7 +684,7 @@ namespace UB
             size_t                     maxLines( numeric_cast< size_t >( height ) - 4 );
             
             {
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                std::lock_guard< RecursiveMutex > l( this->_rmtx );
                 
                 lines = String::lines( this->_debug.string() );
             }
@@ -616,6 +722,7 @@ namespace UB
         win.box();
         win.move( 2, 1 );
         win.print( Color::blue(), "CPU Registers:" );
+        win.print( ( this->_cpuMode == Engine::Mode::Real ) ? " Real mode" : ( ( this->_cpuMode == Engine::Mode::Protected ) ? " Protected mode" : " Long mode" ) );
         win.move( 1, 2 );
         win.addHorizontalLine( width - 2 );
         
@@ -892,9 +999,11 @@ namespace UB
         
         try
         {
-            uint64_t                                             ip( this->_engine.registers().eip() );
+            Registers                                            reg( this->_engine.registers() );
+            Engine::Mode                                         mode( this->_cpuMode );
+            uint64_t                                             ip( ( mode == Engine::Mode::Real ) ? Engine::getAddress( reg.cs(), reg.ip() ) : reg.eip() );
             std::vector< uint8_t >                               bytes( this->_engine.read( ip, 512 ) );
-            std::vector< std::pair< std::string, std::string > > instructions( Capstone::instructions( bytes, ip ) );
+            std::vector< std::pair< std::string, std::string > > instructions( Capstone::instructions( bytes, ip, this->_engine.bits() ) );
             
             for( const auto & p: instructions )
             {
@@ -942,9 +1051,11 @@ namespace UB
             
             try
             {
-                uint64_t                                             ip( this->_engine.registers().eip() );
+                Registers                                            reg( this->_engine.registers() );
+                Engine::Mode                                         mode( this->_cpuMode );
+                uint64_t                                             ip( ( mode == Engine::Mode::Real ) ? Engine::getAddress( reg.cs(), reg.ip() ) : reg.eip() );
                 std::vector< uint8_t >                               bytes( this->_engine.read( ip, 512 ) );
-                std::vector< std::pair< std::string, std::string > > instructions( Capstone::disassemble( bytes, ip ) );
+                std::vector< std::pair< std::string, std::string > > instructions( Capstone::disassemble( bytes, ip, this->_engine.bits() ) );
                 
                 for( const auto & p: instructions )
                 {
@@ -28,6 +28,8 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <functional>
+#include <cstdint>
 #include "UB/StringStream.hpp"
 
 namespace UB
@@ -55,11 +57,16 @@ namespace UB
             void mode( Mode mode );
             
             void run( void );
+            void stop( void );
             int  waitForUserResume( void );
             
             StringStream & output( void );
             StringStream & debug( void );
             
+            void milestone( const std::string & text );
+            
+            void onPanelDisplayed( const std::function< void( const std::string &, uint64_t ) > handler );
+            
             friend void swap( UI & o1, UI & o2 );
             
         private:
@@ -26,6 +26,24 @@
 #include "UB/Arguments.hpp"
 #include "UB/Machine.hpp"
 #include "UB/Screen.hpp"
+#include "UB/FAT/ChunkStore.hpp"
+#include "UB/FAT/PrefetchProfile.hpp"
+#include "UB/IOTrace.hpp"
+#include "UB/AhoCorasick.hpp"
+#include "UB/Timeline.hpp"
+#include "UB/BlockCache.hpp"
+#include "UB/InstructionMix.hpp"
+#include "UB/HostProfile.hpp"
+#include "UB/TimingModel.hpp"
+#include "UB/CacheSimulator.hpp"
+#include "UB/DiskAttribution.hpp"
+#include "UB/RunHistory.hpp"
+#include "UB/SharedFramebuffer.hpp"
+#include "UB/RecursiveMutex.hpp"
+#include "UB/Automation/Scheduler.hpp"
+#include <fstream>
+#include <array>
+#include <atomic>
 
 static void showHelp( void );
 
@@ -42,23 +60,66 @@ int main( int argc, const char * argv[] )
             return EXIT_SUCCESS;
         }
         
+        if( args.importManifest().length() > 0 )
         {
-            UB::Machine * machine;
+            if( args.chunkStore().length() == 0 )
+            {
+                throw std::runtime_error( "--import requires --chunk-store" );
+            }
+            
+            UB::FAT::ChunkStore( args.chunkStore() ).import( args.bootImage() ).write( args.importManifest() );
             
-            if( args.noUI() )
+            return EXIT_SUCCESS;
+        }
+        
+        if( args.historyCheck() )
+        {
+            if( args.history().length() == 0 )
             {
-                machine = new UB::Machine( args.memory() * 1024 * 1024, args.bootImage(), UB::UI::Mode::Standard );
+                throw std::runtime_error( "--history-check requires --history" );
+            }
+            
+            return ( UB::RunHistory::check( args.history(), UB::FAT::Image( args.bootImage() ).hash(), args.historyWindow(), std::cout ) ) ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+        
+        {
+            UB::Machine                                 * machine;
+            std::unique_ptr< UB::FAT::PrefetchProfile >   prefetch;
+            std::unique_ptr< UB::IOTrace >                ioTrace;
+            std::unique_ptr< UB::AhoCorasick >            matcher;
+            std::unique_ptr< UB::BlockCache >             blocks;
+            std::unique_ptr< UB::InstructionMix >         mix;
+            std::unique_ptr< UB::HostProfile >            hostProfile;
+            std::unique_ptr< UB::TimingModel >            timing;
+            std::unique_ptr< UB::CacheSimulator >         cache;
+            std::unique_ptr< UB::SharedFramebuffer >      framebuffer;
+            std::unique_ptr< UB::DiskAttribution >        attribution;
+            std::unique_ptr< UB::RunHistory >             history;
+            std::array< uint32_t, 3 >                     matcherStates;
+            std::atomic< bool >                           matched( false );
+            std::atomic< int >                            status( EXIT_SUCCESS );
+            bool                                          recordPrefetch( false );
+            
+            if( args.memoryMap().length() > 0 )
+            {
+                machine = new UB::Machine( UB::BIOS::MemoryMap::fromLayout( args.memoryMap() ), args.bootImage(), ( args.noUI() || args.script().length() > 0 ) ? UB::UI::Mode::Standard : UB::UI::Mode::Interactive );
+            }
+            else if( args.noUI() || args.script().length() > 0 )
+            {
+                machine = new UB::Machine( args.memory(), args.bootImage(), UB::UI::Mode::Standard );
             }
             else
             {
-                machine = new UB::Machine( args.memory() * 1024 * 1024, args.bootImage(), UB::UI::Mode::Interactive );
+                machine = new UB::Machine( args.memory(), args.bootImage(), UB::UI::Mode::Interactive );
             }
             
             machine->breakOnInterrupt( args.breakOnInterrupt() );
             machine->breakOnInterruptReturn( args.breakOnInterruptReturn() );
             machine->trap( args.trap() );
             machine->debugVideo( args.debugVideo() );
+            machine->flightRecorderPath( args.flightRecorder() );
             machine->singleStep( args.singleStep() );
+            machine->milestoneOutput( args.milestoneOutput() );
             
             for( auto bp: args.breakpoints() )
             {
@@ -70,11 +131,432 @@ int main( int argc, const char * argv[] )
                UB::Screen::shared().disableColors();
             }
             
+            if( args.prefetchDirectory().length() > 0 )
+            {
+                prefetch = std::make_unique< UB::FAT::PrefetchProfile >( args.prefetchDirectory(), machine->bootImage() );
+                
+                recordPrefetch = prefetch->isEmpty();
+                
+                if( recordPrefetch )
+                {
+                    machine->onDiskRead
+                    (
+                        [ & ]( const UB::BIOS::DiskAccess & access )
+                        {
+                            if( access.success() )
+                            {
+                                prefetch->record( access.offset(), access.size() );
+                            }
+                        }
+                    );
+                }
+                else
+                {
+                    prefetch->prefetch();
+                }
+            }
+            
+            if( args.ioTrace().length() > 0 )
+            {
+                ioTrace = std::make_unique< UB::IOTrace >( args.ioTrace() );
+                
+                machine->onDiskRead
+                (
+                    [ & ]( const UB::BIOS::DiskAccess & access )
+                    {
+                        ioTrace->write( access );
+                    }
+                );
+            }
+            
+            if( args.expect().size() > 0 || args.failOn().size() > 0 )
+            {
+                std::vector< std::string > patterns( args.expect() );
+                std::vector< std::string > failOn( args.failOn() );
+                size_t                     expected( patterns.size() );
+                
+                patterns.insert( patterns.end(), failOn.begin(), failOn.end() );
+                matcherStates.fill( UB::AhoCorasick::InitialState );
+                
+                matcher = std::make_unique< UB::AhoCorasick >( patterns );
+                status  = ( expected > 0 ) ? 2 : EXIT_SUCCESS;
+                
+                machine->onOutput
+                (
+                    [ &, expected ]( UB::Machine::Output output, uint8_t c )
+                    {
+                        uint32_t & state( matcherStates[ static_cast< size_t >( output ) ] );
+                        
+                        state = matcher->next( state, c );
+                        
+                        if( matcher->isMatch( state ) && matched.exchange( true ) == false )
+                        {
+                            size_t match( matcher->match( state ) );
+                            
+                            status = ( match < expected ) ? EXIT_SUCCESS : EXIT_FAILURE;
+                            
+                            machine->ui().debug() << "[ MATCH ]> " << matcher->patterns()[ match ] << std::endl;
+                            machine->stop();
+                        }
+                    }
+                );
+            }
+            
+            if( args.instructionMix().length() > 0 || args.timing().length() > 0 || args.cacheSim().length() > 0 )
+            {
+                blocks = std::make_unique< UB::BlockCache >
+                (
+                    [ & ]( uint64_t address, size_t size ) -> std::vector< uint8_t >
+                    {
+                        return machine->read( address, size );
+                    }
+                );
+                
+                /* A single hook looks each block up once for all of its consumers */
+                machine->onBlock
+                (
+                    [ & ]( uint64_t address, size_t size )
+                    {
+                        const UB::BlockCache::Block & block( blocks->block( machine->mode(), machine->bits(), address, size ) );
+                        
+                        if( timing != nullptr )
+                        {
+                            timing->block( block );
+                        }
+                        
+                        if( cache != nullptr )
+                        {
+                            cache->block( block );
+                        }
+                    }
+                );
+                
+                machine->onCodeWrite
+                (
+                    [ & ]( uint64_t page )
+                    {
+                        blocks->invalidate( page );
+                    }
+                );
+            }
+            
+            if( args.instructionMix().length() > 0 )
+            {
+                mix = std::make_unique< UB::InstructionMix >( *( blocks ) );
+            }
+            
+            if( args.timing().length() > 0 )
+            {
+                if( args.timingModel().length() > 0 )
+                {
+                    timing = std::make_unique< UB::TimingModel >( args.timingModel() );
+                }
+                else
+                {
+                    timing = std::make_unique< UB::TimingModel >();
+                }
+                
+                machine->onInterrupt
+                (
+                    [ & ]( uint32_t i )
+                    {
+                        timing->interrupt( i );
+                    }
+                );
+                
+                machine->onDiskRead
+                (
+                    [ & ]( const UB::BIOS::DiskAccess & access )
+                    {
+                        timing->diskRead( access.size() );
+                    }
+                );
+            }
+            
+            if( args.diskReport().length() > 0 )
+            {
+                attribution = std::make_unique< UB::DiskAttribution >( machine->bootImage() );
+                
+                machine->onDiskRead
+                (
+                    [ & ]( const UB::BIOS::DiskAccess & access )
+                    {
+                        attribution->read( access );
+                    }
+                );
+            }
+            
+            if( args.history().length() > 0 )
+            {
+                history = std::make_unique< UB::RunHistory >();
+                
+                machine->onInterrupt
+                (
+                    [ & ]( uint32_t i )
+                    {
+                        history->interrupt( i );
+                    }
+                );
+                
+                machine->onInterruptReturn
+                (
+                    [ & ]( uint32_t i )
+                    {
+                        history->interruptReturn( i );
+                    }
+                );
+                
+                machine->onDiskRead
+                (
+                    [ & ]( const UB::BIOS::DiskAccess & access )
+                    {
+                        history->diskRead( access );
+                    }
+                );
+                
+                machine->onOutput
+                (
+                    [ & ]( UB::Machine::Output output, uint8_t c )
+                    {
+                        ( void )output;
+                        ( void )c;
+                        
+                        history->output();
+                    }
+                );
+            }
+            
+            if( args.framebufferShm().length() > 0 )
+            {
+                framebuffer = std::make_unique< UB::SharedFramebuffer >( args.framebufferShm(), *( machine ) );
+            }
+            
+            if( args.cacheSim().length() > 0 )
+            {
+                std::vector< std::string > ranges( args.cacheRanges() );
+                
+                /* Ranged hooks on all of memory would mean a code hook on every instruction */
+                if( ranges.size() == 0 )
+                {
+                    throw std::runtime_error( "--cache-sim requires at least one --cache-range" );
+                }
+                
+                cache = std::make_unique< UB::CacheSimulator >( args.cacheGeometry() );
+                
+                for( const auto & range: ranges )
+                {
+                    size_t   dash( range.find( '-' ) );
+                    char   * end1( nullptr );
+                    char   * end2( nullptr );
+                    uint64_t begin( std::strtoull( range.c_str(), &end1, 0 ) );
+                    uint64_t end( ( dash == std::string::npos ) ? 0 : std::strtoull( range.c_str() + dash + 1, &end2, 0 ) );
+                    
+                    if( dash == std::string::npos || dash == 0 || end1 != range.c_str() + dash || end2 == nullptr || *( end2 ) != 0 || end < begin )
+                    {
+                        throw std::runtime_error( "Invalid cache range: " + range + " - Expected BEGIN-END" );
+                    }
+                    
+                    machine->onMemoryAccess
+                    (
+                        begin,
+                        end,
+                        [ & ]( UB::Engine::MemoryAccess access, uint64_t address, size_t size )
+                        {
+                            cache->access( access, address, size );
+                        }
+                    );
+                }
+            }
+            
+            if( args.hostProfile().length() > 0 )
+            {
+                hostProfile = std::make_unique< UB::HostProfile >();
+                
+                machine->onInterrupt
+                (
+                    [ & ]( uint32_t i )
+                    {
+                        hostProfile->interrupt( i );
+                    }
+                );
+                
+                machine->onInterruptReturn
+                (
+                    [ & ]( uint32_t i )
+                    {
+                        hostProfile->interruptReturn( i );
+                    }
+                );
+                
+                machine->onBlock
+                (
+                    [ & ]( uint64_t address, size_t size )
+                    {
+                        ( void )size;
+                        
+                        hostProfile->block( address );
+                    }
+                );
+            }
+            
+            if( args.timeline().length() > 0 )
+            {
+                UB::Timeline::shared().clock( [ = ]( void ) -> uint64_t { return machine->instructions(); } );
+                UB::Timeline::shared().enable();
+                UB::Timeline::shared().threadName( "Main" );
+            }
+            
+            if( history != nullptr )
+            {
+                history->start();
+            }
+            
+            if( args.script().length() > 0 )
+            {
+                /* The UI loop isn't started for scripts, so output is forwarded directly */
+                machine->ui().output().redirect( std::cout );
+                machine->ui().debug().redirect(  std::cerr );
+                
+                UB::Automation::Scheduler         scheduler( 1 );
+                UB::Automation::Scheduler::Result result
+                (
+                    scheduler.schedule
+                    (
+                        /* The machine outlives the scheduler, which must not delete it */
+                        std::shared_ptr< UB::Machine >( machine, []( UB::Machine * ) {} ),
+                        UB::Automation::Script::fromFile( args.script() )
+                    )
+                    .get()
+                );
+                
+                std::cerr << "[ SCRIPT ]> "
+                          << ( ( result.status() == UB::Automation::Scheduler::Result::Status::Completed ) ? "Completed" : ( ( result.status() == UB::Automation::Scheduler::Result::Status::Failed ) ? "Failed" : "Instruction limit reached" ) )
+                          << " after "
+                          << result.instructions()
+                          << " instructions"
+                          << ( ( result ) ? "" : " - Step " + std::to_string( result.step() + 1 ) + ": " + result.description() )
+                          << std::endl;
+                
+                if( result == false )
+                {
+                    status = EXIT_FAILURE;
+                }
+            }
+            else
+            {
+                machine->run();
+            }
+            
+            if( history != nullptr )
+            {
+                history->stop( machine->instructions() );
+            }
+            
+            if( args.timeline().length() > 0 )
+            {
+                UB::Timeline::shared().save( args.timeline() );
+            }
+            
+            if( mix != nullptr )
+            {
+                std::ofstream stream( args.instructionMix(), std::ios::out | std::ios::trunc );
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write instruction mix report: " + args.instructionMix() );
+                }
+                
+                stream << mix->report();
+            }
+            
+            if( timing != nullptr )
+            {
+                std::ofstream stream( args.timing(), std::ios::out | std::ios::trunc );
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write timing estimate: " + args.timing() );
+                }
+                
+                stream << timing->report();
+            }
+            
+            if( cache != nullptr )
+            {
+                std::ofstream stream( args.cacheSim(), std::ios::out | std::ios::trunc );
+                
+                cache->stop();
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write cache simulation report: " + args.cacheSim() );
+                }
+                
+                stream << cache->report();
+            }
+            
+            if( hostProfile != nullptr )
+            {
+                std::ofstream stream( args.hostProfile(), std::ios::out | std::ios::trunc );
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write host profile: " + args.hostProfile() );
+                }
+                
+                stream << hostProfile->report();
+            }
+            
+            if( attribution != nullptr )
+            {
+                std::ofstream stream( args.diskReport(), std::ios::out | std::ios::trunc );
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write disk report: " + args.diskReport() );
+                }
+                
+                stream << attribution->report();
+            }
+            
+            if( args.milestones().length() > 0 )
+            {
+                std::ofstream stream( args.milestones(), std::ios::out | std::ios::trunc );
+                
+                if( stream.good() == false )
+                {
+                    throw std::runtime_error( "Cannot write boot milestones: " + args.milestones() );
+                }
+                
+                stream << machine->milestones();
+            }
             
-            machine->run();
+            if( history != nullptr )
+            {
+                history->append( args.history(), machine->bootImage().hash() );
+            }
+            
+            {
+                std::string locks( UB::RecursiveMutex::report() );
+                
+                if( locks.length() > 0 )
+                {
+                    std::cerr << locks;
+                }
+            }
+            
+            if( prefetch != nullptr )
+            {
+                prefetch->stop();
+                
+                if( recordPrefetch && prefetch->isEmpty() == false )
+                {
+                    prefetch->save();
+                }
+            }
+            
+            return status;
         }
-        
-        return EXIT_SUCCESS;
     }
     catch( const std::exception & e )
     {
@@ -104,6 +586,8 @@ static void showHelp( void )
               << std::endl
               << "                    (in megabytes). Defaults to 64MB, minimum 2MB."
               << std::endl
+              << "                    Memory past 3GB is placed above 4GB."
+              << std::endl
               << "    --break / -b    Breaks on a specific address."
               << std::endl
               << "    --break-int:    Breaks on interrupt calls."
@@ -119,5 +603,149 @@ static void showHelp( void )
               << "    --no-ui:        Don't start the user interface (output will be displayed to stdout, debug info to stderr)."
               << std::endl
               << "    --no-colors:    Don't use colors."
+              << std::endl
+              << "    --chunk-store DIR:  Content-addressed chunk store used by --import."
+              << std::endl
+              << "    --import MANIFEST:  Splits BOOT_IMG into chunks stored in --chunk-store, writes"
+              << std::endl
+              << "                        a manifest to MANIFEST and exits. Manifests can be passed"
+              << std::endl
+              << "                        as BOOT_IMG in place of a raw disk image."
+              << std::endl
+              << "    --prefetch DIR: Records the boot-time disk read sequence of BOOT_IMG into a"
+              << std::endl
+              << "                    profile stored in DIR (keyed by the image's headers, without"
+              << std::endl
+              << "                    reading its data). Later boots prefetch those reads in"
+              << std::endl
+              << "                    parallel in the background."
+              << std::endl
+              << "    --io-trace FILE:  Logs every INT 13h disk service call to FILE in a compact"
+              << std::endl
+              << "                      binary format (see io-replay)."
+              << std::endl
+              << "    --expect TEXT:  Stops the emulation and exits with status 0 as soon as TEXT"
+              << std::endl
+              << "                    appears on the TTY, serial (INT 14h or COM1) or debug port (0xE9) output."
+              << std::endl
+              << "                    Can be repeated. Exits with status 2 if no pattern matched."
+              << std::endl
+              << "    --fail-on TEXT: Stops the emulation and exits with status 1 as soon as TEXT"
+              << std::endl
+              << "                    appears on the output. Can be repeated."
+              << std::endl
+              << "    --timeline FILE:  Records BIOS calls, disk reads, mode switches, breaks, UI frames"
+              << std::endl
+              << "                      and emulation spans, and writes them to FILE as Chrome trace"
+              << std::endl
+              << "                      JSON (chrome://tracing, ui.perfetto.dev), on both host time"
+              << std::endl
+              << "                      and guest instruction count."
+              << std::endl
+              << "    --instruction-mix FILE:  Writes an instruction-mix report to FILE at exit, broken down"
+              << std::endl
+              << "                             by mnemonic, Capstone group and CPU mode (each basic block"
+              << std::endl
+              << "                             is decoded once and weighted by its execution count)."
+              << std::endl
+              << "    --memory-map LAYOUT:  Uses a custom E820 memory map instead of --memory. LAYOUT is"
+              << std::endl
+              << "                          either a file or a list of BASE:LENGTH:TYPE entries separated"
+              << std::endl
+              << "                          by commas or newlines, where TYPE is usable, reserved or acpi"
+              << std::endl
+              << "                          and numbers accept K/M/G/T suffixes. Usable ranges are backed"
+              << std::endl
+              << "                          lazily and holes stay unmapped, e.g.:"
+              << std::endl
+              << "                          0:0x9FC00:usable,1M:3G:usable,4G:12G:usable"
+              << std::endl
+              << "    --host-profile FILE:  Writes a host profile of the emulation thread to FILE at exit."
+              << std::endl
+              << "                          Counter deltas (task-clock and context switches, plus cycles"
+              << std::endl
+              << "                          and instructions when a PMU is available) are attributed to BIOS"
+              << std::endl
+              << "                          vectors and 4KB guest code ranges. Uses perf_event_open on"
+              << std::endl
+              << "                          Linux, thread CPU time and rusage elsewhere."
+              << std::endl
+              << "    --timing FILE:  Writes a cycle-approximate estimate of guest execution time on"
+              << std::endl
+              << "                    real hardware to FILE at exit, per phase (CPU mode, BIOS"
+              << std::endl
+              << "                    services, disk I/O, mode switches) and per function."
+              << std::endl
+              << "    --timing-model FILE:  Overrides the --timing cost table with \"key = cycles\" lines:"
+              << std::endl
+              << "                          default, mnemonic.NAME, group.NAME, penalty.far-transfer,"
+              << std::endl
+              << "                          penalty.port-io, penalty.mode-switch, latency.interrupt,"
+              << std::endl
+              << "                          latency.disk, latency.disk-byte and frequency (in Hz)."
+              << std::endl
+              << "    --cache-sim FILE:  Simulates L1D/L1I/L2 caches from guest memory accesses and"
+              << std::endl
+              << "                       writes per-function and per-block hit rates to FILE."
+              << std::endl
+              << "    --cache-geometry SPEC:  Cache geometry for --cache-sim, as comma-separated"
+              << std::endl
+              << "                            LEVEL=SIZE:WAYS:LINE entries (default:"
+              << std::endl
+              << "                            l1d=32K:8:64,l1i=32K:8:64,l2=256K:8:64)."
+              << std::endl
+              << "    --cache-range BEGIN-END:  Guest addresses in BEGIN-END simulated by --cache-sim."
+              << std::endl
+              << "                              Required with --cache-sim, can be repeated."
+              << std::endl
+              << "    --flight-recorder FILE:  Writes the flight recorder (last taken branches, interrupts,"
+              << std::endl
+              << "                             disk reads and output) to FILE instead of the debug output"
+              << std::endl
+              << "                             when the emulation faults or is interrupted."
+              << std::endl
+              << "    --framebuffer-shm NAME:  Exports guest video memory (0xA0000-0xBFFFF) through the POSIX"
+              << std::endl
+              << "                             shared-memory object NAME, with a header giving the video mode,"
+              << std::endl
+              << "                             dimensions, a frame sequence and dirty rectangles (see"
+              << std::endl
+              << "                             UB/SharedFramebuffer.hpp). External viewers map it and render"
+              << std::endl
+              << "                             at their own pace."
+              << std::endl
+              << "    --disk-report FILE:  Writes which FAT files, directories and tables the boot code read,"
+              << std::endl
+              << "                         in first-read order, with requests, bytes and re-reads per object."
+              << std::endl
+              << "    --history FILE:  Appends this run's metrics (guest MIPS, BIOS service latency percentiles,"
+              << std::endl
+              << "                     disk MB/s, time to first output, wall time) to a tab-separated history,"
+              << std::endl
+              << "                     keyed by image hash and emulator build."
+              << std::endl
+              << "    --history-check:  Doesn't run BOOT_IMG: compares its last run in --history against the runs"
+              << std::endl
+              << "                      before it and exits with a failure status if a metric regressed."
+              << std::endl
+              << "    --history-window N:  Number of previous runs used as the --history-check baseline (default 10)."
+              << std::endl
+              << "    --milestone-output TEXT:  Records the first output of TEXT as a boot milestone."
+              << std::endl
+              << "    --milestones FILE:  Writes the instruction count and host time at which each boot milestone"
+              << std::endl
+              << "                        was reached: first INT 13h, first protected and long mode instruction,"
+              << std::endl
+              << "                        --milestone-output and the ready hypercall (OUT 0x01 to port 0x505)."
+              << std::endl
+              << "    --script FILE:  Runs BOOT_IMG under the automation script FILE instead of the user"
+              << std::endl
+              << "                    interface, one step per line: limit N, run-until ADDRESS,"
+              << std::endl
+              << "                    output TEXT, interrupt NUMBER, keys TEXT, dump ADDRESS SIZE."
+              << std::endl
+              << "                    Exits with a failure status if a step failed or the instruction"
+              << std::endl
+              << "                    limit was reached."
               << std::endl;
 }